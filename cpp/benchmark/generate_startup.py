@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""
+Generates a synthetic extension module with thousands of bindings for measuring library load time.
+
+The C++ source declares native classes whose functions are bound with ktbind, and data classes passed to and from
+these functions, e.g.
+
+    generate_startup.py --cpp startup.cpp --functions 5000 --data-classes 500
+
+The matching Kotlin declarations are written by the stub generator of the module (CMake target
+ktbind_startup_stubgen), the same way as for any other extension module.
+
+With --lazy, the module is built with KTBIND_LAZY_REGISTRATION, and each native class registers its own native
+methods when its companion object is initialized.
+"""
+
+import argparse
+
+PACKAGE = "com.kheiron.ktbind.startup"
+
+# native signature and function body for each kind of generated function
+FUNCTION_KINDS = [
+    ("int32_t {name}(int32_t x, int32_t y)", "return x + y + {k};"),
+    ("std::string {name}(const std::string& s)", "return s + \"{k}\";"),
+    ("{data} {name}(const {data}& d)", "{data} r = d; r.a += {k}; return r;"),
+    ("int64_t {name}(const std::vector<int32_t>& v)", "return static_cast<int64_t>(v.size()) + {k};"),
+]
+
+
+def function_signature(k, data_classes):
+    native, body = FUNCTION_KINDS[k % len(FUNCTION_KINDS)]
+    data = "Data{}".format(k % data_classes)
+    name = "f{}".format(k)
+    return native.format(name=name, data=data), body.format(k=k, data=data)
+
+
+def generate_cpp(args):
+    lines = [
+        "// Generated by generate_startup.py; do not edit.",
+        "#define KTBIND_SCHEMA_VALIDATION",
+    ]
+    if args.lazy:
+        lines.append("#define KTBIND_LAZY_REGISTRATION")
+    lines += [
+        '#include "ktbind/ktbind.hpp"',
+        "",
+    ]
+    for j in range(args.data_classes):
+        lines += [
+            "struct Data{} {{".format(j),
+            "    int32_t a = 0;",
+            "    double b = 0.0;",
+            "    std::string c;",
+            "    std::vector<int32_t> d;",
+            "};",
+            'DECLARE_DATA_CLASS(Data{0}, "{1}.Data{0}")'.format(j, PACKAGE),
+            "",
+        ]
+    for c in range(args.classes):
+        lines += [
+            "struct Service{} {{}};".format(c),
+            'DECLARE_NATIVE_CLASS(Service{0}, "{1}.Service{0}")'.format(c, PACKAGE),
+            "",
+        ]
+    for k in range(args.functions):
+        native, body = function_signature(k, args.data_classes)
+        lines.append("static {} {{ {} }}".format(native, body))
+    lines += [
+        "",
+        "JAVA_EXTENSION_MODULE() {",
+        "    using namespace java;",
+        "",
+    ]
+    for c in range(args.classes):
+        lines.append("    native_class<Service{}>()".format(c))
+        for k in range(c, args.functions, args.classes):
+            lines.append('        .function<f{0}>("f{0}")'.format(k))
+        lines.append("    ;")
+    lines.append("")
+    for j in range(args.data_classes):
+        lines.append(
+            "    data_class<Data{0}>().field<&Data{0}::a>(\"a\").field<&Data{0}::b>(\"b\")"
+            ".field<&Data{0}::c>(\"c\").field<&Data{0}::d>(\"d\");".format(j)
+        )
+    lines.append("}")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--cpp", help="path of the C++ source file to write")
+    parser.add_argument("--functions", type=int, default=5000, help="number of bound functions")
+    parser.add_argument("--data-classes", type=int, default=500, help="number of data classes")
+    parser.add_argument("--classes", type=int, default=50, help="number of native classes the functions are spread across")
+    parser.add_argument("--lazy", action="store_true", help="register native methods of each class on first use")
+    args = parser.parse_args()
+
+    if args.cpp:
+        with open(args.cpp, "w") as f:
+            f.write(generate_cpp(args))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,262 @@
+/**
+ * Native side of the JMH benchmark suite in kotlin/src/jmh.
+ * Each operation is implemented once in C++, and exposed twice: through ktbind bindings, and through hand-written
+ * JNI functions that cache class, method and field identifiers the way carefully written JNI code would.
+ */
+#include "ktbind/ktbind.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BenchData {
+    int32_t i = 0;
+    double d = 0.0;
+    std::string str;
+    std::vector<int32_t> values;
+};
+
+struct Counter {
+    void increment() {
+        ++_value;
+    }
+
+    void increment_noexcept() noexcept {
+        ++_value;
+    }
+
+    int64_t value() const {
+        return _value;
+    }
+
+private:
+    int64_t _value = 0;
+};
+
+int32_t add(int32_t a, int32_t b) {
+    return a + b;
+}
+
+int32_t add_noexcept(int32_t a, int32_t b) noexcept {
+    return a + b;
+}
+
+std::string echo_string(const std::string& str) {
+    return str;
+}
+
+int64_t sum_ints(const std::vector<int32_t>& values) {
+    int64_t sum = 0;
+    for (int32_t value : values) {
+        sum += value;
+    }
+    return sum;
+}
+
+std::unordered_map<std::string, int32_t> count_words(const std::vector<std::string>& words) {
+    std::unordered_map<std::string, int32_t> counts;
+    for (auto&& word : words) {
+        ++counts[word];
+    }
+    return counts;
+}
+
+BenchData transform(const BenchData& data) {
+    BenchData result = data;
+    result.i += 1;
+    result.d *= 2;
+    return result;
+}
+
+int32_t apply_callback(std::function<int32_t(int32_t)> fun, int32_t value) {
+    return fun(value);
+}
+
+DECLARE_DATA_CLASS(BenchData, "com.kheiron.ktbind.benchmark.BenchData")
+DECLARE_NATIVE_CLASS(Counter, "com.kheiron.ktbind.benchmark.Counter")
+
+JAVA_EXTENSION_MODULE() {
+    using namespace java;
+
+    native_object("com/kheiron/ktbind/benchmark/KtBindFunctions")
+        .function<add>("add")
+        .function<add_noexcept>("addNoexcept")
+        .function<echo_string>("echoString")
+        .function<sum_ints>("sumInts")
+        .function<count_words>("countWords")
+        .function<transform>("transform")
+        .function<apply_callback>("applyCallback")
+    ;
+
+    native_class<Counter>()
+        .constructor<Counter()>("create")
+        .function<&Counter::increment>("increment")
+        .function<&Counter::increment_noexcept>("incrementNoexcept")
+        .function<&Counter::value>("value")
+    ;
+
+    data_class<BenchData>()
+        .field<&BenchData::i>("i")
+        .field<&BenchData::d>("d")
+        .field<&BenchData::str>("str")
+        .field<&BenchData::values>("values")
+    ;
+}
+
+namespace {
+    /** Global references and identifiers resolved on first use. */
+    struct Cache {
+        jclass hashMapClass;
+        jmethodID hashMapInit;
+        jmethodID mapPut;
+        jmethodID listSize;
+        jmethodID listGet;
+        jclass integerClass;
+        jmethodID integerValueOf;
+        jmethodID integerIntValue;
+        jclass dataClass;
+        jmethodID dataInit;
+        jfieldID dataI;
+        jfieldID dataD;
+        jfieldID dataStr;
+        jfieldID dataValues;
+        jmethodID functionInvoke;
+
+        static const Cache& get(JNIEnv* env) {
+            static const Cache cache = [env] {
+                Cache c;
+                jclass cls = env->FindClass("java/util/HashMap");
+                c.hashMapClass = static_cast<jclass>(env->NewGlobalRef(cls));
+                c.hashMapInit = env->GetMethodID(cls, "<init>", "(I)V");
+                env->DeleteLocalRef(cls);
+
+                cls = env->FindClass("java/util/Map");
+                c.mapPut = env->GetMethodID(cls, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+                env->DeleteLocalRef(cls);
+
+                cls = env->FindClass("java/util/List");
+                c.listSize = env->GetMethodID(cls, "size", "()I");
+                c.listGet = env->GetMethodID(cls, "get", "(I)Ljava/lang/Object;");
+                env->DeleteLocalRef(cls);
+
+                cls = env->FindClass("java/lang/Integer");
+                c.integerClass = static_cast<jclass>(env->NewGlobalRef(cls));
+                c.integerValueOf = env->GetStaticMethodID(cls, "valueOf", "(I)Ljava/lang/Integer;");
+                c.integerIntValue = env->GetMethodID(cls, "intValue", "()I");
+                env->DeleteLocalRef(cls);
+
+                cls = env->FindClass("com/kheiron/ktbind/benchmark/BenchData");
+                c.dataClass = static_cast<jclass>(env->NewGlobalRef(cls));
+                c.dataInit = env->GetMethodID(cls, "<init>", "(IDLjava/lang/String;[I)V");
+                c.dataI = env->GetFieldID(cls, "i", "I");
+                c.dataD = env->GetFieldID(cls, "d", "D");
+                c.dataStr = env->GetFieldID(cls, "str", "Ljava/lang/String;");
+                c.dataValues = env->GetFieldID(cls, "values", "[I");
+                env->DeleteLocalRef(cls);
+
+                cls = env->FindClass("kotlin/jvm/functions/Function1");
+                c.functionInvoke = env->GetMethodID(cls, "invoke", "(Ljava/lang/Object;)Ljava/lang/Object;");
+                env->DeleteLocalRef(cls);
+                return c;
+            }();
+            return cache;
+        }
+    };
+
+    std::string to_string(JNIEnv* env, jstring str) {
+        const char* chars = env->GetStringUTFChars(str, nullptr);
+        std::string result(chars, env->GetStringUTFLength(str));
+        env->ReleaseStringUTFChars(str, chars);
+        return result;
+    }
+
+    std::vector<int32_t> to_vector(JNIEnv* env, jintArray arr) {
+        std::vector<int32_t> result(env->GetArrayLength(arr));
+        env->GetIntArrayRegion(arr, 0, static_cast<jsize>(result.size()), reinterpret_cast<jint*>(result.data()));
+        return result;
+    }
+}
+
+extern "C" {
+    JNIEXPORT jint JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_add(JNIEnv*, jclass, jint a, jint b) {
+        return add(a, b);
+    }
+
+    JNIEXPORT jstring JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_echoString(JNIEnv* env, jclass, jstring str) {
+        return env->NewStringUTF(echo_string(to_string(env, str)).c_str());
+    }
+
+    JNIEXPORT jlong JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_sumInts(JNIEnv* env, jclass, jintArray arr) {
+        return sum_ints(to_vector(env, arr));
+    }
+
+    JNIEXPORT jobject JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_countWords(JNIEnv* env, jclass, jobject list) {
+        const Cache& c = Cache::get(env);
+        jint size = env->CallIntMethod(list, c.listSize);
+        std::vector<std::string> words;
+        words.reserve(size);
+        for (jint k = 0; k < size; ++k) {
+            jstring word = static_cast<jstring>(env->CallObjectMethod(list, c.listGet, k));
+            words.push_back(to_string(env, word));
+            env->DeleteLocalRef(word);
+        }
+
+        auto counts = count_words(words);
+        jobject map = env->NewObject(c.hashMapClass, c.hashMapInit, static_cast<jint>(counts.size() * 2));
+        for (auto&& [word, count] : counts) {
+            jstring key = env->NewStringUTF(word.c_str());
+            jobject value = env->CallStaticObjectMethod(c.integerClass, c.integerValueOf, count);
+            jobject previous = env->CallObjectMethod(map, c.mapPut, key, value);
+            env->DeleteLocalRef(previous);
+            env->DeleteLocalRef(value);
+            env->DeleteLocalRef(key);
+        }
+        return map;
+    }
+
+    JNIEXPORT jobject JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_transform(JNIEnv* env, jclass, jobject obj) {
+        const Cache& c = Cache::get(env);
+        BenchData data;
+        data.i = env->GetIntField(obj, c.dataI);
+        data.d = env->GetDoubleField(obj, c.dataD);
+        jstring str = static_cast<jstring>(env->GetObjectField(obj, c.dataStr));
+        data.str = to_string(env, str);
+        env->DeleteLocalRef(str);
+        jintArray values = static_cast<jintArray>(env->GetObjectField(obj, c.dataValues));
+        data.values = to_vector(env, values);
+        env->DeleteLocalRef(values);
+
+        BenchData result = transform(data);
+        str = env->NewStringUTF(result.str.c_str());
+        values = env->NewIntArray(static_cast<jsize>(result.values.size()));
+        env->SetIntArrayRegion(values, 0, static_cast<jsize>(result.values.size()), reinterpret_cast<const jint*>(result.values.data()));
+        jobject resultObj = env->NewObject(c.dataClass, c.dataInit, result.i, result.d, str, values);
+        env->DeleteLocalRef(values);
+        env->DeleteLocalRef(str);
+        return resultObj;
+    }
+
+    JNIEXPORT jint JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_applyCallback(JNIEnv* env, jclass, jobject fun, jint value) {
+        const Cache& c = Cache::get(env);
+        jobject boxed = env->CallStaticObjectMethod(c.integerClass, c.integerValueOf, value);
+        jobject result = env->CallObjectMethod(fun, c.functionInvoke, boxed);
+        env->DeleteLocalRef(boxed);
+        if (env->ExceptionCheck()) {
+            return 0;
+        }
+        jint unboxed = env->CallIntMethod(result, c.integerIntValue);
+        env->DeleteLocalRef(result);
+        return unboxed;
+    }
+
+    JNIEXPORT jlong JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_createCounter(JNIEnv*, jclass) {
+        return reinterpret_cast<jlong>(new Counter());
+    }
+
+    JNIEXPORT void JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_increment(JNIEnv*, jclass, jlong ptr) {
+        reinterpret_cast<Counter*>(ptr)->increment();
+    }
+
+    JNIEXPORT void JNICALL Java_com_kheiron_ktbind_benchmark_HandWrittenJni_destroyCounter(JNIEnv*, jclass, jlong ptr) {
+        delete reinterpret_cast<Counter*>(ptr);
+    }
+}
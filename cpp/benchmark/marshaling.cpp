@@ -0,0 +1,337 @@
+/**
+ * Native benchmark harness that measures the marshaling throughput of ktbind type converters.
+ * The harness starts a JVM in-process with the JNI invocation API, and drives the converters of `java::ArgType`
+ * directly from C++, converting values in both directions across a grid of payload sizes and nesting depths.
+ * Results are written as JSON such that runs on different commits can be compared, e.g.
+ *
+ *     ktbind_marshaling --output results.json --label $(git rev-parse --short HEAD)
+ *
+ * Arguments after `--` are passed to the JVM, e.g. `-- -Xmx4g -Djava.class.path=kotlin/build/classes/kotlin/test`.
+ */
+#include "ktbind/ktbind.hpp"
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    struct Options {
+        /** File to write results to, or standard output if empty. */
+        std::string output;
+        /** Free-form text that identifies the run, e.g. a commit hash. */
+        std::string label;
+        /** Runs only benchmarks whose name contains this text. */
+        std::string filter;
+        /** Path to a ktbind extension module to load with `System.load` before benchmarks start. */
+        std::string library;
+        /** Minimum time in seconds spent measuring a single grid point. */
+        double min_time = 0.5;
+        /** Options passed to `JNI_CreateJavaVM`. */
+        std::vector<std::string> jvm_options;
+    };
+
+    struct Result {
+        std::string benchmark;
+        const char* direction;
+        const char* unit;
+        std::size_t size;
+        std::size_t depth;
+        std::size_t iterations;
+        double mean_ns;
+        double min_ns;
+    };
+
+    void check_exception(JNIEnv* env) {
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error("Java exception raised during benchmark");
+        }
+    }
+
+    /**
+     * Executes an operation repeatedly until the minimum measurement time elapses.
+     * Each iteration runs in its own local reference frame such that Java objects created by the operation are released.
+     */
+    template <typename F>
+    void measure(JNIEnv* env, const Options& options, Result& result, F&& operation) {
+        // warm up
+        env->PushLocalFrame(64);
+        operation();
+        env->PopLocalFrame(nullptr);
+        check_exception(env);
+
+        const auto min_time = std::chrono::duration<double>(options.min_time);
+        clock_type::duration total = clock_type::duration::zero();
+        clock_type::duration fastest = clock_type::duration::max();
+        std::size_t iterations = 0;
+        while (total < min_time || iterations < 3) {
+            env->PushLocalFrame(64);
+            auto start = clock_type::now();
+            operation();
+            auto elapsed = clock_type::now() - start;
+            env->PopLocalFrame(nullptr);
+            check_exception(env);
+
+            total += elapsed;
+            fastest = std::min(fastest, elapsed);
+            ++iterations;
+        }
+
+        result.iterations = iterations;
+        result.mean_ns = std::chrono::duration<double, std::nano>(total).count() / iterations;
+        result.min_ns = std::chrono::duration<double, std::nano>(fastest).count();
+    }
+
+    struct Harness {
+        Harness(JNIEnv* env, const Options& options) : _env(env), _options(options) {}
+
+        /** Measures conversion of a native value to Java, and of the equivalent Java value back to native. */
+        template <typename T>
+        void run(const std::string& benchmark, const char* unit, std::size_t size, std::size_t depth, const T& value) {
+            if (benchmark.find(_options.filter) == std::string::npos) {
+                return;
+            }
+
+            Result to_java{benchmark, "to_java", unit, size, depth};
+            measure(_env, _options, to_java, [&]() {
+                java::ArgType<T>::java_value(_env, value);
+            });
+            report(to_java);
+
+            java::LocalObjectRef java_value(_env, java::ArgType<T>::java_value(_env, value));
+            using java_type = decltype(java::ArgType<T>::java_value(_env, value));
+            Result to_native{benchmark, "to_native", unit, size, depth};
+            measure(_env, _options, to_native, [&]() {
+                T native_value = java::ArgType<T>::native_value(_env, static_cast<java_type>(java_value.ref()));
+                (void)native_value;
+            });
+            report(to_native);
+        }
+
+        const std::vector<Result>& results() const {
+            return _results;
+        }
+
+    private:
+        void report(const Result& result) {
+            std::cerr << std::left << std::setw(24) << result.benchmark << std::setw(10) << result.direction
+                << std::right << std::setw(10) << result.size << " " << std::left << std::setw(8) << result.unit
+                << "depth " << result.depth << std::right << std::setw(16) << std::fixed << std::setprecision(1)
+                << result.mean_ns << " ns/op" << std::endl;
+            _results.push_back(result);
+        }
+
+        JNIEnv* _env;
+        const Options& _options;
+        std::vector<Result> _results;
+    };
+
+    std::string make_string(std::size_t length) {
+        std::string str(length, ' ');
+        for (std::size_t i = 0; i < length; ++i) {
+            str[i] = static_cast<char>('a' + i % 26);
+        }
+        return str;
+    }
+
+    /** A list of lists nested to the given depth, with a list of strings at the innermost level. */
+    template <std::size_t Depth>
+    struct Nested {
+        using type = std::vector<typename Nested<Depth - 1>::type>;
+
+        static type make(std::size_t fanout) {
+            return type(fanout, Nested<Depth - 1>::make(fanout));
+        }
+    };
+
+    template <>
+    struct Nested<1> {
+        using type = std::vector<std::string>;
+
+        static type make(std::size_t fanout) {
+            return type(fanout, "item");
+        }
+    };
+
+    void string_benchmarks(Harness& harness) {
+        for (std::size_t length = 10; length <= 10'000'000; length *= 10) {
+            harness.run("string", "bytes", length, 1, make_string(length));
+        }
+    }
+
+    void collection_benchmarks(Harness& harness) {
+        for (std::size_t count = 10; count <= 1'000'000; count *= 10) {
+            std::vector<int32_t> int_array(count);
+            std::list<int32_t> int_list;
+            std::vector<std::string> string_list;
+            std::unordered_map<std::string, int32_t> string_map;
+            for (std::size_t i = 0; i < count; ++i) {
+                int32_t value = static_cast<int32_t>(i);
+                int_array[i] = value;
+                int_list.push_back(value);
+                string_list.push_back(std::to_string(i));
+                string_map.emplace(std::to_string(i), value);
+            }
+
+            harness.run("IntArray", "elements", count, 1, int_array);
+            harness.run("List<Int>", "elements", count, 1, int_list);
+            harness.run("List<String>", "elements", count, 1, string_list);
+            harness.run("Map<String,Int>", "elements", count, 1, string_map);
+        }
+    }
+
+    /** Measures nested lists with approximately the same number of strings at each depth. */
+    template <std::size_t... Depths>
+    void nested_benchmarks(Harness& harness, std::index_sequence<Depths...>) {
+        constexpr double leaf_count = 4096;
+        auto run = [&](auto depth) {
+            constexpr std::size_t D = decltype(depth)::value;
+            std::size_t fanout = static_cast<std::size_t>(std::lround(std::pow(leaf_count, 1.0 / D)));
+            std::size_t leaves = static_cast<std::size_t>(std::lround(std::pow(fanout, D)));
+            harness.run("nested", "elements", leaves, D, Nested<D>::make(fanout));
+        };
+        (run(std::integral_constant<std::size_t, Depths + 1>()), ...);
+    }
+
+    std::string java_version(JNIEnv* env) {
+        java::LocalClassRef systemClass(env, "java/lang/System");
+        java::StaticMethod getProperty = systemClass.getStaticMethod("getProperty", "(Ljava/lang/String;)Ljava/lang/String;");
+        java::LocalObjectRef key(env, java::ArgType<std::string>::java_value(env, "java.vm.version"));
+        java::LocalObjectRef value(env, env->CallStaticObjectMethod(systemClass.ref(), getProperty.ref(), key.ref()));
+        check_exception(env);
+        return java::ArgType<std::string>::native_value(env, static_cast<jstring>(value.ref()));
+    }
+
+    void load_library(JNIEnv* env, const std::string& path) {
+        java::LocalClassRef systemClass(env, "java/lang/System");
+        java::StaticMethod load = systemClass.getStaticMethod("load", "(Ljava/lang/String;)V");
+        java::LocalObjectRef pathString(env, java::ArgType<std::string>::java_value(env, path));
+        env->CallStaticVoidMethod(systemClass.ref(), load.ref(), pathString.ref());
+        check_exception(env);
+    }
+
+    std::string json_string(const std::string& str) {
+        std::ostringstream os;
+        os << '"';
+        for (char c : str) {
+            switch (c) {
+                case '"': os << "\\\""; break;
+                case '\\': os << "\\\\"; break;
+                case '\n': os << "\\n"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+                    } else {
+                        os << c;
+                    }
+            }
+        }
+        os << '"';
+        return os.str();
+    }
+
+    void write_json(std::ostream& os, const Options& options, const std::string& jvm, const std::vector<Result>& results) {
+        std::time_t now = std::time(nullptr);
+        std::tm utc = *std::gmtime(&now);
+
+        os << "{\n";
+        os << "  \"label\": " << json_string(options.label) << ",\n";
+        os << "  \"timestamp\": \"" << std::put_time(&utc, "%Y-%m-%dT%H:%M:%SZ") << "\",\n";
+        os << "  \"jvm\": " << json_string(jvm) << ",\n";
+        os << "  \"min_time\": " << options.min_time << ",\n";
+        os << "  \"results\": [";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            os << (i > 0 ? "," : "") << "\n    {"
+                << "\"benchmark\": " << json_string(r.benchmark)
+                << ", \"direction\": \"" << r.direction << "\""
+                << ", \"size\": " << r.size
+                << ", \"unit\": \"" << r.unit << "\""
+                << ", \"depth\": " << r.depth
+                << ", \"iterations\": " << r.iterations
+                << std::fixed << std::setprecision(1)
+                << ", \"mean_ns\": " << r.mean_ns
+                << ", \"min_ns\": " << r.min_ns
+                << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    int usage(const char* program) {
+        std::cerr << "usage: " << program << " [--output FILE] [--label TEXT] [--filter TEXT] [--min-time SECONDS] [--library PATH] [-- JVM_OPTIONS...]" << std::endl;
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--") {
+            options.jvm_options.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--label" && has_value) {
+            options.label = argv[++i];
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && has_value) {
+            options.min_time = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--library" && has_value) {
+            options.library = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    // start a JVM in this process
+    std::vector<JavaVMOption> jvm_options;
+    for (auto&& option : options.jvm_options) {
+        jvm_options.push_back(JavaVMOption{const_cast<char*>(option.c_str()), nullptr});
+    }
+    JavaVMInitArgs vm_args;
+    vm_args.version = JNI_VERSION_1_8;
+    vm_args.nOptions = static_cast<jint>(jvm_options.size());
+    vm_args.options = jvm_options.data();
+    vm_args.ignoreUnrecognized = JNI_FALSE;
+
+    JavaVM* vm;
+    JNIEnv* env;
+    if (JNI_CreateJavaVM(&vm, reinterpret_cast<void**>(&env), &vm_args) != JNI_OK) {
+        std::cerr << "error: cannot create Java virtual machine" << std::endl;
+        return 1;
+    }
+    java::Environment::load(vm);
+    java::this_thread.setEnv(env);
+
+    int rc = 0;
+    try {
+        if (!options.library.empty()) {
+            load_library(env, options.library);
+        }
+
+        std::string jvm = java_version(env);
+        Harness harness(env, options);
+        string_benchmarks(harness);
+        collection_benchmarks(harness);
+        nested_benchmarks(harness, std::make_index_sequence<5>());
+
+        if (options.output.empty()) {
+            write_json(std::cout, options, jvm, harness.results());
+        } else {
+            std::ofstream file(options.output);
+            write_json(file, options, jvm, harness.results());
+        }
+    } catch (std::exception& ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        rc = 1;
+    }
+
+    java::Environment::unload(vm);
+    vm->DestroyJavaVM();
+    return rc;
+}
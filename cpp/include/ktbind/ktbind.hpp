@@ -10,19 +10,51 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <tuple>
 
 #include <list>
 #include <map>
+#include <optional>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <variant>
 #include <vector>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <typeindex>
+#include <utility>
 #include <cassert>
 
+#if defined(KTBIND_ENABLE_USDT)
+#include <sys/sdt.h>
+#endif
+
+#if defined(KTBIND_STUB_GENERATOR)
+#include <filesystem>
+#endif
+
+#if defined(__GNUC__)
+/** Marks a function that runs rarely, such that it is never inlined and placed apart from frequently executed code. */
+#define KTBIND_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define KTBIND_COLD __declspec(noinline)
+#else
+#define KTBIND_COLD
+#endif
+
 namespace java {
     /** 
      * Builds a zero-terminated string literal from an std::array.
@@ -186,49 +218,117 @@ namespace java {
         std::ostringstream str;
     };
 
+    /**
+     * Cached references to `java.lang.Exception` and `Throwable.getMessage`, shared by all exception translations.
+     */
+    struct ExceptionClasses {
+        /** Global reference to the class `java.lang.Exception`, created in [load] and deleted in [unload]. */
+        jclass exception;
+        jmethodID get_message;
+
+        static const ExceptionClasses& get() noexcept {
+            return instance();
+        }
+
+        /** Resolves the class and method. Invoked when the library is loaded, before any exception is translated. */
+        static void load(JNIEnv* env) {
+            ExceptionClasses& classes = instance();
+            if (classes.exception != nullptr) {
+                return;
+            }
+            jclass throwableClass = env->FindClass("java/lang/Throwable");
+            classes.get_message = env->GetMethodID(throwableClass, "getMessage", "()Ljava/lang/String;");
+            env->DeleteLocalRef(throwableClass);
+
+            jclass exceptionClass = env->FindClass("java/lang/Exception");
+            classes.exception = static_cast<jclass>(env->NewGlobalRef(exceptionClass));
+            env->DeleteLocalRef(exceptionClass);
+        }
+
+        /** Releases the global reference. Invoked when the library is unloaded. */
+        static void unload(JNIEnv* env) {
+            ExceptionClasses& classes = instance();
+            if (classes.exception != nullptr) {
+                env->DeleteGlobalRef(classes.exception);
+            }
+            classes = ExceptionClasses{};
+        }
+
+    private:
+        static ExceptionClasses& instance() noexcept {
+            static ExceptionClasses classes{};
+            return classes;
+        }
+    };
+
     /**
      * An exception that originates from Java.
+     * The Java exception object is kept as a global reference, and its message is fetched on the first call to
+     * `what()`, on any thread, such that exceptions that are only passed back to Java cost no extra JNI calls.
      */
     struct JavaException : std::exception {
         JavaException(JNIEnv* env) {
             if (env->ExceptionCheck()) {
-                ex = env->ExceptionOccurred();
+                jthrowable local = env->ExceptionOccurred();
 
                 // clear the exception to allow calling JNI functions
                 env->ExceptionClear();
 
-                // extract exception message using low-level functions
-                jclass exceptionClass = env->GetObjectClass(ex);
-                jmethodID getMessageFunc = env->GetMethodID(exceptionClass, "getMessage", "()Ljava/lang/String;");
-                jstring messageObject = static_cast<jstring>(env->CallObjectMethod(ex, getMessageFunc));
-                const char* c_str = env->GetStringUTFChars(messageObject, nullptr);
-                message = c_str;
-                env->ReleaseStringUTFChars(messageObject, c_str);
-                env->DeleteLocalRef(messageObject);
-                env->DeleteLocalRef(exceptionClass);
+                ex = static_cast<jthrowable>(env->NewGlobalRef(local));
+                env->DeleteLocalRef(local);
             }
         }
 
         /**
-         * Exceptions must not be copied as they contain a JNI local reference.
+         * Exceptions must not be copied as they own a JNI global reference.
          */
         JavaException(const JavaException&) = delete;
 
-        const char* what() const noexcept {
-            return message.c_str();
-        }
+        ~JavaException();
+
+        const char* what() const noexcept;
 
         /**
          * Used by the interoperability framework to re-throw the exception in Java before crossing the native to Java
          * boundary, unless the exception has been caught by the user.
+         * The global reference is released when the exception is destroyed.
          */
         jthrowable innerException() const noexcept {
             return ex;
         }
 
     private:
+        /** Calls `getMessage` on the Java exception object; a pending exception is preserved. */
+        static std::string get_message(JNIEnv* env, jthrowable ex) {
+            jthrowable pending = env->ExceptionOccurred();
+            if (pending != nullptr) {
+                env->ExceptionClear();
+            }
+
+            std::string result;
+            jstring messageObject = static_cast<jstring>(env->CallObjectMethod(ex, ExceptionClasses::get().get_message));
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();  // message not available
+            } else if (messageObject != nullptr) {
+                const char* c_str = env->GetStringUTFChars(messageObject, nullptr);
+                if (c_str != nullptr) {
+                    result = c_str;
+                    env->ReleaseStringUTFChars(messageObject, c_str);
+                }
+                env->DeleteLocalRef(messageObject);
+            }
+
+            if (pending != nullptr) {
+                env->Throw(pending);
+                env->DeleteLocalRef(pending);
+            }
+            return result;
+        }
+
         jthrowable ex = nullptr;
-        std::string message;
+        /** Guards fetching the message, which threads holding the same exception may request concurrently. */
+        mutable std::once_flag message_flag;
+        mutable std::string message;
     };
 
     class LocalClassRef;
@@ -419,6 +519,301 @@ namespace java {
         jclass _ref;
     };
 
+    /**
+     * Kinds of activity recorded by the tracer.
+     */
+    enum class TraceCategory : std::size_t {
+        /** A call from Java to native code through a function binding. */
+        call,
+        /** A call from native code to a Kotlin function object passed as a callback. */
+        callback,
+        /** Attaching a native thread to the Java virtual machine. */
+        attach,
+        /** Translating a native exception into a Java exception. */
+        exception
+    };
+
+    constexpr std::size_t trace_category_count = 4;
+
+#if defined(KTBIND_ENABLE_TRACING)
+    /**
+     * A time interval recorded by the tracer.
+     */
+    struct TraceEvent {
+        TraceCategory category;
+        /** The Java class a function binding is registered with, or empty. */
+        std::string_view scope;
+        /** The name of the function binding or the activity. Must have static storage duration. */
+        std::string_view name;
+        /** Start of the interval in nanoseconds, relative to an arbitrary fixed point. */
+        std::uint64_t begin;
+        /** End of the interval in nanoseconds. */
+        std::uint64_t end;
+    };
+
+    /**
+     * Records time intervals into fixed-size per-thread ring buffers, and exports them in the Chrome trace event
+     * format, which both `chrome://tracing` and the Perfetto UI can open.
+     * Recording takes no locks; once a ring buffer is full, the oldest events are overwritten.
+     */
+    class Tracer {
+    public:
+        constexpr static std::size_t default_capacity = 8192;
+
+        constexpr static const char* category_names[trace_category_count] = {
+            "call", "callback", "attach", "exception"
+        };
+
+        static bool enabled() noexcept {
+            return registry().enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Starts recording events.
+         * @param capacity The number of events retained per thread. Applies to threads that record their first event
+         * after the call.
+         */
+        static void start(std::size_t capacity = default_capacity) {
+            if (capacity == 0) {
+                throw std::invalid_argument("Trace buffer capacity must be positive.");
+            }
+            Registry& r = registry();
+            r.capacity.store(capacity, std::memory_order_relaxed);
+            r.enabled.store(true, std::memory_order_relaxed);
+        }
+
+        /**
+         * Stops recording events. Events recorded so far are retained.
+         */
+        static void stop() noexcept {
+            registry().enabled.store(false, std::memory_order_relaxed);
+        }
+
+        /**
+         * Discards all events recorded so far, and releases the buffers of threads that have terminated.
+         */
+        static void clear() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.buffers.erase(std::remove_if(r.buffers.begin(), r.buffers.end(), [](auto&& buffer) {
+                return buffer.use_count() == 1;
+            }), r.buffers.end());
+            for (auto&& buffer : r.buffers) {
+                buffer->start = buffer->head.load(std::memory_order_acquire);
+            }
+        }
+
+        static std::uint64_t now() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count();
+        }
+
+        /**
+         * Appends an event to the ring buffer of the calling thread.
+         */
+        static void record(TraceCategory category, std::string_view scope, std::string_view name, std::uint64_t begin, std::uint64_t end) noexcept {
+            Buffer* buffer = thread_buffer();
+            if (buffer == nullptr) {
+                return;
+            }
+            std::uint64_t head = buffer->head.load(std::memory_order_relaxed);
+            buffer->slots[head % buffer->capacity].write(head, { category, scope, name, begin, end });
+            buffer->head.store(head + 1, std::memory_order_release);
+        }
+
+        /**
+         * Writes all retained events as a Chrome trace event JSON document.
+         */
+        static void write_json(std::ostream& os) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            for (auto&& buffer : r.buffers) {
+                for (const TraceEvent& event : buffer->snapshot()) {
+                    if (!first) {
+                        os << ",";
+                    }
+                    first = false;
+                    os << "\n{\"name\":\"";
+                    write_name(os, event);
+                    os << "\",\"cat\":\"" << category_names[static_cast<std::size_t>(event.category)] << "\",\"ph\":\"X\",\"ts\":";
+                    write_micros(os, event.begin);
+                    os << ",\"dur\":";
+                    write_micros(os, event.end - event.begin);
+                    os << ",\"pid\":1,\"tid\":" << buffer->thread << "}";
+                }
+            }
+            os << "\n]}\n";
+        }
+
+    private:
+        /**
+         * A ring buffer entry that a reader can copy while the owning thread overwrites it, guarded by a sequence
+         * lock: the sequence is cleared while the fields are written, and set to the event number plus one afterwards.
+         * All fields are atomic, such that a torn read is detected by comparing sequences rather than being undefined.
+         */
+        struct Slot {
+            std::atomic<std::uint64_t> sequence{0};
+            std::atomic<TraceCategory> category{TraceCategory::call};
+            std::atomic<const char*> scope{nullptr};
+            std::atomic<std::size_t> scope_size{0};
+            std::atomic<const char*> name{nullptr};
+            std::atomic<std::size_t> name_size{0};
+            std::atomic<std::uint64_t> begin{0};
+            std::atomic<std::uint64_t> end{0};
+
+            /** Stores an event. Called only by the owning thread. */
+            void write(std::uint64_t index, const TraceEvent& event) noexcept {
+                sequence.store(0, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                category.store(event.category, std::memory_order_relaxed);
+                scope.store(event.scope.data(), std::memory_order_relaxed);
+                scope_size.store(event.scope.size(), std::memory_order_relaxed);
+                name.store(event.name.data(), std::memory_order_relaxed);
+                name_size.store(event.name.size(), std::memory_order_relaxed);
+                begin.store(event.begin, std::memory_order_relaxed);
+                end.store(event.end, std::memory_order_relaxed);
+                sequence.store(index + 1, std::memory_order_release);
+            }
+
+            /** Copies the event with the given number, unless the slot is being written or holds another event. */
+            bool read(std::uint64_t index, TraceEvent& event) const noexcept {
+                if (sequence.load(std::memory_order_acquire) != index + 1) {
+                    return false;
+                }
+                event.category = category.load(std::memory_order_relaxed);
+                event.scope = std::string_view(scope.load(std::memory_order_relaxed), scope_size.load(std::memory_order_relaxed));
+                event.name = std::string_view(name.load(std::memory_order_relaxed), name_size.load(std::memory_order_relaxed));
+                event.begin = begin.load(std::memory_order_relaxed);
+                event.end = end.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return sequence.load(std::memory_order_relaxed) == index + 1;
+            }
+        };
+
+        struct Buffer {
+            Buffer(std::size_t thread, std::size_t capacity) : thread(thread), capacity(capacity), slots(new Slot[capacity]) {}
+
+            /** Sequence number of the thread that owns the buffer, in order of first recorded event. */
+            std::size_t thread;
+            std::size_t capacity;
+            std::unique_ptr<Slot[]> slots;
+            /** Total number of events ever written, updated only by the owning thread. */
+            std::atomic<std::uint64_t> head{0};
+            /** Number of events discarded by the last clear, updated only by readers. */
+            std::uint64_t start = 0;
+
+            /**
+             * Copies retained events while the owning thread may be writing. Events that the writer overwrites
+             * while being copied are skipped.
+             */
+            std::vector<TraceEvent> snapshot() const {
+                std::uint64_t last = head.load(std::memory_order_acquire);
+                std::uint64_t first = std::max(start, last > capacity ? last - capacity : 0);
+                std::vector<TraceEvent> copy;
+                copy.reserve(last - first);
+                for (std::uint64_t k = first; k < last; ++k) {
+                    TraceEvent event;
+                    if (slots[k % capacity].read(k, event)) {
+                        copy.push_back(event);
+                    }
+                }
+                return copy;
+            }
+        };
+
+        struct Registry {
+            std::atomic<bool> enabled{false};
+            std::atomic<std::size_t> capacity{default_capacity};
+            std::mutex mutex;
+            /** Buffers of all threads that have recorded events, including threads that have terminated. */
+            std::vector<std::shared_ptr<Buffer>> buffers;
+            std::size_t threads = 0;
+        };
+
+        static Registry& registry() {
+            static Registry r;
+            return r;
+        }
+
+        static Buffer* thread_buffer() noexcept {
+            thread_local std::shared_ptr<Buffer> buffer;
+            Registry& r = registry();
+            std::size_t capacity = r.capacity.load(std::memory_order_relaxed);
+            if (!buffer || buffer->capacity != capacity) {
+                try {
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    buffer = std::make_shared<Buffer>(buffer ? buffer->thread : ++r.threads, capacity);
+                    r.buffers.push_back(buffer);
+                } catch (std::exception&) {
+                    return nullptr;
+                }
+            }
+            return buffer.get();
+        }
+
+        static void write_name(std::ostream& os, const TraceEvent& event) {
+            if (!event.scope.empty()) {
+                std::string scope(event.scope);
+                std::replace(scope.begin(), scope.end(), '/', '.');
+                write_escaped(os, scope);
+                os << ".";
+            }
+            write_escaped(os, event.name);
+        }
+
+        /** Writes the contents of a JSON string, escaping quotes, backslashes and control characters. */
+        static void write_escaped(std::ostream& os, std::string_view str) {
+            for (char c : str) {
+                if (c == '"' || c == '\\') {
+                    os << '\\' << c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    os << c;
+                }
+            }
+        }
+
+        static void write_micros(std::ostream& os, std::uint64_t nanos) {
+            os << nanos / 1000 << "." << std::setw(3) << std::setfill('0') << nanos % 1000 << std::setfill(' ');
+        }
+    };
+
+    /**
+     * Records the lifetime of the object as a trace event, if the tracer is running when the object is constructed.
+     */
+    class TraceSpan {
+    public:
+        TraceSpan(TraceCategory category, std::string_view scope, std::string_view name) noexcept
+            : _category(category)
+            , _scope(scope)
+            , _name(name)
+            , _active(Tracer::enabled())
+            , _begin(_active ? Tracer::now() : 0)
+        {}
+
+        ~TraceSpan() {
+            if (_active) {
+                Tracer::record(_category, _scope, _name, _begin, Tracer::now());
+            }
+        }
+
+    private:
+        TraceCategory _category;
+        std::string_view _scope;
+        std::string_view _name;
+        bool _active;
+        std::uint64_t _begin;
+    };
+#else
+    struct TraceSpan {
+        TraceSpan(TraceCategory, std::string_view, std::string_view) noexcept {}
+    };
+#endif
+
     /**
      * Represents the JNI environment in which the extension module is executing.
      */
@@ -449,7 +844,8 @@ namespace java {
                 switch (_vm->GetEnv(reinterpret_cast<void**>(&_env), JNI_VERSION_1_6)) {
                     case JNI_OK:
                         break;
-                    case JNI_EDETACHED:
+                    case JNI_EDETACHED: {
+                        TraceSpan span(TraceCategory::attach, std::string_view(), "AttachCurrentThread");
                         if (_vm->AttachCurrentThread(reinterpret_cast<void**>(&_env), nullptr) == JNI_OK) {
                             assert(_env != nullptr);
                             _attached = true;
@@ -458,6 +854,7 @@ namespace java {
                             return nullptr;
                         }
                         break;
+                    }
                     case JNI_EVERSION:
                     default:
                         // unsupported JVM version or other error
@@ -491,6 +888,237 @@ namespace java {
      */
     static thread_local Environment this_thread;
 
+    inline JavaException::~JavaException() {
+        if (ex != nullptr) {
+            if (JNIEnv* env = this_thread.getEnv()) {
+                env->DeleteGlobalRef(ex);
+            }
+        }
+    }
+
+    inline const char* JavaException::what() const noexcept {
+        std::call_once(message_flag, [this] {
+            if (ex == nullptr) {
+                return;
+            }
+            try {
+                if (JNIEnv* env = this_thread.getEnv()) {
+                    message = get_message(env, ex);
+                }
+            } catch (std::exception&) {
+                // message not available
+            }
+        });
+        return message.c_str();
+    }
+
+    /**
+     * Counts native objects owned by Java objects and global references held by native code, and optionally captures
+     * the Java call stack at which each native object is allocated.
+     * Tracking is active only if the preprocessor macro `KTBIND_ENABLE_LEAK_TRACKING` is defined.
+     */
+    struct LeakTracker {
+        /** Signals that a native object has been allocated and attached to a Java object. */
+        template <typename T>
+        static void object_created(
+            [[maybe_unused]] JNIEnv* env, [[maybe_unused]] std::string_view class_name, [[maybe_unused]] const T* ptr) noexcept {
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+            try {
+                created(env, counters<T>(class_name), ptr);
+            } catch (std::exception&) {
+                // tracking is best-effort, and must not fail object creation
+            }
+#endif
+        }
+
+        /** Signals that a native object attached to a Java object has been deallocated. */
+        template <typename T>
+        static void object_destroyed(
+            [[maybe_unused]] JNIEnv* env, [[maybe_unused]] std::string_view class_name, [[maybe_unused]] const T* ptr) noexcept {
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+            try {
+                destroyed(env, counters<T>(class_name), ptr);
+            } catch (std::exception&) {
+                // tracking is best-effort, and must not fail object disposal
+            }
+#endif
+        }
+
+        static void global_ref_created() noexcept {
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+            state().global_refs.fetch_add(1, std::memory_order_relaxed);
+#endif
+        }
+
+        static void global_ref_deleted() noexcept {
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+            state().global_refs.fetch_sub(1, std::memory_order_relaxed);
+#endif
+        }
+
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+        /**
+         * Counters of a single native class.
+         */
+        struct ClassCounters {
+            ClassCounters(std::string_view class_name) : class_name(class_name) {}
+
+            /** The Java class that holds pointers to objects of the native class, e.g. `com/kheiron/ktbind/Sample`. */
+            std::string_view class_name;
+            std::atomic<std::uint64_t> created{0};
+            std::atomic<std::uint64_t> destroyed{0};
+            std::mutex mutex;
+            /** Global references to Java exceptions instantiated when live objects were allocated. */
+            std::unordered_map<const void*, jobject> allocation_sites;
+        };
+
+        /**
+         * Returns the counters of a native class, registering the class on first use.
+         */
+        template <typename T>
+        static ClassCounters& counters(std::string_view class_name) {
+            static ClassCounters& c = add(class_name);
+            return c;
+        }
+
+        /** All native classes registered so far, in order of registration. */
+        static std::vector<ClassCounters*> classes() {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            std::vector<ClassCounters*> result;
+            for (auto&& c : s.classes) {
+                result.push_back(c.get());
+            }
+            return result;
+        }
+
+        static std::int64_t global_refs() noexcept {
+            return state().global_refs.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Enables or disables capturing the Java call stack when native objects are allocated.
+         * Capturing instantiates a Java exception per allocation, and is therefore expensive.
+         */
+        static void capture_allocation_sites(bool enabled) noexcept {
+            state().capture.store(enabled, std::memory_order_relaxed);
+        }
+
+        /**
+         * Returns the Java call stack captured at the allocation of each live object of a native class.
+         * Objects allocated while capturing was disabled are not included.
+         */
+        static std::vector<std::string> allocation_sites(JNIEnv* env, ClassCounters& c) {
+            std::vector<jobject> sites;
+            {
+                std::lock_guard<std::mutex> lock(c.mutex);
+                for (auto&& [ptr, site] : c.allocation_sites) {
+                    sites.push_back(env->NewLocalRef(site));
+                }
+            }
+
+            LocalClassRef throwableClass(env, "java/lang/Throwable");
+            Method getStackTrace = throwableClass.getMethod("getStackTrace", "()[Ljava/lang/StackTraceElement;");
+            LocalClassRef objectClass(env, "java/lang/Object");
+            Method toString = objectClass.getMethod("toString", "()Ljava/lang/String;");
+
+            std::vector<std::string> result;
+            for (jobject site : sites) {
+                LocalObjectRef siteRef(env, site);
+                LocalObjectRef frames(env, env->CallObjectMethod(site, getStackTrace.ref()));
+                if (env->ExceptionCheck()) {
+                    throw JavaException(env);
+                }
+                jobjectArray arr = static_cast<jobjectArray>(frames.ref());
+                std::string trace;
+                jsize len = env->GetArrayLength(arr);
+                for (jsize i = 0; i < len; ++i) {
+                    LocalObjectRef frame(env, env->GetObjectArrayElement(arr, i));
+                    LocalObjectRef str(env, env->CallObjectMethod(frame.ref(), toString.ref()));
+                    if (env->ExceptionCheck()) {
+                        throw JavaException(env);
+                    }
+                    const char* chars = env->GetStringUTFChars(static_cast<jstring>(str.ref()), nullptr);
+                    if (chars == nullptr) {
+                        throw JavaException(env);
+                    }
+                    trace.append(i > 0 ? "\n" : "").append("at ").append(chars);
+                    env->ReleaseStringUTFChars(static_cast<jstring>(str.ref()), chars);
+                }
+                result.push_back(std::move(trace));
+            }
+            return result;
+        }
+
+    private:
+        struct State {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ClassCounters>> classes;
+            std::atomic<std::int64_t> global_refs{0};
+            std::atomic<bool> capture{false};
+        };
+
+        static State& state() {
+            static State s;
+            return s;
+        }
+
+        static ClassCounters& add(std::string_view class_name) {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.classes.push_back(std::make_unique<ClassCounters>(class_name));
+            return *s.classes.back();
+        }
+
+        static void created(JNIEnv* env, ClassCounters& c, const void* ptr) {
+            c.created.fetch_add(1, std::memory_order_relaxed);
+            if (!state().capture.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            // the call stack of a new exception object identifies the allocation site
+            jobject site = nullptr;
+            jclass cls = env->FindClass("java/lang/Throwable");
+            if (cls != nullptr) {
+                jmethodID init = env->GetMethodID(cls, "<init>", "()V");
+                if (init != nullptr) {
+                    jobject ex = env->NewObject(cls, init);
+                    if (ex != nullptr) {
+                        site = env->NewGlobalRef(ex);
+                        env->DeleteLocalRef(ex);
+                    }
+                }
+                env->DeleteLocalRef(cls);
+            }
+            if (site == nullptr) {
+                env->ExceptionClear();  // capturing is best-effort
+                return;
+            }
+
+            try {
+                std::lock_guard<std::mutex> lock(c.mutex);
+                jobject& entry = c.allocation_sites[ptr];
+                if (entry != nullptr) {
+                    env->DeleteGlobalRef(entry);
+                }
+                entry = site;
+            } catch (std::exception&) {
+                env->DeleteGlobalRef(site);  // drop the allocation site if it cannot be stored
+            }
+        }
+
+        static void destroyed(JNIEnv* env, ClassCounters& c, const void* ptr) {
+            c.destroyed.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(c.mutex);
+            auto it = c.allocation_sites.find(ptr);
+            if (it != c.allocation_sites.end()) {
+                env->DeleteGlobalRef(it->second);
+                c.allocation_sites.erase(it);
+            }
+        }
+#endif
+    };
+
     /**
      * An adapter for an object reference handle that remains valid as the native-to-Java boundary is crossed.
      */
@@ -500,11 +1128,18 @@ namespace java {
 
         GlobalObjectRef(JNIEnv* env, jobject obj) {
             _ref = std::shared_ptr<jobject_struct>(env->NewGlobalRef(obj), [](jobject ref) {
+                if (ref == nullptr) {
+                    return;
+                }
                 JNIEnv* env = this_thread.getEnv();
                 if (env != nullptr) {
                     env->DeleteGlobalRef(ref);
+                    LeakTracker::global_ref_deleted();
                 }
             });
+            if (_ref) {
+                LeakTracker::global_ref_created();
+            }
         }
 
         jobject ref() const {
@@ -516,33 +1151,327 @@ namespace java {
     };
 
     /**
-     * Used in static_assert to have the type name printed in the compiler error message.
+     * Direction of data transfer across the language boundary.
      */
-    template <typename>
-    struct fail : std::false_type {};
+    enum class MarshalDirection : std::size_t {
+        /** Java values converted into native values. */
+        to_native,
+        /** Native values converted into Java values. */
+        to_java
+    };
+
+    constexpr std::size_t marshal_direction_count = 2;
 
     /**
-     * Argument type traits, and argument type conversion between native and Java.
-     * 
-     * Template substitution fails automatically unless the type is a well-known type or has been declared
-     * with DECLARE_DATA_CLASS or DECLARE_NATIVE_CLASS.
+     * Counts the data that type converters transfer across the language boundary in a single binding.
+     * Counting is active only if call statistics are enabled, and a call to a binding is in progress on the thread.
      */
-    template <typename T>
-    struct ArgType {
-        using native_type = void;
-        using java_type = void;
+    struct MarshalingVolume {
+        /** Number of Java objects instantiated, including strings, arrays and boxed primitive values. */
+        std::atomic<std::uint64_t> objects[marshal_direction_count];
+        /** Number of bytes of string and array data copied. */
+        std::atomic<std::uint64_t> bytes[marshal_direction_count];
+        /** Number of collection elements (or map entries) converted. */
+        std::atomic<std::uint64_t> elements[marshal_direction_count];
+
+        static void count_objects([[maybe_unused]] MarshalDirection direction, [[maybe_unused]] std::size_t n = 1) noexcept {
+#if defined(KTBIND_ENABLE_STATISTICS)
+            if (MarshalingVolume* volume = current()) {
+                bump(volume->objects[static_cast<std::size_t>(direction)], n);
+            }
+#endif
+        }
 
-        // unused, included to suppress compiler error messages
-        constexpr static std::string_view kotlin_type = "";
-        constexpr static std::string_view type_sig = "";
+        static void count_bytes([[maybe_unused]] MarshalDirection direction, [[maybe_unused]] std::size_t n) noexcept {
+#if defined(KTBIND_ENABLE_STATISTICS)
+            if (MarshalingVolume* volume = current()) {
+                bump(volume->bytes[static_cast<std::size_t>(direction)], n);
+            }
+#endif
+        }
 
-        // returns the corresponding array type for the base type
-        constexpr static std::string_view array_type_prefix = "[";
-        constexpr static std::string_view array_type_sig = join_v<array_type_prefix, ArgType<T>::type_sig>;
+        static void count_elements([[maybe_unused]] MarshalDirection direction, [[maybe_unused]] std::size_t n) noexcept {
+#if defined(KTBIND_ENABLE_STATISTICS)
+            if (MarshalingVolume* volume = current()) {
+                bump(volume->elements[static_cast<std::size_t>(direction)], n);
+            }
+#endif
+        }
 
-        // unused, included to suppress compiler error messages
-        static void native_value(JNIEnv*, jobject value) {}
-        static void java_value(JNIEnv* env, const T& value) {}
+        /** The counters of the binding being called on this thread, or null if no call is in progress. */
+        static MarshalingVolume*& current() noexcept {
+            thread_local MarshalingVolume* volume = nullptr;
+            return volume;
+        }
+
+    private:
+        /** Counters are updated only by the thread that owns them. */
+        static void bump(std::atomic<std::uint64_t>& counter, std::size_t n) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * Run-time meta-information about a function binding, shared by all invocations of the binding.
+     */
+    struct CallSite {
+        /** The Java class the function is registered with, e.g. `com/kheiron/ktbind/Sample`. */
+        std::string_view class_name;
+        /** The function name as it appears in Kotlin. */
+        std::string_view name;
+        /** Sequence number assigned at registration time, used to index per-thread data. */
+        std::size_t index = 0;
+        /** Whether the call site has been assigned to a binding. */
+        bool registered = false;
+        /**
+         * Qualified names of further bindings of the same function in the same class. These bindings register the
+         * same entry point with Java, hence their calls cannot be told apart and are counted at this call site.
+         */
+        std::vector<std::string> aliases;
+
+        /** The qualified Kotlin name of the binding, e.g. `com.kheiron.ktbind.Sample.get_data`. */
+        std::string qualified_name() const {
+            return qualified_name(class_name, name);
+        }
+
+        /** True if the call site belongs to the binding with the given qualified Kotlin name. */
+        bool matches(const std::string& qualified) const {
+            return qualified_name() == qualified || std::find(aliases.begin(), aliases.end(), qualified) != aliases.end();
+        }
+
+        static std::string qualified_name(std::string_view class_name, std::string_view name) {
+            std::string qualified(class_name);
+            std::replace(qualified.begin(), qualified.end(), '/', '.');
+            qualified.append(".").append(name);
+            return qualified;
+        }
+    };
+
+    /**
+     * Stores all registered call sites in order of registration.
+     */
+    struct CallSites {
+        inline static std::vector<CallSite*> value;
+
+        static void add(CallSite& site, std::string_view class_name, std::string_view name) {
+            if (site.registered) {
+                // adapter instantiation shared by several bindings of the same function in a class
+                std::string qualified = CallSite::qualified_name(class_name, name);
+                if (!site.matches(qualified)) {
+                    site.aliases.push_back(std::move(qualified));
+                }
+                return;
+            }
+            site.class_name = class_name;
+            site.name = name;
+            site.index = value.size();
+            site.registered = true;
+            value.push_back(&site);
+        }
+
+        /**
+         * Looks up a call site by the qualified Kotlin name of the binding.
+         */
+        static const CallSite& find(const std::string& qualified_name) {
+            for (CallSite* site : value) {
+                if (site->matches(qualified_name)) {
+                    return *site;
+                }
+            }
+            throw std::invalid_argument(msg() << "No function binding is registered with the name '" << qualified_name << "'.");
+        }
+    };
+
+    /**
+     * Observes calls from Java to native code without taking any action.
+     * Call instrumentation facilities enabled with a preprocessor macro replace a null observer with an observer of the
+     * same interface.
+     */
+    struct NullCallObserver {
+        /** Whether argument conversion and function execution have to be separated to be observed individually. */
+        constexpr static bool split_phases = false;
+
+        NullCallObserver(JNIEnv*, const CallSite&) noexcept {}
+
+        /** Signals that Java arguments have been converted into native values. */
+        void marshaled() noexcept {}
+
+        /** Signals that the native function has returned. */
+        void executed() noexcept {}
+
+        /** Signals that the call is terminated with an exception. */
+        void failed() noexcept {}
+    };
+
+    /**
+     * Observes calls from native code to a Kotlin function object passed as a callback without taking any action.
+     */
+    struct NullCallbackObserver {
+        NullCallbackObserver(std::string_view) noexcept {}
+
+        /** Signals that the Kotlin function has thrown an exception. */
+        void failed() noexcept {}
+    };
+
+#if defined(KTBIND_ENABLE_USDT)
+    /**
+     * Fires Linux USDT probes `ktbind:call__entry` and `ktbind:call__return` as a call crosses from Java to native code.
+     * Probe arguments are the Java class name and the Kotlin function name of the binding as zero-terminated strings;
+     * the return probe takes a third argument that is 1 if the call terminates with an exception and 0 otherwise.
+     * A probe that no tracer is attached to compiles to a single no-op instruction.
+     */
+    class CallProbe {
+    public:
+        constexpr static bool split_phases = false;
+
+        CallProbe(JNIEnv*, const CallSite& site) noexcept : _site(site), _enclosing(current()) {
+            current() = &site;
+            DTRACE_PROBE2(ktbind, call__entry, site.class_name.data(), site.name.data());
+        }
+
+        ~CallProbe() {
+            DTRACE_PROBE3(ktbind, call__return, _site.class_name.data(), _site.name.data(), _failed ? 1 : 0);
+            current() = _enclosing;
+        }
+
+        void marshaled() noexcept {}
+        void executed() noexcept {}
+
+        void failed() noexcept {
+            _failed = true;
+        }
+
+        /** The binding being called on this thread, or null if no call is in progress. */
+        static const CallSite*& current() noexcept {
+            thread_local const CallSite* site = nullptr;
+            return site;
+        }
+
+    private:
+        const CallSite& _site;
+        const CallSite* _enclosing;
+        bool _failed = false;
+    };
+
+    /**
+     * Fires Linux USDT probes `ktbind:callback__entry` and `ktbind:callback__return` as native code calls a Kotlin
+     * function object. The first two probe arguments identify the binding the callback has been invoked from (empty
+     * strings when invoked outside of a binding, e.g. on a native worker thread), the third is the Kotlin type of the
+     * function object, e.g. `(arg0: Int) -> String`.
+     */
+    class CallbackProbe {
+    public:
+        CallbackProbe(std::string_view kotlin_type) noexcept : _kotlin_type(kotlin_type) {
+            const CallSite* site = CallProbe::current();
+            _class_name = site ? site->class_name.data() : "";
+            _name = site ? site->name.data() : "";
+            DTRACE_PROBE3(ktbind, callback__entry, _class_name, _name, _kotlin_type.data());
+        }
+
+        ~CallbackProbe() {
+            DTRACE_PROBE4(ktbind, callback__return, _class_name, _name, _kotlin_type.data(), _failed ? 1 : 0);
+        }
+
+        void failed() noexcept {
+            _failed = true;
+        }
+
+    private:
+        std::string_view _kotlin_type;
+        const char* _class_name;
+        const char* _name;
+        bool _failed = false;
+    };
+#else
+    using CallProbe = NullCallObserver;
+    using CallbackProbe = NullCallbackObserver;
+#endif
+
+#if defined(KTBIND_ENABLE_TRACING)
+    /**
+     * Records a call from Java to native code as a trace event.
+     */
+    class CallTracer {
+    public:
+        constexpr static bool split_phases = false;
+
+        CallTracer(JNIEnv*, const CallSite& site) noexcept : _span(TraceCategory::call, site.class_name, site.name) {}
+
+        void marshaled() noexcept {}
+        void executed() noexcept {}
+        void failed() noexcept {}
+
+    private:
+        TraceSpan _span;
+    };
+
+    /**
+     * Records a call from native code to a Kotlin function object as a trace event named after the function type.
+     */
+    class CallbackTracer {
+    public:
+        CallbackTracer(std::string_view kotlin_type) noexcept : _span(TraceCategory::callback, std::string_view(), kotlin_type) {}
+
+        void failed() noexcept {}
+
+    private:
+        TraceSpan _span;
+    };
+#else
+    using CallTracer = NullCallObserver;
+    using CallbackTracer = NullCallbackObserver;
+#endif
+
+    /**
+     * Instruments a single call from native code to a Kotlin function object passed as a callback.
+     * Compiles to nothing unless call instrumentation is enabled with a preprocessor macro.
+     */
+    class CallbackScope {
+    public:
+        CallbackScope(std::string_view kotlin_type)
+            : _probe(kotlin_type)
+            , _tracer(kotlin_type)
+        {}
+
+        /** Signals that the Kotlin function has thrown an exception. */
+        void failed() noexcept {
+            _probe.failed();
+            _tracer.failed();
+        }
+
+    private:
+        CallbackProbe _probe;
+        CallbackTracer _tracer;
+    };
+
+    /**
+     * Used in static_assert to have the type name printed in the compiler error message.
+     */
+    template <typename>
+    struct fail : std::false_type {};
+
+    /**
+     * Argument type traits, and argument type conversion between native and Java.
+     * 
+     * Template substitution fails automatically unless the type is a well-known type or has been declared
+     * with DECLARE_DATA_CLASS or DECLARE_NATIVE_CLASS.
+     */
+    template <typename T>
+    struct ArgType {
+        using native_type = void;
+        using java_type = void;
+
+        // unused, included to suppress compiler error messages
+        constexpr static std::string_view kotlin_type = "";
+        constexpr static std::string_view type_sig = "";
+
+        // returns the corresponding array type for the base type
+        constexpr static std::string_view array_type_prefix = "[";
+        constexpr static std::string_view array_type_sig = join_v<array_type_prefix, ArgType<T>::type_sig>;
+
+        // unused, included to suppress compiler error messages
+        static void native_value(JNIEnv*, jobject value) {}
+        static void java_value(JNIEnv* env, const T& value) {}
 
         static_assert(fail<T>::value, "Unrecognized type detected, ensure that all involved types have been declared as a binding type with DECLARE_DATA_CLASS or DECLARE_NATIVE_CLASS.");
     };
@@ -584,9 +1513,29 @@ namespace java {
         static jobject java_box(JNIEnv* env, J value) {
             LocalClassRef cls(env, ArgType<T>::class_name.data());
             StaticMethod valueOf = cls.getStaticMethod("valueOf", value_initializer);
+            if (boxing_allocates(value)) {
+                MarshalingVolume::count_objects(MarshalDirection::to_java);
+            }
             return env->CallStaticObjectMethod(cls.ref(), valueOf.ref(), value);
         }
 
+        /**
+         * True if `valueOf()` instantiates a new object, i.e. the value is outside the range of boxed values that Java
+         * always caches: `true` and `false`, characters up to 127, and integers from -128 to 127 (JLS 5.1.7).
+         * The JVM may cache a wider range of integers, hence an allocation is only likely, not certain.
+         */
+        constexpr static bool boxing_allocates(J value) {
+            if constexpr (std::is_same_v<J, jboolean>) {
+                return false;
+            } else if constexpr (std::is_floating_point_v<J>) {
+                return true;
+            } else if constexpr (std::is_same_v<J, jchar>) {
+                return value > 127;
+            } else {
+                return value < -128 || value > 127;
+            }
+        }
+
         /**
          * Unwraps a primitive type (e.g. int) from an object type (e.g. Integer).
          */
@@ -972,7 +1921,8 @@ namespace java {
         constexpr static std::string_view type_sig = join_v<class_type_prefix, ArgType<T>::class_name, class_type_suffix>;
 
         static native_type native_field_value(JNIEnv* env, jobject obj, Field& fld) {
-            return ArgType<T>::native_value(env, env->GetObjectField(obj, fld.ref()));
+            LocalObjectRef objFieldValue(env, env->GetObjectField(obj, fld.ref()));
+            return ArgType<T>::native_value(env, static_cast<J>(objFieldValue.ref()));
         }
 
         static void java_field_value(JNIEnv* env, jobject obj, Field& fld, native_type value) {
@@ -999,6 +1949,7 @@ namespace java {
     struct ArgType<Object> : CompositeArgType<Object, jobject> {
         constexpr static std::string_view qualified_name = "java.lang.Object";
         constexpr static std::string_view class_name = "java/lang/Object";
+        constexpr static std::string_view kotlin_type = "Any";
     };
 
     /**
@@ -1008,13 +1959,15 @@ namespace java {
     struct ArgType<std::string> : CompositeArgType<std::string, jstring> {
         constexpr static std::string_view qualified_name = "java.lang.String";
         constexpr static std::string_view class_name = "java/lang/String";
+        constexpr static std::string_view kotlin_type = "String";
 
         static jstring java_unbox(JNIEnv* env, jobject obj) {
             return static_cast<jstring>(obj);  // only a pointer cast
         }
 
         static native_type native_field_value(JNIEnv* env, jobject obj, Field& fld) {
-            return native_value(env, static_cast<jstring>(env->GetObjectField(obj, fld.ref())));
+            LocalObjectRef objFieldValue(env, env->GetObjectField(obj, fld.ref()));
+            return native_value(env, static_cast<jstring>(objFieldValue.ref()));
         }
 
         static std::string native_value(JNIEnv* env, jstring value) {
@@ -1025,10 +1978,13 @@ namespace java {
                 s.assign(chars, len);
                 env->ReleaseStringUTFChars(value, chars);
             }
+            MarshalingVolume::count_bytes(MarshalDirection::to_native, len);
             return s;
         }
 
         static jstring java_value(JNIEnv* env, const std::string& value) {
+            MarshalingVolume::count_objects(MarshalDirection::to_java);
+            MarshalingVolume::count_bytes(MarshalDirection::to_java, value.size());
             return env->NewStringUTF(value.data());
         }
     };
@@ -1040,7 +1996,8 @@ namespace java {
     struct ListArgType : CompositeArgType<L, jobject> {
         constexpr static std::string_view qualified_name = "java.util.List";
         constexpr static std::string_view class_name = "java/util/List";
-        constexpr static std::string_view kotlin_type = kotlin_type_specialization<qualified_name, ArgType<T>::kotlin_type>::value;
+        constexpr static std::string_view kotlin_name = "List";
+        constexpr static std::string_view kotlin_type = kotlin_type_specialization<kotlin_name, ArgType<T>::kotlin_type>::value;
 
     public:
         static L native_value(JNIEnv* env, jobject list);
@@ -1082,10 +2039,13 @@ namespace java {
             std::size_t len = env->GetArrayLength(arr);
             native_type vec(len);
             ArgType<T>::native_array_value(env, arr, vec.data(), vec.size());
+            MarshalingVolume::count_bytes(MarshalDirection::to_native, len * sizeof(T));
             return vec;
         }
 
         static jarray java_value(JNIEnv* env, const native_type& arr) {
+            MarshalingVolume::count_objects(MarshalDirection::to_java);
+            MarshalingVolume::count_bytes(MarshalDirection::to_java, arr.size() * sizeof(T));
             return ArgType<T>::java_array_value(env, arr.data(), arr.size());
         }
     };
@@ -1120,7 +2080,8 @@ namespace java {
     struct SetArgType : CompositeArgType<S, jobject> {
         constexpr static std::string_view qualified_name = "java.util.Set";
         constexpr static std::string_view class_name = "java/util/Set";
-        constexpr static std::string_view kotlin_type = kotlin_type_specialization<qualified_name, ArgType<E>::kotlin_type>::value;
+        constexpr static std::string_view kotlin_name = "Set";
+        constexpr static std::string_view kotlin_type = kotlin_type_specialization<kotlin_name, ArgType<E>::kotlin_type>::value;
 
         static S native_value(JNIEnv* env, jobject set);
         static jobject java_value(JNIEnv* env, const S& nativeSet);
@@ -1143,7 +2104,8 @@ namespace java {
     struct MapArgType : CompositeArgType<M, jobject> {
         constexpr static std::string_view qualified_name = "java.util.Map";
         constexpr static std::string_view class_name = "java/util/Map";
-        constexpr static std::string_view kotlin_type = kotlin_type_specialization<qualified_name, ArgType<K>::kotlin_type, ArgType<V>::kotlin_type>::value;
+        constexpr static std::string_view kotlin_name = "Map";
+        constexpr static std::string_view kotlin_type = kotlin_type_specialization<kotlin_name, ArgType<K>::kotlin_type, ArgType<V>::kotlin_type>::value;
 
         static M native_value(JNIEnv* env, jobject map);
         static jobject java_value(JNIEnv* env, const M& nativeMap);
@@ -1159,6 +2121,148 @@ namespace java {
         constexpr static std::string_view concrete_class_name = "java/util/TreeMap";
     };
 
+    /**
+     * Holds either a value or an error, returned by functions whose failures are expected, and are reported to
+     * Kotlin without throwing an exception.
+     * @tparam T The type of the value on success.
+     * @tparam E The type of the error on failure, e.g. an error code or a data class.
+     */
+    template <typename T, typename E>
+    class result {
+    public:
+        static result success(T value) {
+            return result(std::in_place_index<0>, std::move(value));
+        }
+
+        static result failure(E error) {
+            return result(std::in_place_index<1>, std::move(error));
+        }
+
+        bool has_value() const noexcept {
+            return _value.index() == 0;
+        }
+
+        explicit operator bool() const noexcept {
+            return has_value();
+        }
+
+        const T& value() const {
+            return std::get<0>(_value);
+        }
+
+        const E& error() const {
+            return std::get<1>(_value);
+        }
+
+    private:
+        template <std::size_t I, typename V>
+        result(std::in_place_index_t<I> index, V&& value) : _value(index, std::forward<V>(value)) {}
+
+        std::variant<T, E> _value;
+    };
+
+    /**
+     * Cached references to the classes of the Kotlin sealed class `NativeResult`.
+     */
+    struct ResultClasses {
+        /**
+         * Global references to `NativeResult.Success` and `NativeResult.Failure`, created in [load] and deleted in
+         * [unload]. Null if the Kotlin library of the interoperability framework is not on the class path.
+         */
+        jclass success;
+        jclass failure;
+        jmethodID success_init;
+        jmethodID failure_init;
+        jfieldID value;
+        jfieldID error;
+
+        static const ResultClasses& get() {
+            const ResultClasses& classes = instance();
+            if (classes.success == nullptr) {
+                throw std::logic_error("Class 'com.kheiron.ktbind.NativeResult' has not been found when the library was loaded");
+            }
+            return classes;
+        }
+
+        /**
+         * Resolves the classes with the class loader of [JNI_OnLoad], such that results can be converted on threads
+         * attached by native code, whose `FindClass` only sees system classes.
+         */
+        static void load(JNIEnv* env) {
+            ResultClasses& classes = instance();
+            if (classes.success != nullptr) {
+                return;
+            }
+            LocalClassRef successClass(env, "com/kheiron/ktbind/NativeResult$Success", std::nothrow);
+            if (successClass.ref() == nullptr) {
+                env->ExceptionClear();  // results cannot be used by the extension module
+                return;
+            }
+            LocalClassRef failureClass(env, "com/kheiron/ktbind/NativeResult$Failure");
+            classes.success_init = successClass.getMethod("<init>", "(Ljava/lang/Object;)V").ref();
+            classes.failure_init = failureClass.getMethod("<init>", "(Ljava/lang/Object;)V").ref();
+            classes.value = successClass.getField("value", "Ljava/lang/Object;").ref();
+            classes.error = failureClass.getField("error", "Ljava/lang/Object;").ref();
+            classes.success = static_cast<jclass>(env->NewGlobalRef(successClass.ref()));
+            classes.failure = static_cast<jclass>(env->NewGlobalRef(failureClass.ref()));
+        }
+
+        /** Releases the global references. Invoked when the library is unloaded. */
+        static void unload(JNIEnv* env) {
+            ResultClasses& classes = instance();
+            if (classes.success != nullptr) {
+                env->DeleteGlobalRef(classes.success);
+                env->DeleteGlobalRef(classes.failure);
+            }
+            classes = ResultClasses{};
+        }
+
+    private:
+        static ResultClasses& instance() noexcept {
+            static ResultClasses classes{};
+            return classes;
+        }
+    };
+
+    /**
+     * Converts a C++ result into an instance of the Kotlin sealed class `NativeResult`, i.e. `NativeResult.Success`
+     * or `NativeResult.Failure`, and back.
+     */
+    template <typename T, typename E>
+    struct ArgType<result<T, E>> : CompositeArgType<result<T, E>, jobject> {
+        constexpr static std::string_view qualified_name = "com.kheiron.ktbind.NativeResult";
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/NativeResult";
+        constexpr static std::string_view kotlin_type = kotlin_type_specialization<qualified_name, ArgType<T>::kotlin_type, ArgType<E>::kotlin_type>::value;
+
+        static result<T, E> native_value(JNIEnv* env, jobject obj) {
+            const ResultClasses& classes = ResultClasses::get();
+            if (env->IsInstanceOf(obj, classes.success)) {
+                LocalObjectRef value(env, env->GetObjectField(obj, classes.value));
+                return result<T, E>::success(ArgType<T>::native_value(env, ArgType<T>::java_unbox(env, value.ref())));
+            } else {
+                LocalObjectRef error(env, env->GetObjectField(obj, classes.error));
+                return result<T, E>::failure(ArgType<E>::native_value(env, ArgType<E>::java_unbox(env, error.ref())));
+            }
+        }
+
+        static jobject java_value(JNIEnv* env, const result<T, E>& value) {
+            const ResultClasses& classes = ResultClasses::get();
+            jobject obj;
+            if (value.has_value()) {
+                LocalObjectRef boxed(env, ArgType<T>::java_box(env, ArgType<T>::java_value(env, value.value())));
+                obj = env->NewObject(classes.success, classes.success_init, boxed.ref());
+            } else {
+                LocalObjectRef boxed(env, ArgType<E>::java_box(env, ArgType<E>::java_value(env, value.error())));
+                obj = env->NewObject(classes.failure, classes.failure_init, boxed.ref());
+            }
+            if (obj == nullptr) {
+                throw JavaException(env);
+            }
+            MarshalingVolume::count_objects(MarshalDirection::to_java);
+            return obj;
+        }
+    };
+
     /**
      * Meta-information about a native class member variable.
      */
@@ -1171,6 +2275,8 @@ namespace java {
         void (*get_by_value)(JNIEnv* env, jobject obj, Field& fld, const void* native_object_ptr);
         /** A function that persists a value to a Java object field. */
         void (*set_by_value)(JNIEnv* env, jobject obj, Field& fld, void* native_object_ptr);
+        /** The Kotlin type of the field, e.g. `List<String>`. */
+        std::string_view kotlin_type;
     };
 
     /**
@@ -1180,6 +2286,33 @@ namespace java {
         inline static std::map< std::string_view, std::vector<FieldBinding> > value;
     };
 
+    /**
+     * Name of the constant that holds the schema hash in a generated Kotlin data class.
+     */
+    constexpr std::string_view schema_field_name = "KTBIND_SCHEMA_HASH";
+
+    /**
+     * Computes a fingerprint of the fields of a data class from their names and type signatures.
+     * The hash is a sum of FNV-1a hashes of each field, and does not depend on the order fields are declared in.
+     * The result is non-negative such that it can be written as a Kotlin `Long` literal.
+     */
+    inline std::int64_t schema_hash(const std::vector<FieldBinding>& bindings) {
+        std::uint64_t sum = 0;
+        for (auto&& binding : bindings) {
+            std::uint64_t hash = 14695981039346656037ull;
+            auto&& mix = [&hash](std::string_view str) {
+                for (char c : str) {
+                    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+                }
+            };
+            mix(binding.name);
+            mix(std::string_view("\0", 1));
+            mix(binding.signature);
+            sum += hash;
+        }
+        return static_cast<std::int64_t>(sum & 0x7fffffffffffffffull);
+    }
+
     /**
      * Marshals types that are passed by value between C++ and Java/Kotlin.
      */
@@ -1207,6 +2340,7 @@ namespace java {
             if (obj == nullptr) {
                 throw JavaException(env);
             }
+            MarshalingVolume::count_objects(MarshalDirection::to_java);
             
             auto&& bindings = FieldBindings::value[type_sig];
             for (auto&& binding : bindings) {
@@ -1222,6 +2356,8 @@ namespace java {
             if (arr == nullptr) {
                 throw JavaException(env);
             }
+            MarshalingVolume::count_objects(MarshalDirection::to_java);
+            MarshalingVolume::count_elements(MarshalDirection::to_java, len);
             for (std::size_t k = 0; k < len; ++k) {
                 LocalObjectRef objElement(env, ArgType<T>::java_value(env, ptr[k]));
                 env->SetObjectArrayElement(arr, k, objElement.ref());
@@ -1250,6 +2386,7 @@ namespace java {
         static jobject java_value(JNIEnv* env, T&& native_object) {
             // instantiate native object using copy or move constructor
             T* ptr = new T(std::forward<T>(native_object));
+            LeakTracker::object_created(env, ArgType<T>::class_name, ptr);
 
             // instantiate Java object by skipping constructor
             LocalClassRef objClass(env, ArgType<T>::class_name.data());
@@ -1257,6 +2394,7 @@ namespace java {
             if (obj == nullptr) {
                 throw JavaException(env);
             }
+            MarshalingVolume::count_objects(MarshalDirection::to_java);
 
             // store native pointer in Java object field
             Field field = objClass.getField("nativePointer", ArgType<T*>::type_sig.data());
@@ -1274,6 +2412,25 @@ namespace java {
         using type = R;
     };
 
+    /**
+     * Returns the offset of a member variable of a standard-layout class from the start of the object, in bytes, i.e.
+     * the value `offsetof` yields for the member the pointer designates.
+     * The offset is read from the representation of the member pointer, which the Itanium C++ ABI (GCC, Clang) and
+     * MSVC define as this offset for classes without virtual bases; no object is accessed.
+     */
+    template <typename T, typename R>
+    std::size_t member_offset(R T::* member) {
+        static_assert(std::is_standard_layout_v<T>, "Member offsets are well-defined for standard-layout classes only.");
+#if defined(_MSC_VER)
+        std::int32_t offset;
+#else
+        std::ptrdiff_t offset;
+#endif
+        static_assert(sizeof(member) == sizeof(offset), "Unsupported representation of member pointers.");
+        std::memcpy(&offset, &member, sizeof(offset));
+        return static_cast<std::size_t>(offset);
+    }
+
     template <typename>
     struct Function;
 
@@ -1358,6 +2515,69 @@ namespace java {
         constexpr static std::string_view kotlin_type = Function<R(std::decay_t<Args>...)>::kotlin_type;
     };
 
+    /**
+     * Extracts a Java signature from native functions declared `noexcept`, which are distinct types since C++17.
+     */
+    template <typename R, typename... Args>
+    struct Function<R(*)(Args...) noexcept> : Function<R(*)(Args...)> {};
+
+    template <typename T, typename R, typename... Args>
+    struct Function<R(T::*)(Args...) noexcept> : Function<R(T::*)(Args...)> {};
+
+    template <typename T, typename R, typename... Args>
+    struct Function<R(T::*)(Args...) const noexcept> : Function<R(T::*)(Args...) const> {};
+
+    /**
+     * Cached references to the Kotlin function interfaces `kotlin.jvm.functions.FunctionN` and their method `invoke`,
+     * one per arity. Interfaces that appear in the signature of a binding are resolved when the library is loaded.
+     */
+    struct CallbackClasses {
+        constexpr static std::string_view interface_prefix = "Lkotlin/jvm/functions/Function";
+        /** Kotlin declares function interfaces up to `Function22`. */
+        constexpr static std::size_t max_arity = 22;
+
+        struct Entry {
+            /** Global reference to the interface, or null if it has not been resolved. */
+            jclass cls;
+            jmethodID invoke;
+        };
+
+        /** Zero-initialized as static storage. */
+        inline static Entry value[max_arity + 1];
+
+        /** Resolves the function interfaces referenced in a JNI signature, e.g. `(Lkotlin/jvm/functions/Function1;)V`. */
+        static void load(JNIEnv* env, std::string_view signature) {
+            for (std::size_t pos = signature.find(interface_prefix); pos != std::string_view::npos; pos = signature.find(interface_prefix, pos)) {
+                pos += interface_prefix.size();
+                std::size_t end = signature.find(';', pos);
+                std::size_t arity = static_cast<std::size_t>(std::stoul(std::string(signature.substr(pos, end - pos))));
+                if (arity > max_arity || value[arity].cls != nullptr) {
+                    continue;
+                }
+
+                std::string class_name(signature.substr(pos - interface_prefix.size() + 1, end - pos + interface_prefix.size() - 1));
+                LocalClassRef cls(env, class_name.c_str());
+                std::string invoke_sig = "(";
+                for (std::size_t k = 0; k < arity; ++k) {
+                    invoke_sig += "Ljava/lang/Object;";
+                }
+                invoke_sig += ")Ljava/lang/Object;";
+                value[arity].invoke = cls.getMethod("invoke", invoke_sig.c_str()).ref();
+                value[arity].cls = static_cast<jclass>(env->NewGlobalRef(cls.ref()));
+            }
+        }
+
+        /** Releases the global references. Invoked when the library is unloaded. */
+        static void unload(JNIEnv* env) {
+            for (auto&& entry : value) {
+                if (entry.cls != nullptr) {
+                    env->DeleteGlobalRef(entry.cls);
+                }
+                entry = Entry{};
+            }
+        }
+    };
+
     /**
      * Acts as a Java/Kotlin callback proxy in C++ code or a C++ function object proxy in Java/Kotlin code.
      */
@@ -1371,9 +2591,11 @@ namespace java {
             using type = Object;
         };
     
-        constexpr static std::string_view kotlin_function_type = "Lkotlin/jvm/functions/Function";
+        constexpr static std::string_view class_type_prefix = "L";
+        constexpr static std::string_view kotlin_function_type = "kotlin/jvm/functions/Function";
         constexpr static std::string_view semicolon = ";";
-        constexpr static std::string_view type_sig = join_v<kotlin_function_type, integer_to_digits<sizeof...(Args)>::value, semicolon>;
+        constexpr static std::string_view class_name = join_v<kotlin_function_type, integer_to_digits<sizeof...(Args)>::value>;
+        constexpr static std::string_view type_sig = join_v<class_type_prefix, class_name, semicolon>;
         constexpr static std::string_view kotlin_type = Function<R(Args...)>::kotlin_lambda_type;
 
     private:
@@ -1382,9 +2604,15 @@ namespace java {
     public:
         static std::function<R(Args...)> native_value(JNIEnv* env, jobject value) {
             GlobalObjectRef fun = GlobalObjectRef(env, value);
-            LocalClassRef cls(env, fun.ref());
-            Method invoke = cls.getMethod("invoke", invoke_sig);  // lifecycle bound to object reference
-            return [fun = std::move(fun), invoke = std::move(invoke)](Args... args) -> R {
+            // look up the interface method rather than the method of the lambda class, which an ahead-of-time
+            // compiled image (e.g. GraalVM native image) knows nothing about
+            jmethodID invoke = CallbackClasses::value[sizeof...(Args)].invoke;
+            if (invoke == nullptr) {
+                // not part of a binding signature, e.g. a callback converted explicitly
+                LocalClassRef cls(env, class_name.data());
+                invoke = cls.getMethod("invoke", invoke_sig).ref();
+            }
+            return [fun = std::move(fun), invoke](Args... args) -> R {
                 // retrieve an environment reference (which may not be the same as when the function object was created)
                 JNIEnv* env = this_thread.getEnv();
                 if (!env) {
@@ -1396,29 +2624,33 @@ namespace java {
                     }
                 }
 
+                CallbackScope scope(kotlin_type);
+
                 // Kotlin's `FunctionX` family of classes have an `invoke` method that takes and returns Object instances;
                 // primitive types need boxing/unboxing
                 if constexpr (!std::is_same_v<R, void>) {
                     auto objResult = LocalObjectRef(env,
                         env->CallObjectMethod(
-                            fun.ref(), invoke.ref(),
+                            fun.ref(), invoke,
                             LocalObjectRef(env,
                                 ArgType<Args>::java_box(env, ArgType<Args>::java_value(env, args))
                             ).ref()...
                         )
                     );
                     if (env->ExceptionCheck()) {
+                        scope.failed();
                         throw JavaException(env);
                     }
                     return ArgType<R>::native_value(env, ArgType<R>::java_unbox(env, objResult.ref()));
                 } else {
                     env->CallVoidMethod(
-                        fun.ref(), invoke.ref(),
+                        fun.ref(), invoke,
                         LocalObjectRef(env,
                             ArgType<Args>::java_box(env, ArgType<Args>::java_value(env, args))
                         ).ref()...
                     );
                     if (env->ExceptionCheck()) {
+                        scope.failed();
                         throw JavaException(env);
                     }
                 }
@@ -1442,6 +2674,8 @@ namespace java {
 
         Method getFunc = listClass.getMethod("get", Function<Object(int32_t)>::signature);
 
+        MarshalingVolume::count_elements(MarshalDirection::to_native, len);
+
         L nativeList;
         for (jint i = 0; i < len; i++) {
             LocalObjectRef listElement(env, env->CallObjectMethod(list, getFunc.ref(), i));
@@ -1457,6 +2691,8 @@ namespace java {
         Method initFunc = arrayListClass.getMethod("<init>", Function<void(int)>::signature);
         jobject arrayList = env->NewObject(arrayListClass.ref(), initFunc.ref(), nativeList.size());
         Method addFunc = arrayListClass.getMethod("add", Function<bool(Object)>::signature);
+        MarshalingVolume::count_objects(MarshalDirection::to_java);
+        MarshalingVolume::count_elements(MarshalDirection::to_java, nativeList.size());
 
         for (auto&& element : nativeList) {
             LocalObjectRef arrayListElement(env, ArgType<T>::java_box(env, ArgType<T>::java_value(env, element)));
@@ -1483,6 +2719,7 @@ namespace java {
             auto&& element = ArgType<E>::java_unbox(env, setElement.ref());
 
             nativeSet.insert(ArgType<E>::native_value(env, element));
+            MarshalingVolume::count_elements(MarshalDirection::to_native, 1);
 
             hasNext = static_cast<bool>(env->CallBooleanMethod(setIterator.ref(), hasNextFunc.ref()));
         }
@@ -1498,6 +2735,8 @@ namespace java {
         if (set == nullptr) {
             throw JavaException(env);
         }
+        MarshalingVolume::count_objects(MarshalDirection::to_java);
+        MarshalingVolume::count_elements(MarshalDirection::to_java, nativeSet.size());
 
         for (auto&& item : nativeSet) {
             LocalObjectRef element(env, ArgType<E>::java_box(env, ArgType<E>::java_value(env, item)));
@@ -1536,6 +2775,7 @@ namespace java {
             auto&& value = ArgType<V>::java_unbox(env, mapValue.ref());
 
             nativeMap[ArgType<K>::native_value(env, key)] = ArgType<V>::native_value(env, value); 
+            MarshalingVolume::count_elements(MarshalDirection::to_native, 1);
 
             hasNext = static_cast<bool>(env->CallBooleanMethod(mapIterator.ref(), hasNextFunc.ref()));
         }
@@ -1552,6 +2792,8 @@ namespace java {
         if (map == nullptr) {
             throw JavaException(env);
         }
+        MarshalingVolume::count_objects(MarshalDirection::to_java);
+        MarshalingVolume::count_elements(MarshalDirection::to_java, nativeMap.size());
 
         for (auto&& item : nativeMap) {
             LocalObjectRef key(env, ArgType<K>::java_box(env, ArgType<K>::java_value(env, item.first)));
@@ -1584,6 +2826,15 @@ namespace java {
     template <typename T, typename R, typename... Args>
     struct args<R(T::*)(Args...) const> : args<R(Args...)> {};
 
+    template <typename R, typename... Args>
+    struct args<R(*)(Args...) noexcept> : args<R(Args...)> {};
+
+    template <typename T, typename R, typename... Args>
+    struct args<R(T::*)(Args...) noexcept> : args<R(Args...)> {};
+
+    template <typename T, typename R, typename... Args>
+    struct args<R(T::*)(Args...) const noexcept> : args<R(Args...)> {};
+
     template <typename Sig>
     using args_t = typename args<Sig>::type;
 
@@ -1592,27 +2843,116 @@ namespace java {
         : std::integral_constant<bool, std::is_pointer_v<F> && std::is_function_v<std::remove_pointer_t<F>>>
     {};
 
-   struct JavaOutputBuffer : std::stringbuf {
-        JavaOutputBuffer(JNIEnv* env)
-            : _env(env)
-            , _out(LocalClassRef(env, "java/lang/System").getStaticObjectField("out", "Ljava/io/PrintStream;"))
-            , _print(LocalClassRef(env, "java/io/PrintStream").getMethod("print", "(Ljava/lang/String;)V"))
-        {}
-
-        virtual int sync() {
-            _env->CallVoidMethod(_out.ref(), _print.ref(), LocalObjectRef(_env, ArgType<std::string>::java_value(_env, str())).ref());
-            str("");
-            return 0;
-        }
-
-    private:
-        JNIEnv* _env;
-        LocalObjectRef _out;
-        Method _print;
-    };
-
     /**
-     * Prints to the Java standard output `System.out`.
+     * True for types that C and Java pass with the same representation, e.g. `int32_t` and `double`.
+     * Such values convert between Java and native code with a cast, which cannot fail.
+     */
+    template <typename T>
+    struct is_fast_type
+        : std::integral_constant<bool, std::is_arithmetic_v<T> && sizeof(T) == sizeof(java_t<T>)>
+    {};
+
+    template <>
+    struct is_fast_type<void> : std::true_type {};
+
+    /**
+     * True for functions declared `noexcept` that take and return only types for which [is_fast_type] holds.
+     * Calls to such functions need no exception translation or marshaling: they are bound with a fast adapter, or
+     * with `KTBIND_ENABLE_DOWNCALLS`, free functions are called through the Foreign Function & Memory API. Neither
+     * applies if call instrumentation is enabled (see [CallScope::is_null]).
+     */
+    template <typename F>
+    struct is_fast_function : std::false_type {};
+
+    template <typename R, typename... Args>
+    struct is_fast_function<R(*)(Args...) noexcept>
+        : std::integral_constant<bool, (is_fast_type<R>::value && ... && is_fast_type<Args>::value)>
+    {};
+
+    template <typename T, typename R, typename... Args>
+    struct is_fast_function<R(T::*)(Args...) noexcept>
+        : std::integral_constant<bool, (is_fast_type<R>::value && ... && is_fast_type<Args>::value)>
+    {};
+
+    template <typename T, typename R, typename... Args>
+    struct is_fast_function<R(T::*)(Args...) const noexcept>
+        : std::integral_constant<bool, (is_fast_type<R>::value && ... && is_fast_type<Args>::value)>
+    {};
+
+    /**
+     * Cached references to `System.out` and `PrintStream.print`, shared by all uses of `JAVA_OUTPUT`.
+     * The stream is looked up on each use because Java code may replace it with `System.setOut`.
+     */
+    struct SystemOut {
+        /** Global reference to the class `java.lang.System`, created in [load] and deleted in [unload]. */
+        jclass system;
+        jfieldID out;
+        jmethodID print;
+
+        static const SystemOut& get() {
+            const SystemOut& system = instance();
+            if (system.system == nullptr) {
+                throw std::logic_error("Class 'java.lang.System' has not been found when the library was loaded");
+            }
+            return system;
+        }
+
+        /** Resolves the class, field and method. Invoked when the library is loaded. */
+        static void load(JNIEnv* env) {
+            SystemOut& system = instance();
+            if (system.system != nullptr) {
+                return;
+            }
+            LocalClassRef systemClass(env, "java/lang/System", std::nothrow);
+            if (systemClass.ref() == nullptr) {
+                env->ExceptionClear();  // not a complete Java runtime
+                return;
+            }
+            LocalClassRef printClass(env, "java/io/PrintStream");
+            system.out = systemClass.getStaticField("out", "Ljava/io/PrintStream;").ref();
+            system.print = printClass.getMethod("print", "(Ljava/lang/String;)V").ref();
+            system.system = static_cast<jclass>(env->NewGlobalRef(systemClass.ref()));
+        }
+
+        /** Releases the global reference. Invoked when the library is unloaded. */
+        static void unload(JNIEnv* env) {
+            SystemOut& system = instance();
+            if (system.system != nullptr) {
+                env->DeleteGlobalRef(system.system);
+            }
+            system = SystemOut{};
+        }
+
+    private:
+        static SystemOut& instance() noexcept {
+            static SystemOut system{};
+            return system;
+        }
+    };
+
+    struct JavaOutputBuffer : std::stringbuf {
+        JavaOutputBuffer(JNIEnv* env)
+            : _env(env)
+        {}
+
+        virtual int sync() {
+            if (str().empty()) {
+                return 0;
+            }
+            const SystemOut& system = SystemOut::get();
+            LocalObjectRef out(_env, _env->GetStaticObjectField(system.system, system.out));
+            // bypass type converters to keep output out of marshaling statistics
+            _env->CallVoidMethod(out.ref(), system.print, LocalObjectRef(_env, _env->NewStringUTF(str().c_str())).ref());
+            str("");
+            return 0;
+        }
+
+    private:
+        JNIEnv* _env;
+    };
+
+    /**
+     * Prints to the Java standard output `System.out`.
      */
     struct JavaOutput {
         JavaOutput(JNIEnv* env) : _buf(env), _str(&_buf) {}
@@ -1631,334 +2971,3592 @@ namespace java {
     };
 
     /**
-     * Converts a native exception into a Java exception.
+     * Severity of a log message, in increasing order.
      */
-    inline void exception_handler(JNIEnv* env, std::exception& ex) {
-        // ensure that no unhandled Java exception is waiting to be thrown
-        if (!env->ExceptionCheck()) {
-            LocalClassRef cls(env, "java/lang/Exception");
-            env->ThrowNew(cls.ref(), ex.what());
-        }
-    }
+    enum class LogLevel : int {
+        trace,
+        debug,
+        info,
+        warn,
+        error,
+        /** Disables logging when set as the threshold. */
+        off
+    };
 
     /**
-     * Wraps a native function pointer into a function pointer callable from Java.
-     * Adapts a function with the signature R(*func)(Args...).
-     * @tparam func The callable function pointer.
-     * @return A type-safe function pointer to pass to Java's [RegisterNatives] function.
+     * Native logging channel that forwards messages to the Java logging framework log4j.
+     *
+     * Messages below the threshold level are discarded without being formatted. Other messages are queued in a
+     * lock-free buffer owned by the logging thread, and a background thread attached to the Java virtual machine
+     * forwards them in batches to the log4j logger `ktbind`: consecutive messages of the same level are joined with
+     * newlines and passed in a single call. If log4j is not available, messages are printed to `System.out`. When a
+     * buffer is full, messages are dropped rather than blocking the logging thread.
      */
-    template <auto func, typename... Args>
-    struct Adapter {
-        using result_type = decltype(func(std::declval<Args>()...));
+    class Log {
+    public:
+        /** Number of messages each thread can queue before messages are dropped. */
+        constexpr static std::size_t buffer_capacity = 4096;
+        /** Period with which queued messages are forwarded if buffers fill up slowly. */
+        constexpr static std::chrono::milliseconds drain_interval{50};
 
-        static java_t<result_type> invoke(JNIEnv* env, jclass obj, java_t<std::decay_t<Args>>... args) {
-            try {
-                if constexpr (!std::is_same_v<result_type, void>) {
-                    auto&& result = func(ArgType<std::decay_t<Args>>::native_value(env, args)...);
-                    return ArgType<result_type>::java_value(env, std::move(result));
-                } else {
-                    func(ArgType<std::decay_t<Args>>::native_value(env, args)...);
+        static bool enabled(LogLevel level) noexcept {
+            return static_cast<int>(level) >= state().level.load(std::memory_order_relaxed);
+        }
+
+        static LogLevel level() noexcept {
+            return static_cast<LogLevel>(state().level.load(std::memory_order_relaxed));
+        }
+
+        static void set_level(LogLevel level) noexcept {
+            state().level.store(static_cast<int>(level), std::memory_order_relaxed);
+        }
+
+        /** Number of messages accepted by the Java logging framework, excluding those whose upcall failed. */
+        static std::uint64_t written() noexcept {
+            return state().written.load(std::memory_order_relaxed);
+        }
+
+        /** Number of messages dropped because the buffer of the logging thread was full. */
+        static std::uint64_t dropped() noexcept {
+            return state().dropped.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Queues a message for the background thread.
+         */
+        static void write(LogLevel level, std::string&& message) noexcept {
+            Buffer* buffer = thread_buffer();
+            if (buffer == nullptr) {
+                state().dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            std::uint64_t head = buffer->head.load(std::memory_order_relaxed);
+            std::uint64_t tail = buffer->tail.load(std::memory_order_acquire);
+            if (head - tail >= buffer_capacity) {
+                state().dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Record& record = buffer->records[head % buffer_capacity];
+            record.level = level;
+            record.message = std::move(message);
+            buffer->head.store(head + 1, std::memory_order_release);
+
+            if (head - tail == buffer_capacity / 2) {
+                state().wakeup.notify_one();
+            }
+        }
+
+        /**
+         * Captures the class loader used to look up the logging framework.
+         * Invoked when the library is loaded.
+         */
+        static void load(JNIEnv* env) {
+            LocalClassRef threadClass(env, "java/lang/Thread");
+            StaticMethod currentThread = threadClass.getStaticMethod("currentThread", "()Ljava/lang/Thread;");
+            Method getContextClassLoader = threadClass.getMethod("getContextClassLoader", "()Ljava/lang/ClassLoader;");
+            LocalObjectRef thread(env, env->CallStaticObjectMethod(threadClass.ref(), currentThread.ref()));
+            LocalObjectRef loader(env, env->CallObjectMethod(thread.ref(), getContextClassLoader.ref()));
+            if (env->ExceptionCheck()) {
+                throw JavaException(env);
+            }
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (loader.ref() != nullptr) {
+                s.loader = env->NewGlobalRef(loader.ref());
+            }
+        }
+
+        /**
+         * Forwards all queued messages, stops the background thread, and releases the class loader and logger.
+         * Invoked when the library is unloaded.
+         * @param env The environment of the unloading thread, or null if global references cannot be released.
+         */
+        static void unload(JNIEnv* env) {
+            State& s = state();
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.stopping = true;
+            }
+            s.wakeup.notify_one();
+            if (s.worker.joinable()) {
+                s.worker.join();
+            }
+
+            if (env != nullptr) {
+                std::lock_guard<std::mutex> lock(s.drain_mutex);
+                if (s.loader != nullptr) {
+                    env->DeleteGlobalRef(s.loader);
+                    s.loader = nullptr;
                 }
-            } catch (JavaException& ex) {
-                env->Throw(ex.innerException());
-                if constexpr (!std::is_same_v<result_type, void>) {
-                    return java_t<result_type>();
+                if (s.sink.logger != nullptr) {
+                    env->DeleteGlobalRef(s.sink.logger);
                 }
-            } catch (std::exception& ex) {
-                exception_handler(env, ex);
-                if constexpr (!std::is_same_v<result_type, void>) {
-                    return java_t<result_type>();
+                s.sink = Sink{};
+            }
+        }
+
+        /**
+         * Forwards all queued messages on the calling thread.
+         */
+        static void flush(JNIEnv* env) {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.drain_mutex);
+            drain(env);
+        }
+
+    private:
+        struct Record {
+            LogLevel level;
+            std::string message;
+        };
+
+        /** Single-producer single-consumer ring buffer. */
+        struct Buffer {
+            std::unique_ptr<Record[]> records{new Record[buffer_capacity]};
+            /** Number of messages queued, updated only by the owning thread. */
+            std::atomic<std::uint64_t> head{0};
+            /** Number of messages forwarded, updated only by the thread holding the drain lock. */
+            std::atomic<std::uint64_t> tail{0};
+        };
+
+        /**
+         * Java objects used to forward messages, resolved on first use.
+         */
+        struct Sink {
+            bool resolved = false;
+            /** Global reference to a log4j logger, or null if log4j is not available. */
+            jobject logger = nullptr;
+            jmethodID methods[static_cast<int>(LogLevel::off)] = {};
+        };
+
+        struct State {
+            std::atomic<int> level{static_cast<int>(LogLevel::info)};
+            std::atomic<std::uint64_t> written{0};
+            std::atomic<std::uint64_t> dropped{0};
+
+            std::mutex mutex;
+            std::condition_variable wakeup;
+            std::vector<std::shared_ptr<Buffer>> buffers;
+            std::thread worker;
+            bool stopping = false;
+            /** Global reference to the class loader that loaded the library, or null for the system class loader. */
+            jobject loader = nullptr;
+
+            /** Serializes the consumers of all buffers. */
+            std::mutex drain_mutex;
+            Sink sink;
+        };
+
+        /** Allocated once and never released, the background thread may outlive static objects at process exit. */
+        static State& state() {
+            static State* s = new State();
+            return *s;
+        }
+
+        static Buffer* thread_buffer() noexcept {
+            thread_local std::shared_ptr<Buffer> buffer;
+            if (!buffer) {
+                try {
+                    auto created = std::make_shared<Buffer>();
+                    State& s = state();
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    if (s.stopping) {
+                        return nullptr;
+                    }
+                    s.buffers.push_back(created);
+                    if (!s.worker.joinable()) {
+                        s.worker = std::thread(run);
+                    }
+                    buffer = std::move(created);
+                } catch (std::exception&) {
+                    return nullptr;
+                }
+            }
+            return buffer.get();
+        }
+
+        /** Entry point of the background thread. */
+        static void run() {
+            JNIEnv* env = this_thread.getEnv();
+            State& s = state();
+            bool stopping = false;
+            while (!stopping) {
+                {
+                    std::unique_lock<std::mutex> lock(s.mutex);
+                    s.wakeup.wait_for(lock, drain_interval, [&s] { return s.stopping; });
+                    stopping = s.stopping;
+                }
+                if (env != nullptr) {
+                    std::lock_guard<std::mutex> lock(s.drain_mutex);
+                    drain(env);
                 }
             }
         }
-    };
 
-    /**
-     * Wraps a native member function pointer into a function pointer callable from Java.
-     * Adapts a function with the signature R(T::*func)(Args...).
-     * @tparam func The callable member function pointer.
-     * @return A type-safe function pointer to pass to Java's [RegisterNatives] function.
-     */
-    template <typename T, auto func, typename... Args>
-    struct MemberAdapter {
-        using result_type = decltype((std::declval<T>().*func)(std::declval<Args>()...));
+        /** Forwards queued messages from all buffers. Must be called with the drain lock held. */
+        static void drain(JNIEnv* env) {
+            State& s = state();
+            std::vector<std::shared_ptr<Buffer>> buffers;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                // release buffers of terminated threads that have been drained
+                s.buffers.erase(std::remove_if(s.buffers.begin(), s.buffers.end(), [](auto&& buffer) {
+                    return buffer.use_count() == 1 && buffer->head.load(std::memory_order_acquire) == buffer->tail.load(std::memory_order_relaxed);
+                }), s.buffers.end());
+                buffers = s.buffers;
+            }
 
-        static java_t<result_type> invoke(JNIEnv* env, jobject obj, java_t<std::decay_t<Args>>... args) {
+            // standard output has no levels, consecutive messages of any level are printed together
+            bool by_level;
             try {
-                // look up field that stores native pointer
-                LocalClassRef cls(env, obj);
-                Field field = cls.getField("nativePointer", ArgType<T*>::type_sig.data());
-                T* ptr = ArgType<T*>::native_field_value(env, obj, field);
+                by_level = resolve(env).logger != nullptr;
+            } catch (std::exception&) {
+                env->ExceptionClear();  // messages remain queued until the next attempt
+                return;
+            }
+            for (auto&& buffer : buffers) {
+                std::uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+                std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+                std::string batch;
+                while (tail != head) {
+                    LogLevel level = buffer->records[tail % buffer_capacity].level;
+                    std::uint64_t count = 0;
+                    batch.clear();
+                    for (; tail != head; ++tail, ++count) {
+                        Record& record = buffer->records[tail % buffer_capacity];
+                        if (by_level && record.level != level) {
+                            break;
+                        }
+                        if (count > 0) {
+                            batch += '\n';
+                        }
+                        batch += record.message;
+                        record.message.clear();
+                    }
+                    try {
+                        if (forward(env, level, batch)) {
+                            s.written.fetch_add(count, std::memory_order_relaxed);
+                        }
+                    } catch (std::exception&) {
+                        env->ExceptionClear();  // logging must not fail
+                    }
+                }
+                buffer->tail.store(tail, std::memory_order_release);
+            }
+        }
 
-                // invoke native function
-                if (!ptr) {
-                    throw std::logic_error(msg() << "Object " << ArgType<T>::class_name << " has already been disposed of.");
+        /**
+         * Forwards a batch of newline-separated messages with a single upcall.
+         * @return True if the Java logging framework accepted the messages.
+         */
+        static bool forward(JNIEnv* env, LogLevel level, const std::string& messages) {
+            Sink& sink = resolve(env);
+            if (sink.logger != nullptr) {
+                LocalObjectRef str(env, env->NewStringUTF(messages.c_str()));
+                if (str.ref() != nullptr) {
+                    env->CallVoidMethod(sink.logger, sink.methods[static_cast<int>(level)], str.ref());
                 }
-                if constexpr (!std::is_same_v<result_type, void>) {
-                    auto&& result = (ptr->*func)(ArgType<std::decay_t<Args>>::native_value(env, args)...);
-                    return ArgType<result_type>::java_value(env, std::move(result));
-                } else {
-                    (ptr->*func)(ArgType<std::decay_t<Args>>::native_value(env, args)...);
+            } else {
+                const SystemOut& system = SystemOut::get();
+                LocalObjectRef out(env, env->GetStaticObjectField(system.system, system.out));
+                LocalObjectRef str(env, env->NewStringUTF((messages + "\n").c_str()));
+                if (str.ref() != nullptr) {
+                    env->CallVoidMethod(out.ref(), system.print, str.ref());
                 }
-    
-            } catch (JavaException& ex) {
-                env->Throw(ex.innerException());
-                if constexpr (!std::is_same_v<result_type, void>) {
-                    return java_t<result_type>();
+            }
+            bool failed = env->ExceptionCheck();
+            env->ExceptionClear();  // logging must not fail
+            return !failed;
+        }
+
+        /** Looks up the log4j logger using the class loader that loaded the library. */
+        static Sink& resolve(JNIEnv* env) {
+            Sink& sink = state().sink;
+            if (sink.resolved) {
+                return sink;
+            }
+            sink.resolved = true;
+
+            try {
+                jobject loaderRef = nullptr;
+                {
+                    State& s = state();
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    if (s.loader != nullptr) {
+                        loaderRef = env->NewLocalRef(s.loader);
+                    }
                 }
-            } catch (std::exception& ex) {
-                exception_handler(env, ex);
-                if constexpr (!std::is_same_v<result_type, void>) {
-                    return java_t<result_type>();
+                if (loaderRef == nullptr) {
+                    LocalClassRef loaderClass(env, "java/lang/ClassLoader");
+                    StaticMethod getSystemClassLoader = loaderClass.getStaticMethod("getSystemClassLoader", "()Ljava/lang/ClassLoader;");
+                    loaderRef = env->CallStaticObjectMethod(loaderClass.ref(), getSystemClassLoader.ref());
+                }
+                LocalObjectRef loader(env, loaderRef);
+
+                LocalClassRef classClass(env, "java/lang/Class");
+                StaticMethod forName = classClass.getStaticMethod("forName", "(Ljava/lang/String;ZLjava/lang/ClassLoader;)Ljava/lang/Class;");
+                LocalObjectRef name(env, env->NewStringUTF("org.apache.logging.log4j.LogManager"));
+                LocalClassRef managerClass(env, static_cast<jclass>(env->CallStaticObjectMethod(classClass.ref(), forName.ref(), name.ref(), JNI_TRUE, loader.ref())));
+                if (env->ExceptionCheck()) {
+                    throw JavaException(env);
+                }
+
+                StaticMethod getLogger = managerClass.getStaticMethod("getLogger", "(Ljava/lang/String;)Lorg/apache/logging/log4j/Logger;");
+                LocalObjectRef loggerName(env, env->NewStringUTF("ktbind"));
+                LocalObjectRef logger(env, env->CallStaticObjectMethod(managerClass.ref(), getLogger.ref(), loggerName.ref()));
+                if (env->ExceptionCheck()) {
+                    throw JavaException(env);
+                }
+
+                LocalClassRef loggerClass(env, logger.ref());
+                constexpr const char* names[] = { "trace", "debug", "info", "warn", "error" };
+                for (int k = 0; k < static_cast<int>(LogLevel::off); ++k) {
+                    sink.methods[k] = loggerClass.getMethod(names[k], "(Ljava/lang/String;)V").ref();
                 }
+                sink.logger = env->NewGlobalRef(logger.ref());
+            } catch (JavaException&) {
+                // log4j is not available, fall back to standard output
+                env->ExceptionClear();
+                sink.logger = nullptr;
             }
+            return sink;
         }
     };
 
     /**
-     * Wraps a native function pointer or a member function pointer into a function pointer callable from Java.
-     * @tparam func The callable function or member function pointer.
-     * @return A type-erased function pointer to pass to Java's [RegisterNatives] function.
+     * Formats a single log message, and queues it when destroyed.
      */
-    template <typename T, auto func, typename... Args>
-    constexpr void* callable(types<Args...>) {
-        auto&& f = std::conditional_t<
-            std::is_member_function_pointer_v<decltype(func)>,
-            MemberAdapter<T, func, Args...>,
-            Adapter<func, Args...>
-        >::invoke;
-        return reinterpret_cast<void*>(f);
-    }
+    class LogMessage {
+    public:
+        LogMessage(LogLevel level) : _level(level) {}
+
+        ~LogMessage() {
+            Log::write(_level, _str.str());
+        }
+
+        std::ostream& stream() {
+            return _str;
+        }
+
+    private:
+        LogLevel _level;
+        std::ostringstream _str;
+    };
 
+#if defined(KTBIND_ENABLE_STATISTICS)
     /**
-     * Adapts a constructor function to be invoked from Java on object instantiation with a class method.
+     * Phases of a call from Java to native code.
      */
-    template <typename T, typename... Args>
-    struct CreateObjectAdapter {
-        static jobject invoke(JNIEnv* env, jclass cls, java_t<Args>... args) {
-            try {
-                // instantiate native object
-                T* ptr = new T(ArgType<Args>::native_value(env, args)...);
+    enum class CallPhase : std::size_t {
+        /** Conversion of Java arguments into native values. */
+        marshal_in,
+        /** Execution of the native function. */
+        execute,
+        /** Conversion of the native return value into a Java value. */
+        marshal_out
+    };
 
-                // instantiate Java object by skipping constructor
-                LocalClassRef objClass(env, cls);
-                jobject obj = env->AllocObject(objClass.ref());
-                if (obj == nullptr) {
-                    throw JavaException(env);
-                }
+    constexpr std::size_t call_phase_count = 3;
 
-                // store native pointer in Java object field
-                Field field = objClass.getField("nativePointer", ArgType<T*>::type_sig.data());
-                ArgType<T*>::java_field_value(env, obj, field, ptr);
-        
-                return obj;
-            } catch (JavaException& ex) {
-                env->Throw(ex.innerException());
-                return nullptr;
-            } catch (std::exception& ex) {
-                exception_handler(env, ex);
-                return nullptr;
+    /**
+     * Maps durations to latency histogram buckets of logarithmic size, in the style of HdrHistogram.
+     * Each power-of-two range of nanoseconds is split into a fixed number of linear sub-buckets.
+     */
+    struct LatencyBuckets {
+        constexpr static std::size_t sub_bucket_bits = 2;
+        constexpr static std::size_t sub_bucket_count = std::size_t(1) << sub_bucket_bits;
+
+        /** Power-of-two exponent of the longest distinguished duration (~68 s); longer calls share the last bucket. */
+        constexpr static std::size_t max_exponent = 36;
+
+        constexpr static std::size_t count = (max_exponent - sub_bucket_bits + 2) * sub_bucket_count;
+
+        static std::size_t index(std::uint64_t nanos) noexcept {
+            if (nanos < sub_bucket_count) {
+                return static_cast<std::size_t>(nanos);
+            }
+            std::size_t exponent = most_significant_bit(nanos);
+            if (exponent > max_exponent) {
+                return count - 1;
+            }
+            std::size_t sub_bucket = static_cast<std::size_t>(nanos >> (exponent - sub_bucket_bits)) & (sub_bucket_count - 1);
+            return (exponent - sub_bucket_bits + 1) * sub_bucket_count + sub_bucket;
+        }
+
+        /** The smallest duration (in nanoseconds) that falls into a bucket. */
+        static std::uint64_t lower_bound(std::size_t index) noexcept {
+            if (index < sub_bucket_count) {
+                return index;
+            }
+            std::size_t exponent = index / sub_bucket_count + sub_bucket_bits - 1;
+            std::uint64_t sub_bucket = index % sub_bucket_count;
+            return (sub_bucket_count + sub_bucket) << (exponent - sub_bucket_bits);
+        }
+
+    private:
+        static std::size_t most_significant_bit(std::uint64_t n) noexcept {
+#if defined(__GNUC__)
+            return 63 - __builtin_clzll(n);
+#else
+            std::size_t bit = 0;
+            while (n >>= 1) {
+                ++bit;
             }
+            return bit;
+#endif
         }
     };
 
     /**
-     * Adapts a destructor function to be invoked from Java when the object is being disposed of.
-     * This function is bound to the method close() inherited from the interface AutoCloseable.
+     * Counters of a single binding as observed by a single thread.
+     * Updated only by the owning thread but may be read by any thread.
      */
-    template <typename T>
-    struct DestroyObjectAdapter {
-        static void invoke(JNIEnv* env, jobject obj) {
-            try {
-                // look up field that stores native pointer
-                LocalClassRef cls(env, obj);
-                Field field = cls.getField("nativePointer", ArgType<T*>::type_sig.data());
-                T* ptr = ArgType<T*>::native_field_value(env, obj, field);
-                
-                // release native object
-                delete ptr;
+    struct CallCounters {
+        std::atomic<std::uint64_t> calls;
+        std::atomic<std::uint64_t> errors;
+        std::atomic<std::uint64_t> nanos[call_phase_count];
+        std::atomic<std::uint64_t> buckets[call_phase_count][LatencyBuckets::count];
+        MarshalingVolume volume;
+
+        /** Increments a counter without a read-modify-write instruction; safe because there is a single writer. */
+        static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t value = 1) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        void record(CallPhase phase, std::uint64_t nanos_elapsed) noexcept {
+            std::size_t p = static_cast<std::size_t>(phase);
+            bump(nanos[p], nanos_elapsed);
+            bump(buckets[p][LatencyBuckets::index(nanos_elapsed)]);
+        }
+    };
+
+    /**
+     * Counters of a single binding merged across threads.
+     */
+    struct CallTotals {
+        std::uint64_t calls = 0;
+        std::uint64_t errors = 0;
+        std::array<std::uint64_t, call_phase_count> nanos{};
+        std::array<std::array<std::uint64_t, LatencyBuckets::count>, call_phase_count> buckets{};
+        std::array<std::uint64_t, marshal_direction_count> objects{};
+        std::array<std::uint64_t, marshal_direction_count> bytes{};
+        std::array<std::uint64_t, marshal_direction_count> elements{};
+
+        void add(const CallCounters& counters) noexcept {
+            calls += counters.calls.load(std::memory_order_relaxed);
+            errors += counters.errors.load(std::memory_order_relaxed);
+            for (std::size_t p = 0; p < call_phase_count; ++p) {
+                nanos[p] += counters.nanos[p].load(std::memory_order_relaxed);
+                for (std::size_t b = 0; b < LatencyBuckets::count; ++b) {
+                    buckets[p][b] += counters.buckets[p][b].load(std::memory_order_relaxed);
+                }
+            }
+            for (std::size_t d = 0; d < marshal_direction_count; ++d) {
+                objects[d] += counters.volume.objects[d].load(std::memory_order_relaxed);
+                bytes[d] += counters.volume.bytes[d].load(std::memory_order_relaxed);
+                elements[d] += counters.volume.elements[d].load(std::memory_order_relaxed);
+            }
+        }
+
+        void add(const CallTotals& totals) noexcept {
+            combine(totals, [](std::uint64_t& a, std::uint64_t b) { a += b; });
+        }
+
+        void subtract(const CallTotals& totals) noexcept {
+            combine(totals, [](std::uint64_t& a, std::uint64_t b) { a -= b; });
+        }
+
+    private:
+        template <typename Op>
+        void combine(const CallTotals& totals, Op op) noexcept {
+            op(calls, totals.calls);
+            op(errors, totals.errors);
+            for (std::size_t p = 0; p < call_phase_count; ++p) {
+                op(nanos[p], totals.nanos[p]);
+                for (std::size_t b = 0; b < LatencyBuckets::count; ++b) {
+                    op(buckets[p][b], totals.buckets[p][b]);
+                }
+            }
+            for (std::size_t d = 0; d < marshal_direction_count; ++d) {
+                op(objects[d], totals.objects[d]);
+                op(bytes[d], totals.bytes[d]);
+                op(elements[d], totals.elements[d]);
+            }
+        }
+    };
+
+    /**
+     * Collects call counts and latency histograms in per-thread counters, which are merged when read.
+     */
+    class Statistics {
+    public:
+        /**
+         * Returns the counters of a binding that belong to the calling thread.
+         */
+        static CallCounters* counters(const CallSite& site) {
+            thread_local ThreadCounters thread_counters;
+            return thread_counters.get(site);
+        }
+
+        /**
+         * Merges the counters of a binding across all threads, including threads that have already terminated.
+         */
+        static CallTotals totals(const CallSite& site) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            CallTotals totals;
+            if (site.index < r.retired.size()) {
+                totals.add(r.retired[site.index]);
+                totals.subtract(r.baseline[site.index]);
+            }
+            for (ThreadCounters* thread : r.threads) {
+                if (site.index < thread->size) {
+                    if (CallCounters* counters = thread->sites[site.index].load(std::memory_order_acquire)) {
+                        totals.add(*counters);
+                    }
+                }
+            }
+            return totals;
+        }
+
+        /**
+         * Discards all data collected so far.
+         * Counters are owned by the threads that update them, and are not modified; the current values are saved
+         * as a baseline, which is subtracted on subsequent reads.
+         */
+        static void reset() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.ensure_size();
+            for (std::size_t k = 0; k < r.baseline.size(); ++k) {
+                r.baseline[k] = r.retired[k];
+                for (ThreadCounters* thread : r.threads) {
+                    if (k < thread->size) {
+                        if (CallCounters* counters = thread->sites[k].load(std::memory_order_acquire)) {
+                            r.baseline[k].add(*counters);
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        struct ThreadCounters;
+
+        struct Registry {
+            std::mutex mutex;
+            /** Threads that have issued at least one call. */
+            std::vector<ThreadCounters*> threads;
+            /** Counters of threads that have terminated. */
+            std::vector<CallTotals> retired;
+            /** Values subtracted from merged counters, captured by the last reset. */
+            std::vector<CallTotals> baseline;
+
+            void ensure_size() {
+                if (retired.size() < CallSites::value.size()) {
+                    retired.resize(CallSites::value.size());
+                    baseline.resize(CallSites::value.size());
+                }
+            }
+        };
+
+        struct ThreadCounters {
+            std::size_t size = 0;
+            std::unique_ptr<std::atomic<CallCounters*>[]> sites;
+
+            CallCounters* get(const CallSite& site) {
+                if (!sites) {
+                    // all bindings are registered when the library is loaded
+                    size = CallSites::value.size();
+                    sites.reset(new std::atomic<CallCounters*>[size]());
+                    Registry& r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    r.threads.push_back(this);
+                }
+                if (site.index >= size) {
+                    return nullptr;
+                }
+                CallCounters* counters = sites[site.index].load(std::memory_order_relaxed);
+                if (counters == nullptr) {
+                    counters = new CallCounters();
+                    sites[site.index].store(counters, std::memory_order_release);
+                }
+                return counters;
+            }
+
+            ~ThreadCounters() {
+                if (!sites) {
+                    return;
+                }
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.ensure_size();
+                for (std::size_t k = 0; k < size; ++k) {
+                    if (CallCounters* counters = sites[k].load(std::memory_order_relaxed)) {
+                        r.retired[k].add(*counters);
+                        delete counters;
+                    }
+                }
+                r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), this), r.threads.end());
+            }
+        };
+
+        static Registry& registry() {
+            static Registry r;
+            return r;
+        }
+    };
+
+    /**
+     * Reports calls that take longer than a configurable threshold as JDK Flight Recorder events, by calling the static
+     * method `commit` of the Kotlin event class `com.kheiron.ktbind.SlowNativeCallEvent`.
+     */
+    class SlowCallEvents {
+    public:
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/SlowNativeCallEvent";
+        constexpr static std::string_view commit_sig = "(Ljava/lang/String;JJJJJJJJJZ)V";
+
+        /**
+         * Duration in nanoseconds above which a call is reported, or zero if reporting is disabled.
+         * A non-zero value read by a thread makes the event class and method visible to that thread.
+         */
+        static std::uint64_t threshold() noexcept {
+            return state().threshold.load(std::memory_order_acquire);
+        }
+
+        /** Disables reporting, and releases the event class. Invoked when the library is unloaded. */
+        static void unload(JNIEnv* env) {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.threshold.store(0, std::memory_order_release);
+            if (s.cls != nullptr) {
+                env->DeleteGlobalRef(s.cls);
+                s.cls = nullptr;
+                s.method = nullptr;
+            }
+        }
+
+        /**
+         * Sets the duration threshold, and looks up the event class when reporting is first enabled.
+         * @param nanos Duration in nanoseconds, or zero to disable reporting.
+         */
+        static void set_threshold(JNIEnv* env, std::uint64_t nanos) {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (nanos > 0 && s.cls == nullptr) {
+                LocalClassRef cls(env, class_name.data());
+                StaticMethod commit = cls.getStaticMethod("commit", commit_sig);
+                s.method = commit.ref();
+                s.cls = static_cast<jclass>(env->NewGlobalRef(cls.ref()));
+            }
+            // publish the event class and method along with the threshold
+            s.threshold.store(nanos, std::memory_order_release);
+        }
+
+        /**
+         * Emits an event for a call.
+         * Must only be called by a thread that has read a non-zero threshold, which guarantees that the event class
+         * has been looked up. Any pending Java exception (e.g. one raised by the call being reported) is preserved.
+         * @param nanos Time spent in each call phase.
+         * @param volume Data transferred in the call, indexed by [MarshalDirection].
+         */
+        static void report(JNIEnv* env, const CallSite& site, const std::uint64_t (&nanos)[call_phase_count],
+            const std::uint64_t (&objects)[marshal_direction_count], const std::uint64_t (&bytes)[marshal_direction_count],
+            const std::uint64_t (&elements)[marshal_direction_count], bool failed) noexcept
+        {
+            State& s = state();
+            jthrowable pending = env->ExceptionOccurred();
+            if (pending != nullptr) {
+                env->ExceptionClear();
+            }
+            jstring binding = env->NewStringUTF(site.qualified_name().c_str());
+            if (binding != nullptr) {
+                env->CallStaticVoidMethod(s.cls, s.method, binding,
+                    static_cast<jlong>(nanos[0]), static_cast<jlong>(nanos[1]), static_cast<jlong>(nanos[2]),
+                    static_cast<jlong>(objects[0]), static_cast<jlong>(objects[1]),
+                    static_cast<jlong>(bytes[0]), static_cast<jlong>(bytes[1]),
+                    static_cast<jlong>(elements[0]), static_cast<jlong>(elements[1]),
+                    static_cast<jboolean>(failed)
+                );
+                env->DeleteLocalRef(binding);
+            }
+            env->ExceptionClear();  // reporting must not interfere with the call
+            if (pending != nullptr) {
+                env->Throw(pending);
+                env->DeleteLocalRef(pending);
+            }
+        }
+
+    private:
+        struct State {
+            /** Written with release semantics after `cls` and `method` have been set. */
+            std::atomic<std::uint64_t> threshold{0};
+            /** Serializes writers. */
+            std::mutex mutex;
+            /** Global reference to the event class, set when reporting is first enabled and deleted in [unload]. */
+            jclass cls = nullptr;
+            jmethodID method = nullptr;
+        };
+
+        static State& state() {
+            static State s;
+            return s;
+        }
+    };
+
+    /**
+     * A slow call event that is prepared when the call timer stops, and emitted when the object is destroyed.
+     * The call scope destroys the report after its observers, such that emitting the event is not counted towards
+     * the timing, JNI function counts or trace span of the call being reported.
+     */
+    struct SlowCallReport {
+        JNIEnv* env = nullptr;
+        /** The binding to report, or null if the call is not reported. */
+        const CallSite* site = nullptr;
+        std::uint64_t nanos[call_phase_count] = {};
+        /** Data transferred by the call, in the order objects, bytes, elements. */
+        std::uint64_t volume[3][marshal_direction_count] = {};
+        bool failed = false;
+
+        SlowCallReport() = default;
+        SlowCallReport(const SlowCallReport&) = delete;
+
+        ~SlowCallReport() {
+            if (site != nullptr) {
+                SlowCallEvents::report(env, *site, nanos, volume[0], volume[1], volume[2], failed);
+            }
+        }
+    };
+
+    /**
+     * Measures the time spent in each phase of a call, and counts calls and errors.
+     */
+    class CallTimer {
+    public:
+        constexpr static bool split_phases = true;
+
+        CallTimer(JNIEnv* env, const CallSite& site, SlowCallReport& report)
+            : _env(env)
+            , _site(site)
+            , _report(report)
+            , _counters(Statistics::counters(site))
+            , _volume(MarshalingVolume::current())
+            , _threshold(SlowCallEvents::threshold())
+            , _mark(std::chrono::steady_clock::now())
+        {
+            // nested calls (e.g. from a callback) are attributed to the innermost binding
+            if (_counters != nullptr) {
+                MarshalingVolume::current() = &_counters->volume;
+                if (_threshold > 0) {
+                    load_volume(_start);
+                }
+            }
+        }
+
+        ~CallTimer() {
+            MarshalingVolume::current() = _volume;
+            lap();
+            if (_counters != nullptr) {
+                CallCounters::bump(_counters->calls);
+                if (_failed) {
+                    CallCounters::bump(_counters->errors);
+                }
+                if (_threshold > 0 && _elapsed[0] + _elapsed[1] + _elapsed[2] >= _threshold) {
+                    report();
+                }
+            }
+        }
+
+        void marshaled() noexcept {
+            lap();
+        }
+
+        void executed() noexcept {
+            lap();
+        }
+
+        void failed() noexcept {
+            _failed = true;
+        }
+
+    private:
+        /** Attributes the time elapsed since the previous lap to the current phase, and advances to the next phase. */
+        void lap() noexcept {
+            auto now = std::chrono::steady_clock::now();
+            if (_counters != nullptr && _phase < call_phase_count) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _mark).count();
+                _elapsed[_phase] = static_cast<std::uint64_t>(elapsed);
+                _counters->record(static_cast<CallPhase>(_phase), _elapsed[_phase]);
+            }
+            _mark = now;
+            ++_phase;
+        }
+
+        /** Reads the data volume counters of the binding, in the order objects, bytes, elements. */
+        void load_volume(std::uint64_t (&values)[3][marshal_direction_count]) const noexcept {
+            const MarshalingVolume& volume = _counters->volume;
+            for (std::size_t d = 0; d < marshal_direction_count; ++d) {
+                values[0][d] = volume.objects[d].load(std::memory_order_relaxed);
+                values[1][d] = volume.bytes[d].load(std::memory_order_relaxed);
+                values[2][d] = volume.elements[d].load(std::memory_order_relaxed);
+            }
+        }
+
+        /** Prepares a slow call event with the data transferred by this call alone. */
+        void report() noexcept {
+            load_volume(_report.volume);
+            for (std::size_t k = 0; k < 3; ++k) {
+                for (std::size_t d = 0; d < marshal_direction_count; ++d) {
+                    _report.volume[k][d] -= _start[k][d];
+                }
+            }
+            std::copy(std::begin(_elapsed), std::end(_elapsed), std::begin(_report.nanos));
+            _report.env = _env;
+            _report.failed = _failed;
+            _report.site = &_site;
+        }
+
+        JNIEnv* _env;
+        const CallSite& _site;
+        SlowCallReport& _report;
+        CallCounters* _counters;
+        /** Counters of the enclosing call, if any. */
+        MarshalingVolume* _volume;
+        /** Slow call threshold in effect when the call started. */
+        std::uint64_t _threshold;
+        /** Data volume counters of the binding when the call started, captured only if slow calls are reported. */
+        std::uint64_t _start[3][marshal_direction_count];
+        std::uint64_t _elapsed[call_phase_count] = {};
+        std::chrono::steady_clock::time_point _mark;
+        std::size_t _phase = 0;
+        bool _failed = false;
+    };
+#else
+    struct SlowCallReport {};
+
+    struct CallTimer : NullCallObserver {
+        CallTimer(JNIEnv* env, const CallSite& site, SlowCallReport&) noexcept : NullCallObserver(env, site) {}
+    };
+#endif
+
+#if defined(KTBIND_ENABLE_JNI_PROFILER)
+    /**
+     * Categories of JNI functions distinguished by the JNI profiler.
+     */
+    enum class JniOperation : std::size_t {
+        /** `FindClass`, `GetObjectClass` and `GetSuperclass` */
+        find_class,
+        /** `GetMethodID` and `GetStaticMethodID` */
+        method_id,
+        /** `GetFieldID` and `GetStaticFieldID` */
+        field_id,
+        /** `AllocObject`, `NewObject`, `NewString`, `NewStringUTF` and array constructors */
+        new_object,
+        /** `Call*Method`, `CallStatic*Method` and `CallNonvirtual*Method` */
+        call_method,
+        /** `Get*Field`, `Set*Field`, `GetStatic*Field` and `SetStatic*Field` */
+        field_access,
+        /** array length, element and region functions */
+        array_access,
+        /** string length, character and region functions */
+        string_access,
+        /** `NewLocalRef`, `DeleteLocalRef`, `EnsureLocalCapacity`, `PushLocalFrame` and `PopLocalFrame` */
+        local_ref,
+        /** global and weak global reference functions */
+        global_ref,
+        /** `Throw`, `ThrowNew`, `ExceptionOccurred`, `ExceptionCheck` and `ExceptionClear` */
+        exception
+    };
+
+    constexpr std::size_t jni_operation_count = 11;
+
+    /**
+     * Counts JNI function invocations per binding.
+     * While a bound call runs on a thread, the JNI function table of the thread's environment is replaced with a proxy
+     * table whose entries increment a thread-local counter and forward to the original function.
+     */
+    class JniProfiler {
+    public:
+        using Counts = std::array<std::uint64_t, jni_operation_count>;
+
+        /**
+         * JNI function invocation counts of a single binding.
+         */
+        struct Profile {
+            /** Number of profiled calls. */
+            std::uint64_t calls = 0;
+            /** Number of JNI function invocations per category, summed over all calls. */
+            Counts total{};
+            /** Largest number of JNI function invocations per category in a single call. */
+            Counts max{};
+            /** Largest number of JNI function invocations of any category in a single call. */
+            std::uint64_t max_total = 0;
+            /** Largest number of local references alive at the same time in a single call. */
+            std::uint64_t max_local_refs = 0;
+        };
+
+        /**
+         * Local references created by native code on a thread while the proxy function table is installed.
+         * References the Java virtual machine passes as arguments are not included.
+         */
+        struct LocalRefs {
+            /** References created and not yet deleted. */
+            std::uint64_t live = 0;
+            /** Largest value of `live` since the innermost call in progress has started. */
+            std::uint64_t peak = 0;
+        };
+
+        constexpr static std::string_view operation_names[jni_operation_count] = {
+            "find_class", "method_id", "field_id", "new_object", "call_method", "field_access",
+            "array_access", "string_access", "local_ref", "global_ref", "exception"
+        };
+
+        static void enable(bool enabled) noexcept {
+            _enabled.store(enabled, std::memory_order_relaxed);
+        }
+
+        static bool enabled() noexcept {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Substitutes the proxy function table into a JNI environment.
+         * @return The function table to restore, or null if the proxy table has not been installed.
+         */
+        static const JNINativeInterface_* install(JNIEnv* env) {
+            std::call_once(_proxy_initialized, initialize, env->functions);
+            if (env->functions != _original) {
+                return nullptr;  // already installed, or an unrecognized function table
+            }
+            env->functions = &_proxy;
+            return _original;
+        }
+
+        static void uninstall(JNIEnv* env, const JNINativeInterface_* functions) noexcept {
+            if (functions != nullptr) {
+                env->functions = functions;
+            }
+        }
+
+        /** Running totals of JNI function invocations on the calling thread. */
+        static Counts& thread_counts() noexcept {
+            thread_local Counts counts{};
+            return counts;
+        }
+
+        static LocalRefs& thread_local_refs() noexcept {
+            thread_local LocalRefs refs;
+            return refs;
+        }
+
+        /** Attributes JNI function invocations made during a single call to a binding. */
+        static void record(const CallSite& site, const Counts& counts, std::uint64_t local_refs) noexcept {
+            SiteProfile* profile = site_profile(site);
+            if (profile == nullptr) {
+                return;
+            }
+            profile->calls.fetch_add(1, std::memory_order_relaxed);
+            std::uint64_t sum = 0;
+            for (std::size_t k = 0; k < jni_operation_count; ++k) {
+                profile->total[k].fetch_add(counts[k], std::memory_order_relaxed);
+                update_max(profile->max[k], counts[k]);
+                sum += counts[k];
+            }
+            update_max(profile->max_total, sum);
+            update_max(profile->max_local_refs, local_refs);
+        }
+
+        static Profile profile(const CallSite& site) {
+            Profile result;
+            SiteProfile* profile = site_profile(site);
+            if (profile == nullptr) {
+                return result;
+            }
+            result.calls = profile->calls.load(std::memory_order_relaxed);
+            for (std::size_t k = 0; k < jni_operation_count; ++k) {
+                result.total[k] = profile->total[k].load(std::memory_order_relaxed);
+                result.max[k] = profile->max[k].load(std::memory_order_relaxed);
+            }
+            result.max_total = profile->max_total.load(std::memory_order_relaxed);
+            result.max_local_refs = profile->max_local_refs.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        static void reset() noexcept {
+            std::size_t count = profile_count();
+            for (std::size_t i = 0; i < count; ++i) {
+                SiteProfile& profile = _profiles[i];
+                profile.calls.store(0, std::memory_order_relaxed);
+                for (std::size_t k = 0; k < jni_operation_count; ++k) {
+                    profile.total[k].store(0, std::memory_order_relaxed);
+                    profile.max[k].store(0, std::memory_order_relaxed);
+                }
+                profile.max_total.store(0, std::memory_order_relaxed);
+                profile.max_local_refs.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        struct SiteProfile {
+            std::atomic<std::uint64_t> calls;
+            std::atomic<std::uint64_t> total[jni_operation_count];
+            std::atomic<std::uint64_t> max[jni_operation_count];
+            std::atomic<std::uint64_t> max_total;
+            std::atomic<std::uint64_t> max_local_refs;
+        };
+
+        static void update_max(std::atomic<std::uint64_t>& current, std::uint64_t value) noexcept {
+            std::uint64_t observed = current.load(std::memory_order_relaxed);
+            while (observed < value && !current.compare_exchange_weak(observed, value, std::memory_order_relaxed)) {}
+        }
+
+        static std::size_t profile_count() noexcept {
+            std::call_once(_profiles_initialized, [] {
+                // all bindings are registered when the library is loaded
+                _profile_count = CallSites::value.size();
+                _profiles.reset(new SiteProfile[_profile_count]());
+            });
+            return _profile_count;
+        }
+
+        static SiteProfile* site_profile(const CallSite& site) noexcept {
+            return site.index < profile_count() ? &_profiles[site.index] : nullptr;
+        }
+
+        template <typename F>
+        struct Proxy;
+
+        /**
+         * Counts the invocation of a JNI function, and forwards the call to the original function table.
+         * Functions that return an object reference, other than a global reference, create a local reference.
+         */
+        template <typename R, typename... A>
+        struct Proxy<R (JNICALL*)(JNIEnv*, A...)> {
+            template <R (JNICALL* JNINativeInterface_::* function)(JNIEnv*, A...), JniOperation operation>
+            static R JNICALL invoke(JNIEnv* env, A... args) {
+                ++thread_counts()[static_cast<std::size_t>(operation)];
+                if constexpr (std::is_convertible_v<R, jobject> && operation != JniOperation::global_ref) {
+                    R result = (_original->*function)(env, args...);
+                    if (result != nullptr) {
+                        LocalRefs& refs = thread_local_refs();
+                        refs.peak = std::max(refs.peak, ++refs.live);
+                    }
+                    return result;
+                } else if constexpr (std::is_void_v<R> && operation == JniOperation::local_ref) {
+                    // DeleteLocalRef
+                    LocalRefs& refs = thread_local_refs();
+                    if (refs.live > 0) {
+                        --refs.live;
+                    }
+                    return (_original->*function)(env, args...);
+                } else {
+                    return (_original->*function)(env, args...);
+                }
+            }
+        };
+
+        static void initialize(const JNINativeInterface_* original) {
+            _original = original;
+            _proxy = *original;
+
+#define KTBIND_JNI_PROXY(function, operation) \
+            _proxy.function = Proxy<decltype(_proxy.function)>::template invoke<&JNINativeInterface_::function, JniOperation::operation>;
+#define KTBIND_JNI_PROXY_PRIMITIVE(prefix, suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Boolean##suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Byte##suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Char##suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Short##suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Int##suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Long##suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Float##suffix, operation) \
+            KTBIND_JNI_PROXY(prefix##Double##suffix, operation)
+#define KTBIND_JNI_PROXY_CALL(prefix, suffix) \
+            KTBIND_JNI_PROXY_PRIMITIVE(prefix, suffix, call_method) \
+            KTBIND_JNI_PROXY(prefix##Object##suffix, call_method) \
+            KTBIND_JNI_PROXY(prefix##Void##suffix, call_method)
+#define KTBIND_JNI_PROXY_FIELD(prefix, suffix) \
+            KTBIND_JNI_PROXY_PRIMITIVE(prefix, suffix, field_access) \
+            KTBIND_JNI_PROXY(prefix##Object##suffix, field_access)
+
+            KTBIND_JNI_PROXY(FindClass, find_class)
+            KTBIND_JNI_PROXY(GetObjectClass, find_class)
+            KTBIND_JNI_PROXY(GetSuperclass, find_class)
+
+            KTBIND_JNI_PROXY(GetMethodID, method_id)
+            KTBIND_JNI_PROXY(GetStaticMethodID, method_id)
+            KTBIND_JNI_PROXY(GetFieldID, field_id)
+            KTBIND_JNI_PROXY(GetStaticFieldID, field_id)
+
+            KTBIND_JNI_PROXY(AllocObject, new_object)
+            KTBIND_JNI_PROXY(NewObjectV, new_object)
+            KTBIND_JNI_PROXY(NewObjectA, new_object)
+            KTBIND_JNI_PROXY(NewObjectArray, new_object)
+            KTBIND_JNI_PROXY(NewString, new_object)
+            KTBIND_JNI_PROXY(NewStringUTF, new_object)
+            KTBIND_JNI_PROXY_PRIMITIVE(New, Array, new_object)
+
+            // the C++ interface of JNIEnv forwards variadic functions to their va_list variant
+            KTBIND_JNI_PROXY_CALL(Call, MethodV)
+            KTBIND_JNI_PROXY_CALL(Call, MethodA)
+            KTBIND_JNI_PROXY_CALL(CallStatic, MethodV)
+            KTBIND_JNI_PROXY_CALL(CallStatic, MethodA)
+            KTBIND_JNI_PROXY_CALL(CallNonvirtual, MethodV)
+            KTBIND_JNI_PROXY_CALL(CallNonvirtual, MethodA)
+
+            KTBIND_JNI_PROXY_FIELD(Get, Field)
+            KTBIND_JNI_PROXY_FIELD(Set, Field)
+            KTBIND_JNI_PROXY_FIELD(GetStatic, Field)
+            KTBIND_JNI_PROXY_FIELD(SetStatic, Field)
+
+            KTBIND_JNI_PROXY(GetArrayLength, array_access)
+            KTBIND_JNI_PROXY(GetObjectArrayElement, array_access)
+            KTBIND_JNI_PROXY(SetObjectArrayElement, array_access)
+            KTBIND_JNI_PROXY_PRIMITIVE(Get, ArrayElements, array_access)
+            KTBIND_JNI_PROXY_PRIMITIVE(Release, ArrayElements, array_access)
+            KTBIND_JNI_PROXY_PRIMITIVE(Get, ArrayRegion, array_access)
+            KTBIND_JNI_PROXY_PRIMITIVE(Set, ArrayRegion, array_access)
+            KTBIND_JNI_PROXY(GetPrimitiveArrayCritical, array_access)
+            KTBIND_JNI_PROXY(ReleasePrimitiveArrayCritical, array_access)
+
+            KTBIND_JNI_PROXY(GetStringLength, string_access)
+            KTBIND_JNI_PROXY(GetStringChars, string_access)
+            KTBIND_JNI_PROXY(ReleaseStringChars, string_access)
+            KTBIND_JNI_PROXY(GetStringUTFLength, string_access)
+            KTBIND_JNI_PROXY(GetStringUTFChars, string_access)
+            KTBIND_JNI_PROXY(ReleaseStringUTFChars, string_access)
+            KTBIND_JNI_PROXY(GetStringRegion, string_access)
+            KTBIND_JNI_PROXY(GetStringUTFRegion, string_access)
+            KTBIND_JNI_PROXY(GetStringCritical, string_access)
+            KTBIND_JNI_PROXY(ReleaseStringCritical, string_access)
+
+            KTBIND_JNI_PROXY(NewLocalRef, local_ref)
+            KTBIND_JNI_PROXY(DeleteLocalRef, local_ref)
+            KTBIND_JNI_PROXY(EnsureLocalCapacity, local_ref)
+            KTBIND_JNI_PROXY(PushLocalFrame, local_ref)
+            KTBIND_JNI_PROXY(PopLocalFrame, local_ref)
+
+            KTBIND_JNI_PROXY(NewGlobalRef, global_ref)
+            KTBIND_JNI_PROXY(DeleteGlobalRef, global_ref)
+            KTBIND_JNI_PROXY(NewWeakGlobalRef, global_ref)
+            KTBIND_JNI_PROXY(DeleteWeakGlobalRef, global_ref)
+
+            KTBIND_JNI_PROXY(Throw, exception)
+            KTBIND_JNI_PROXY(ThrowNew, exception)
+            KTBIND_JNI_PROXY(ExceptionOccurred, exception)
+            KTBIND_JNI_PROXY(ExceptionCheck, exception)
+            KTBIND_JNI_PROXY(ExceptionClear, exception)
+
+#undef KTBIND_JNI_PROXY_FIELD
+#undef KTBIND_JNI_PROXY_CALL
+#undef KTBIND_JNI_PROXY_PRIMITIVE
+#undef KTBIND_JNI_PROXY
+        }
+
+        inline static std::atomic<bool> _enabled{false};
+        inline static std::once_flag _proxy_initialized;
+        inline static const JNINativeInterface_* _original = nullptr;
+        inline static JNINativeInterface_ _proxy;
+        inline static std::once_flag _profiles_initialized;
+        inline static std::size_t _profile_count = 0;
+        inline static std::unique_ptr<SiteProfile[]> _profiles;
+    };
+
+    /**
+     * Counts JNI function invocations made during a call while the JNI profiler is enabled.
+     */
+    class JniCallCounter {
+    public:
+        constexpr static bool split_phases = false;
+
+        JniCallCounter(JNIEnv* env, const CallSite& site) : _env(env), _site(site) {
+            if (JniProfiler::enabled()) {
+                _functions = JniProfiler::install(env);
+                _start = JniProfiler::thread_counts();
+                JniProfiler::LocalRefs& refs = JniProfiler::thread_local_refs();
+                _local_refs = refs;
+                refs.peak = refs.live;
+                _active = true;
+            }
+        }
+
+        ~JniCallCounter() {
+            if (!_active) {
+                return;
+            }
+            JniProfiler::Counts counts = JniProfiler::thread_counts();
+            for (std::size_t k = 0; k < jni_operation_count; ++k) {
+                counts[k] -= _start[k];
+            }
+            JniProfiler::LocalRefs& refs = JniProfiler::thread_local_refs();
+            JniProfiler::record(_site, counts, refs.peak - _local_refs.live);
+
+            // local references created in a native method are released when the method returns
+            refs.live = _local_refs.live;
+            refs.peak = std::max(refs.peak, _local_refs.peak);
+            JniProfiler::uninstall(_env, _functions);
+        }
+
+        void marshaled() noexcept {}
+        void executed() noexcept {}
+        void failed() noexcept {}
+
+    private:
+        JNIEnv* _env;
+        const CallSite& _site;
+        const JNINativeInterface_* _functions = nullptr;
+        JniProfiler::Counts _start;
+        /** Local reference counters of the enclosing call, if any. */
+        JniProfiler::LocalRefs _local_refs;
+        bool _active = false;
+    };
+#else
+    using JniCallCounter = NullCallObserver;
+#endif
+
+    /**
+     * Instruments a single call from Java to native code.
+     * Compiles to nothing unless call instrumentation is enabled with a preprocessor macro.
+     */
+    class CallScope {
+    public:
+        /** Whether argument conversion and function execution have to be separated to be observed individually. */
+        constexpr static bool split_phases = CallProbe::split_phases || CallTracer::split_phases || JniCallCounter::split_phases || CallTimer::split_phases;
+
+        /**
+         * Whether all observers are null observers, such that entering and leaving the scope cannot throw.
+         * Instrumenting observers may allocate (e.g. per-thread counters), so `noexcept` adapters require a null scope.
+         */
+        constexpr static bool is_null = std::is_base_of_v<NullCallObserver, CallProbe>
+            && std::is_base_of_v<NullCallObserver, CallTracer>
+            && std::is_base_of_v<NullCallObserver, JniCallCounter>
+            && std::is_base_of_v<NullCallObserver, CallTimer>
+            && std::is_empty_v<SlowCallReport>;
+
+        CallScope(JNIEnv* env, const CallSite& site)
+            : _probe(env, site)
+            , _tracer(env, site)
+            , _jni_counter(env, site)
+            , _timer(env, site, _report)
+        {}
+
+        /** Signals that Java arguments have been converted into native values. */
+        void marshaled() noexcept {
+            _probe.marshaled();
+            _tracer.marshaled();
+            _jni_counter.marshaled();
+            _timer.marshaled();
+        }
+
+        /** Signals that the native function has returned. */
+        void executed() noexcept {
+            _probe.executed();
+            _tracer.executed();
+            _jni_counter.executed();
+            _timer.executed();
+        }
+
+        /** Signals that the call is terminated with an exception. */
+        void failed() noexcept {
+            _probe.failed();
+            _tracer.failed();
+            _jni_counter.failed();
+            _timer.failed();
+        }
+
+    private:
+        /** Declared first to be destroyed last, after all observers have stopped. */
+        SlowCallReport _report;
+        CallProbe _probe;
+        CallTracer _tracer;
+        JniCallCounter _jni_counter;
+        CallTimer _timer;
+    };
+
+    /**
+     * Converts Java arguments into native values, and invokes a native function with the converted values.
+     * Argument conversion and function execution are separated only if call instrumentation requires so.
+     * @tparam Args Native parameter types of the function.
+     */
+    template <typename... Args, typename F>
+    decltype(auto) native_call(JNIEnv* env, CallScope& scope, F&& f, java_t<std::decay_t<Args>>... args) {
+        if constexpr (CallScope::split_phases) {
+            std::tuple<decltype(ArgType<std::decay_t<Args>>::native_value(env, args))...> native_args{
+                ArgType<std::decay_t<Args>>::native_value(env, args)...
+            };
+            scope.marshaled();
+
+            using result_type = decltype(std::apply(std::forward<F>(f), std::move(native_args)));
+            if constexpr (std::is_same_v<result_type, void>) {
+                std::apply(std::forward<F>(f), std::move(native_args));
+                scope.executed();
+            } else {
+                result_type result = std::apply(std::forward<F>(f), std::move(native_args));
+                scope.executed();
+                return result;
+            }
+        } else {
+            return f(ArgType<std::decay_t<Args>>::native_value(env, args)...);
+        }
+    }
+
+    /**
+     * Meta-information about a member variable of a native exception type that is copied into a Java exception field.
+     */
+    struct ExceptionField {
+        std::string_view name;
+        std::string_view signature;
+        /** A function that persists the value of the member variable to the Java exception object. */
+        void (*set_by_value)(JNIEnv* env, jobject obj, Field& fld, const std::exception& ex);
+        std::string_view kotlin_type;
+        /** The field identifier, resolved when the library is loaded. */
+        Field field;
+    };
+
+    /**
+     * Associates a native exception type with a Java exception class.
+     */
+    struct ExceptionMapping {
+        /** The Java class name, e.g. `com/kheiron/ktbind/ValidationError`. */
+        std::string class_name;
+        /** True if a native exception is an instance of the mapped type (or a type derived from it). */
+        bool (*matches)(const std::exception& ex);
+        /** Throws a null pointer to the mapped type, which is caught as a pointer to any of its base classes. */
+        void (*throw_pointer)();
+        /** True if the type thrown by the argument derives from the mapped type. */
+        bool (*is_base_of)(void (*throw_pointer)());
+        std::vector<ExceptionField> fields;
+        /** False if the generated Kotlin class skips capturing a stack trace when instantiated. */
+        bool stack_trace = true;
+        /** Global reference to the Java class, created in [ExceptionMappings::load] and deleted in [ExceptionMappings::unload]. */
+        jclass cls = nullptr;
+        /** The constructor of the Java class that takes a message. */
+        jmethodID init = nullptr;
+    };
+
+    /**
+     * Stores the Java exception classes that native exception types are translated into.
+     * Mappings are ordered most-specific-first, such that a derived type is checked before its base types.
+     */
+    struct ExceptionMappings {
+        inline static std::map<std::type_index, ExceptionMapping> value;
+        inline static std::vector<ExceptionMapping*> ordered;
+
+        static ExceptionMapping& add(std::type_index type, ExceptionMapping&& mapping) {
+            auto&& [it, inserted] = value.insert_or_assign(type, std::move(mapping));
+            ExceptionMapping* entry = &it->second;
+            ordered.erase(std::remove(ordered.begin(), ordered.end(), entry), ordered.end());
+
+            // insert before the first mapping of a base type
+            auto&& position = std::find_if(ordered.begin(), ordered.end(), [entry](ExceptionMapping* other) {
+                return other->is_base_of(entry->throw_pointer);
+            });
+            ordered.insert(position, entry);
+            return *entry;
+        }
+
+        /** Resolves Java classes, constructors and fields of all mappings. */
+        static void load(JNIEnv* env) {
+            for (auto&& [type, mapping] : value) {
+                LocalClassRef cls(env, mapping.class_name.data(), std::nothrow);
+                if (cls.ref() == nullptr) {
+                    throw std::invalid_argument(msg() << "Cannot find class '" << mapping.class_name << "' registered as an exception class in C++ code");
+                }
+                try {
+                    mapping.init = cls.getMethod("<init>", "(Ljava/lang/String;)V").ref();
+                    for (auto&& field : mapping.fields) {
+                        field.field = cls.getField(field.name.data(), field.signature);
+                    }
+                } catch (JavaException& ex) {
+                    throw std::invalid_argument(msg() << "Cannot find constructor or field '" << ex.what() << "' in registered exception class '" << mapping.class_name << "'");
+                }
+                mapping.cls = static_cast<jclass>(env->NewGlobalRef(cls.ref()));
+            }
+        }
+
+        /** Releases the global references to the Java classes. Invoked when the library is unloaded. */
+        static void unload(JNIEnv* env) {
+            for (auto&& [type, mapping] : value) {
+                if (mapping.cls != nullptr) {
+                    env->DeleteGlobalRef(mapping.cls);
+                    mapping.cls = nullptr;
+                }
+                mapping.init = nullptr;
+            }
+        }
+
+        /** Finds the mapping of the most specific type that a native exception is an instance of. */
+        static const ExceptionMapping* find(const std::exception& ex) {
+            if (value.empty()) {
+                return nullptr;
+            }
+            auto&& it = value.find(std::type_index(typeid(ex)));
+            if (it != value.end()) {
+                return &it->second;
+            }
+            for (ExceptionMapping* mapping : ordered) {
+                if (mapping->matches(ex)) {
+                    return mapping;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    /**
+     * Throws an instance of the Java exception class registered for the type of a native exception.
+     * @return False if no Java exception class is registered for the exception type.
+     */
+    inline bool throw_mapped_exception(JNIEnv* env, const std::exception& ex) {
+        const ExceptionMapping* mapping = ExceptionMappings::find(ex);
+        if (mapping == nullptr || mapping->cls == nullptr) {
+            return false;
+        }
+
+        LocalObjectRef message(env, env->NewStringUTF(ex.what()));
+        LocalObjectRef obj(env, env->NewObject(mapping->cls, mapping->init, message.ref()));
+        if (obj.ref() == nullptr) {
+            return true;  // the exception raised by the constructor takes the place of the mapped exception
+        }
+        try {
+            for (auto&& field : mapping->fields) {
+                Field fld = field.field;
+                field.set_by_value(env, obj.ref(), fld, ex);
+            }
+        } catch (JavaException& field_ex) {
+            env->Throw(field_ex.innerException());
+            return true;
+        } catch (std::exception&) {
+            // fields are optional details, throw the exception without them
+        }
+        env->Throw(static_cast<jthrowable>(obj.ref()));
+        return true;
+    }
+
+    /**
+     * Registers a Java exception class for a native exception type, with optional fields copied from the native
+     * exception. The Java class must have a constructor that takes a message.
+     */
+    template <typename E>
+    struct exception_class {
+        static_assert(std::is_base_of_v<std::exception, E>, "Exception types are expected to derive from std::exception.");
+
+        /**
+         * @param class_name The Java class name, e.g. `com.kheiron.ktbind.ValidationError`.
+         */
+        exception_class(std::string_view class_name) : _mapping(ExceptionMappings::add(typeid(E), {
+            to_class_name(class_name),
+            [](const std::exception& ex) { return dynamic_cast<const E*>(&ex) != nullptr; },
+            []() { throw static_cast<const E*>(nullptr); },
+            [](void (*throw_pointer)()) {
+                try {
+                    throw_pointer();
+                } catch (const E*) {
+                    return true;
+                } catch (...) {
+                    return false;
+                }
+                return false;
+            },
+            {},
+            true,
+            nullptr,
+            nullptr
+        })) {}
+
+        exception_class(const exception_class&) = delete;
+        exception_class(exception_class&&) = delete;
+
+        /**
+         * Copies a member variable of the native exception into a field of the Java exception object.
+         */
+        template <auto member>
+        exception_class& field(const char* name) {
+            static_assert(std::is_member_object_pointer_v<decltype(member)>, "The non-type template argument is expected to be of a member variable pointer type.");
+            using member_type = std::remove_cv_t<typename FieldType<decltype(member)>::type>;
+
+            _mapping.fields.push_back({
+                name,
+                ArgType<member_type>::type_sig,
+                [](JNIEnv* env, jobject obj, Field& fld, const std::exception& ex) {
+                    ArgType<member_type>::java_field_value(env, obj, fld, static_cast<const E&>(ex).*member);
+                },
+                ArgType<member_type>::kotlin_type,
+                Field()
+            });
+            return *this;
+        }
+
+        /**
+         * Declares that the Java exception class captures no stack trace, which is expensive for exceptions raised
+         * frequently. The generated Kotlin class passes `writableStackTrace = false` to the `Exception` constructor.
+         */
+        exception_class& without_stack_trace() {
+            _mapping.stack_trace = false;
+            return *this;
+        }
+
+    private:
+        static std::string to_class_name(std::string_view class_name) {
+            std::string name(class_name);
+            std::replace(name.begin(), name.end(), '.', '/');
+            return name;
+        }
+
+        ExceptionMapping& _mapping;
+    };
+
+    /**
+     * Registers a Java exception class, e.g. `com.kheiron.ktbind.ValidationError`, to throw in place of
+     * `java.lang.Exception` when a native function raises an exception of type `E` or a type derived from `E`.
+     */
+    template <typename E>
+    exception_class<E> register_exception(std::string_view class_name) {
+        return exception_class<E>(class_name);
+    }
+
+    /**
+     * Converts a native exception into a Java exception.
+     */
+    inline void exception_handler(JNIEnv* env, std::exception& ex) {
+        TraceSpan span(TraceCategory::exception, std::string_view(), "exception_handler");
+
+        // ensure that no unhandled Java exception is waiting to be thrown
+        if (!env->ExceptionCheck()) {
+            if (!throw_mapped_exception(env, ex)) {
+                env->ThrowNew(ExceptionClasses::get().exception, ex.what());
+            }
+        }
+    }
+
+    /**
+     * Converts the exception being handled into a Java exception.
+     * Called from a `catch (...)` block, such that adapters share a single copy of the exception translation code.
+     * Exceptions that do not derive from `std::exception` are rethrown.
+     */
+    KTBIND_COLD inline void translate_exception(JNIEnv* env) {
+        try {
+            throw;
+        } catch (JavaException& ex) {
+            env->Throw(ex.innerException());
+        } catch (std::exception& ex) {
+            exception_handler(env, ex);
+        }
+    }
+
+    /**
+     * Caches the field identifier of `nativePointer` in the Java class that corresponds to a native class.
+     * The identifier is looked up on first use, and remains valid as long as the class is loaded.
+     */
+    template <typename T>
+    struct NativePointer {
+        /**
+         * Reads the native pointer stored in a Java object.
+         * Returns null if the object has been disposed of, or with a pending Java exception if the field is not found.
+         */
+        static T* get(JNIEnv* env, jobject obj) {
+            jfieldID id = _field.load(std::memory_order_relaxed);
+            if (id == nullptr) {
+                id = lookup(env, obj);
+                if (id == nullptr) {
+                    return nullptr;
+                }
+            }
+            return reinterpret_cast<T*>(env->GetLongField(obj, id));
+        }
+
+    private:
+        static jfieldID lookup(JNIEnv* env, jobject obj) {
+            jclass cls = env->GetObjectClass(obj);
+            jfieldID id = env->GetFieldID(cls, "nativePointer", ArgType<T*>::type_sig.data());
+            env->DeleteLocalRef(cls);
+            _field.store(id, std::memory_order_relaxed);
+            return id;
+        }
+
+        inline static std::atomic<jfieldID> _field{nullptr};
+    };
+
+    /**
+     * Raises a Java exception when a member function is called on an object that has already been disposed of.
+     * Does not replace an exception that is already pending.
+     */
+    template <typename T>
+    void object_disposed(JNIEnv* env) noexcept {
+        if (!env->ExceptionCheck()) {
+            try {
+                std::string message = msg() << "Object " << ArgType<T>::class_name << " has already been disposed of.";
+                env->ThrowNew(ExceptionClasses::get().exception, message.c_str());
+            } catch (std::exception&) {
+                env->ThrowNew(ExceptionClasses::get().exception, "Object has already been disposed of.");
+            }
+        }
+    }
+
+    /**
+     * Wraps a native function pointer into a function pointer callable from Java.
+     * Adapts a function with the signature R(*func)(Args...).
+     * @tparam T The class the function is bound to, such that bindings in different classes have separate call sites.
+     * @tparam func The callable function pointer.
+     * @return A type-safe function pointer to pass to Java's [RegisterNatives] function.
+     */
+    template <typename T, auto func, typename... Args>
+    struct Adapter {
+        using result_type = decltype(func(std::declval<Args>()...));
+
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static java_t<result_type> invoke(JNIEnv* env, jclass obj, java_t<std::decay_t<Args>>... args) {
+            CallScope scope(env, site);
+            try {
+                if constexpr (!std::is_same_v<result_type, void>) {
+                    auto&& result = native_call<Args...>(env, scope, func, args...);
+                    return ArgType<result_type>::java_value(env, std::move(result));
+                } else {
+                    native_call<Args...>(env, scope, func, args...);
+                }
+            } catch (...) {
+                scope.failed();
+                translate_exception(env);
+                if constexpr (!std::is_same_v<result_type, void>) {
+                    return java_t<result_type>();
+                }
+            }
+        }
+    };
+
+    /**
+     * Wraps a native member function pointer into a function pointer callable from Java.
+     * Adapts a function with the signature R(T::*func)(Args...).
+     * @tparam func The callable member function pointer.
+     * @return A type-safe function pointer to pass to Java's [RegisterNatives] function.
+     */
+    template <typename T, auto func, typename... Args>
+    struct MemberAdapter {
+        using result_type = decltype((std::declval<T>().*func)(std::declval<Args>()...));
+
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static java_t<result_type> invoke(JNIEnv* env, jobject obj, java_t<std::decay_t<Args>>... args) {
+            CallScope scope(env, site);
+            try {
+                // look up native pointer with cached field identifier
+                T* ptr = NativePointer<T>::get(env, obj);
+
+                // invoke native function
+                if (!ptr) {
+                    if (env->ExceptionCheck()) {
+                        throw JavaException(env);  // field not found
+                    }
+                    throw std::logic_error(msg() << "Object " << ArgType<T>::class_name << " has already been disposed of.");
+                }
+                auto&& member_func = [ptr](auto&&... native_args) -> decltype(auto) {
+                    return (ptr->*func)(std::forward<decltype(native_args)>(native_args)...);
+                };
+                if constexpr (!std::is_same_v<result_type, void>) {
+                    auto&& result = native_call<Args...>(env, scope, member_func, args...);
+                    return ArgType<result_type>::java_value(env, std::move(result));
+                } else {
+                    native_call<Args...>(env, scope, member_func, args...);
+                }
+    
+            } catch (...) {
+                scope.failed();
+                translate_exception(env);
+                if constexpr (!std::is_same_v<result_type, void>) {
+                    return java_t<result_type>();
+                }
+            }
+        }
+    };
+
+    /**
+     * Wraps a `noexcept` native function with fundamental parameter and return types into a function pointer callable
+     * from Java. Argument conversions are casts, and the function cannot throw, so the adapter has no exception handlers.
+     * @tparam T The class the function is bound to.
+     * @tparam func The callable function pointer.
+     */
+    template <typename T, auto func, typename... Args>
+    struct FastAdapter {
+        static_assert(noexcept(func(std::declval<Args>()...)), "Fast adapters require a noexcept function.");
+
+        using result_type = decltype(func(std::declval<Args>()...));
+
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static java_t<result_type> invoke(JNIEnv* env, jclass, java_t<std::decay_t<Args>>... args) noexcept {
+            CallScope scope(env, site);
+            if constexpr (!std::is_same_v<result_type, void>) {
+                return ArgType<result_type>::java_value(env, native_call<Args...>(env, scope, func, args...));
+            } else {
+                native_call<Args...>(env, scope, func, args...);
+            }
+        }
+    };
+
+    /**
+     * Wraps a `noexcept` native member function with fundamental parameter and return types into a function pointer
+     * callable from Java. The only failure is a disposed object, which raises a Java exception without a C++ exception.
+     * @tparam func The callable member function pointer.
+     */
+    template <typename T, auto func, typename... Args>
+    struct FastMemberAdapter {
+        static_assert(noexcept((std::declval<T>().*func)(std::declval<Args>()...)), "Fast adapters require a noexcept member function.");
+
+        using result_type = decltype((std::declval<T>().*func)(std::declval<Args>()...));
+
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static java_t<result_type> invoke(JNIEnv* env, jobject obj, java_t<std::decay_t<Args>>... args) noexcept {
+            CallScope scope(env, site);
+            T* ptr = NativePointer<T>::get(env, obj);
+            if (!ptr) {
+                scope.failed();
+                object_disposed<T>(env);
+                if constexpr (!std::is_same_v<result_type, void>) {
+                    return java_t<result_type>();
+                } else {
+                    return;
+                }
+            }
+
+            auto&& member_func = [ptr](auto&&... native_args) noexcept -> decltype(auto) {
+                return (ptr->*func)(std::forward<decltype(native_args)>(native_args)...);
+            };
+            if constexpr (!std::is_same_v<result_type, void>) {
+                return ArgType<result_type>::java_value(env, native_call<Args...>(env, scope, member_func, args...));
+            } else {
+                native_call<Args...>(env, scope, member_func, args...);
+            }
+        }
+    };
+
+    /**
+     * Selects the adapter type for a native function pointer or a member function pointer.
+     * Fast adapters are `noexcept`, and are selected only if no call instrumentation is compiled in.
+     */
+    template <typename T, auto func, typename... Args>
+    using adapter_t = std::conditional_t<
+        std::is_member_function_pointer_v<decltype(func)>,
+        std::conditional_t<is_fast_function<decltype(func)>::value && CallScope::is_null, FastMemberAdapter<T, func, Args...>, MemberAdapter<T, func, Args...>>,
+        std::conditional_t<is_fast_function<decltype(func)>::value && CallScope::is_null, FastAdapter<T, func, Args...>, Adapter<T, func, Args...>>
+    >;
+
+    /**
+     * Wraps a native function pointer or a member function pointer into a function pointer callable from Java.
+     * @tparam func The callable function or member function pointer.
+     * @return A type-erased function pointer to pass to Java's [RegisterNatives] function.
+     */
+    template <typename T, auto func, typename... Args>
+    constexpr void* callable(types<Args...>) {
+        auto&& f = adapter_t<T, func, Args...>::invoke;
+        return reinterpret_cast<void*>(f);
+    }
+
+    /**
+     * Returns the meta-information object associated with the adapter of a function binding.
+     */
+    template <typename T, auto func, typename... Args>
+    CallSite* callable_site(types<Args...>) {
+        return &adapter_t<T, func, Args...>::site;
+    }
+
+    /**
+     * A binding option that caches the results of a pure function, keyed on its arguments.
+     * Bind a function with `.function<f, java::memoize<N>>("name")` to keep the results of the last N distinct calls.
+     * @tparam Capacity The maximum number of results kept in the cache.
+     */
+    template <std::size_t Capacity>
+    struct memoize {
+        static_assert(Capacity > 0, "The capacity of a memoization cache must be positive.");
+        constexpr static std::size_t capacity = Capacity;
+    };
+
+    template <typename Policy>
+    struct is_memoize : std::false_type {};
+
+    template <std::size_t Capacity>
+    struct is_memoize<memoize<Capacity>> : std::true_type {};
+
+    /**
+     * A binding option that returns the same Java object for the result of a member function while the version of
+     * the native object is unchanged.
+     * Bind a function with `.function<&T::f, java::versioned<&T::version>>("name")`, where `version` is a `const`
+     * member function or a member variable of integral type that changes whenever the result would change.
+     * @tparam version The member function or member variable that holds the version of the native object.
+     */
+    template <auto version>
+    struct versioned {};
+
+    template <typename Policy>
+    struct is_versioned : std::false_type {};
+
+    template <auto version>
+    struct is_versioned<versioned<version>> : std::true_type {};
+
+    /**
+     * True for results that Java code cannot modify, such that the same Java object can be returned on every call.
+     */
+    template <typename T>
+    struct is_immutable_java_type : std::is_same<T, std::string> {};
+
+    /**
+     * Computes the hash of a tuple of native argument values.
+     */
+    template <typename... Ts>
+    std::size_t hash_arguments(const std::tuple<Ts...>& values) {
+        std::size_t seed = 0;
+        std::apply([&seed](const auto&... value) {
+            ((seed ^= std::hash<std::decay_t<decltype(value)>>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2)), ...);
+        }, values);
+        return seed;
+    }
+
+    /**
+     * A least-recently-used cache of function results.
+     * Caches of fewer than 64 entries keep a single list. Larger caches are split into shards that are locked
+     * independently, and recency is tracked per shard: a full shard evicts its own least recently used entry, even if
+     * another shard holds an entry used less recently. The capacities of the shards add up to `Capacity`.
+     * Results that Java cannot modify are stored along with a global reference to their Java object, which saves
+     * converting the result again when the cache is hit.
+     */
+    template <typename Key, typename Value, std::size_t Capacity>
+    struct MemoizationCache {
+        constexpr static std::size_t shard_count = Capacity < 64 ? 1 : 16;
+
+        /** The number of entries a shard holds; the first `Capacity % shard_count` shards hold one extra entry. */
+        constexpr static std::size_t shard_capacity(std::size_t index) noexcept {
+            return Capacity / shard_count + (index < Capacity % shard_count ? 1 : 0);
+        }
+        constexpr static bool keeps_java_object = is_immutable_java_type<Value>::value;
+
+        struct Entry {
+            Key key;
+            Value value;
+            /** A global reference to the Java object of the result, or null. */
+            jobject java_object;
+        };
+
+        /**
+         * Looks up the result of a call, and moves the entry to the front of its shard.
+         * @return A new local reference (or primitive value) to return to Java, if the cache has the result.
+         */
+        std::optional<java_t<Value>> find(JNIEnv* env, const Key& key, std::size_t hash) {
+            Shard& shard = _shards[hash % shard_count];
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(key);
+            if (it == shard.index.end()) {
+                return std::nullopt;
+            }
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            if constexpr (keeps_java_object) {
+                return static_cast<java_t<Value>>(env->NewLocalRef(it->second->java_object));
+            } else {
+                Value value = it->second->value;
+                lock.unlock();
+                return ArgType<Value>::java_value(env, value);
+            }
+        }
+
+        /**
+         * Adds the result of a call, and evicts the least recently used entry of the shard if the shard is full.
+         * @param java_object The Java object returned for the result, which is retained if Java cannot modify it.
+         */
+        void insert(JNIEnv* env, Key&& key, std::size_t hash, const Value& value, java_t<Value> java_object) {
+            jobject global_ref = nullptr;
+            if constexpr (keeps_java_object) {
+                if (java_object == nullptr || (global_ref = env->NewGlobalRef(java_object)) == nullptr) {
+                    return;
+                }
+            }
+
+            std::size_t index = hash % shard_count;
+            Shard& shard = _shards[index];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.index.find(key) != shard.index.end()) {
+                // another thread has computed the same result in the meantime
+                if (global_ref != nullptr) {
+                    env->DeleteGlobalRef(global_ref);
+                }
+                return;
+            }
+            if (shard.entries.size() >= shard_capacity(index)) {
+                Entry& last = shard.entries.back();
+                if (last.java_object != nullptr) {
+                    env->DeleteGlobalRef(last.java_object);
+                }
+                shard.index.erase(last.key);
+                shard.entries.pop_back();
+            }
+            shard.entries.push_front({ std::move(key), value, global_ref });
+            shard.index.emplace(std::cref(shard.entries.front().key), shard.entries.begin());
+        }
+
+        /** Removes all entries, and releases the Java objects retained for them. */
+        void clear(JNIEnv* env) {
+            for (auto&& shard : _shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                for (auto&& entry : shard.entries) {
+                    if (entry.java_object != nullptr) {
+                        env->DeleteGlobalRef(entry.java_object);
+                    }
+                }
+                shard.index.clear();
+                shard.entries.clear();
+            }
+        }
+
+    private:
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const {
+                return hash_arguments(key);
+            }
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            /** Entries ordered from the most recently to the least recently used. */
+            std::list<Entry> entries;
+            std::unordered_map<std::reference_wrapper<const Key>, typename std::list<Entry>::iterator, KeyHash, std::equal_to<Key>> index;
+        };
+
+        std::array<Shard, shard_count> _shards;
+    };
+
+    /**
+     * The caches of memoized and versioned bindings, which are cleared when the library is unloaded.
+     */
+    struct ResultCaches {
+        inline static std::vector<void (*)(JNIEnv*)> value;
+
+        static void add(void (*clear)(JNIEnv*)) {
+            if (std::find(value.begin(), value.end(), clear) == value.end()) {
+                value.push_back(clear);
+            }
+        }
+
+        /** Releases the Java objects retained by all caches. Invoked when the library is unloaded. */
+        static void unload(JNIEnv* env) {
+            for (auto&& clear : value) {
+                clear(env);
+            }
+        }
+    };
+
+    /**
+     * Wraps a pure native function into a function pointer callable from Java, which returns cached results when
+     * the function is called again with equal arguments.
+     * Arguments are converted to native values, which form the cache key. The native function is invoked only on a
+     * cache miss, and exceptions are not cached.
+     * @tparam T The class the function is bound to.
+     * @tparam func The callable function pointer.
+     * @tparam Capacity The maximum number of results kept in the cache.
+     */
+    template <typename T, auto func, std::size_t Capacity, typename... Args>
+    struct MemoizingAdapter {
+        static_assert(((!std::is_reference_v<Args> || (std::is_lvalue_reference_v<Args> && std::is_const_v<std::remove_reference_t<Args>>)) && ...),
+            "Memoized functions are expected to take parameters by value or by const reference.");
+
+        using result_type = decltype(func(std::declval<Args>()...));
+        using value_type = std::decay_t<result_type>;
+        using key_type = std::tuple<std::decay_t<Args>...>;
+
+        static_assert(!std::is_void_v<result_type>, "Memoized functions are expected to return a value.");
+
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static java_t<value_type> invoke(JNIEnv* env, jclass, java_t<std::decay_t<Args>>... args) {
+            CallScope scope(env, site);
+            try {
+                key_type key{ ArgType<std::decay_t<Args>>::native_value(env, args)... };
+                scope.marshaled();
+
+                std::size_t hash = hash_arguments(key);
+                if (auto cached = _cache.find(env, key, hash)) {
+                    scope.executed();
+                    return *cached;
+                }
+
+                value_type result = std::apply(func, std::as_const(key));
+                scope.executed();
+                java_t<value_type> java_result = ArgType<value_type>::java_value(env, result);
+                _cache.insert(env, std::move(key), hash, result, java_result);
+                return java_result;
+            } catch (...) {
+                scope.failed();
+                translate_exception(env);
+                return java_t<value_type>();
+            }
+        }
+
+        static void clear(JNIEnv* env) {
+            _cache.clear(env);
+        }
+
+    private:
+        inline static MemoizationCache<key_type, value_type, Capacity> _cache;
+    };
+
+    /**
+     * Reads the version of a native object from a member function or member variable.
+     */
+    template <auto version, typename T>
+    std::uint64_t object_version(const T& obj) {
+        if constexpr (std::is_member_function_pointer_v<decltype(version)>) {
+            static_assert(std::is_integral_v<decltype((obj.*version)())>, "The version of a native object is expected to be of an integral type.");
+            return static_cast<std::uint64_t>((obj.*version)());
+        } else {
+            static_assert(std::is_member_object_pointer_v<decltype(version)>, "The version is expected to be a member function or member variable pointer.");
+            return static_cast<std::uint64_t>(obj.*version);
+        }
+    }
+
+    /**
+     * Keeps the Java objects last returned by versioned bindings of a native class, with the version of the native
+     * object at the time the result was produced.
+     * Entries hold global references, and are released when the native object is disposed of, or when the library is
+     * unloaded.
+     */
+    template <typename T>
+    struct VersionedResults {
+        /**
+         * Returns a new local reference to the Java object last returned by a binding for a native object, or null if
+         * no object has been returned for the given version.
+         */
+        static jobject find(JNIEnv* env, const T* ptr, const CallSite* site, std::uint64_t version) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find({ ptr, site });
+            if (it == _entries.end() || it->second.version != version) {
+                return nullptr;
+            }
+            return env->NewLocalRef(it->second.java_object);
+        }
+
+        /**
+         * Replaces the Java object retained for a binding and a native object.
+         */
+        static void store(JNIEnv* env, const T* ptr, const CallSite* site, std::uint64_t version, jobject java_object) {
+            jobject global_ref = env->NewGlobalRef(java_object);
+            if (global_ref == nullptr) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _used.store(true, std::memory_order_relaxed);
+            auto [it, inserted] = _entries.try_emplace({ ptr, site }, Entry{ version, global_ref });
+            if (!inserted) {
+                env->DeleteGlobalRef(it->second.java_object);
+                it->second = { version, global_ref };
+            }
+        }
+
+        /**
+         * Releases the Java objects retained for a native object that is about to be deleted, such that an object
+         * allocated later at the same address does not see them.
+         */
+        static void release(JNIEnv* env, const T* ptr) {
+            if (!_used.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto it = _entries.lower_bound({ ptr, nullptr }); it != _entries.end() && it->first.first == ptr; it = _entries.erase(it)) {
+                env->DeleteGlobalRef(it->second.java_object);
+            }
+        }
+
+        /** Releases the Java objects retained for all native objects, including those that are still alive. */
+        static void clear(JNIEnv* env) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto&& [key, entry] : _entries) {
+                env->DeleteGlobalRef(entry.java_object);
+            }
+            _entries.clear();
+        }
+
+    private:
+        struct Entry {
+            std::uint64_t version;
+            jobject java_object;
+        };
+
+        inline static std::mutex _mutex;
+        inline static std::map<std::pair<const T*, const CallSite*>, Entry> _entries;
+        /** True once a result has been stored, which saves locking when objects of other classes are disposed of. */
+        inline static std::atomic<bool> _used{false};
+    };
+
+    /**
+     * Wraps a native member function without parameters into a function pointer callable from Java, which returns
+     * the Java object of the previous call while the version of the native object is unchanged.
+     * The version is read before the function is invoked, such that a result is never associated with a version
+     * that is newer than the state it was computed from.
+     * @tparam func The callable member function pointer.
+     * @tparam version The member function or member variable that holds the version of the native object.
+     */
+    template <typename T, auto func, auto version, typename... Args>
+    struct VersionedMemberAdapter {
+        static_assert(sizeof...(Args) == 0, "Versioned functions are expected to take no parameters.");
+
+        using result_type = decltype((std::declval<T>().*func)());
+        using value_type = std::decay_t<result_type>;
+
+        static_assert(std::is_convertible_v<java_t<value_type>, jobject>, "Versioned functions are expected to return a type that maps to a Java object.");
+
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static java_t<value_type> invoke(JNIEnv* env, jobject obj) {
+            CallScope scope(env, site);
+            try {
+                T* ptr = NativePointer<T>::get(env, obj);
+                if (!ptr) {
+                    if (env->ExceptionCheck()) {
+                        throw JavaException(env);  // field not found
+                    }
+                    throw std::logic_error(msg() << "Object " << ArgType<T>::class_name << " has already been disposed of.");
+                }
+
+                std::uint64_t current = object_version<version>(*ptr);
+                if (jobject cached = VersionedResults<T>::find(env, ptr, &site, current)) {
+                    scope.marshaled();
+                    scope.executed();
+                    return static_cast<java_t<value_type>>(cached);
+                }
+
+                auto&& member_func = [ptr]() -> decltype(auto) {
+                    return (ptr->*func)();
+                };
+                auto&& result = native_call<>(env, scope, member_func);
+                java_t<value_type> java_result = ArgType<value_type>::java_value(env, std::move(result));
+                if (java_result != nullptr) {
+                    VersionedResults<T>::store(env, ptr, &site, current, java_result);
+                }
+                return java_result;
+            } catch (...) {
+                scope.failed();
+                translate_exception(env);
+                return java_t<value_type>();
+            }
+        }
+    };
+
+    /**
+     * Selects the adapter type for a function bound with a binding option.
+     */
+    template <typename T, auto func, typename Policy, typename... Args>
+    struct PolicyAdapter;
+
+    template <typename T, auto func, std::size_t Capacity, typename... Args>
+    struct PolicyAdapter<T, func, memoize<Capacity>, Args...> {
+        using type = MemoizingAdapter<T, func, Capacity, Args...>;
+    };
+
+    template <typename T, auto func, auto version, typename... Args>
+    struct PolicyAdapter<T, func, versioned<version>, Args...> {
+        using type = VersionedMemberAdapter<T, func, version, Args...>;
+    };
+
+    template <typename T, auto func, typename Policy, typename... Args>
+    constexpr void* policy_callable(types<Args...>) {
+        return reinterpret_cast<void*>(PolicyAdapter<T, func, Policy, Args...>::type::invoke);
+    }
+
+    template <typename T, auto func, typename Policy, typename... Args>
+    CallSite* policy_callable_site(types<Args...>) {
+        return &PolicyAdapter<T, func, Policy, Args...>::type::site;
+    }
+
+    template <typename T, auto func, typename Policy, typename... Args>
+    constexpr void (*memoization_clear(types<Args...>))(JNIEnv*) {
+        return PolicyAdapter<T, func, Policy, Args...>::type::clear;
+    }
+
+    /**
+     * Adapts a constructor function to be invoked from Java on object instantiation with a class method.
+     */
+    template <typename T, typename... Args>
+    struct CreateObjectAdapter {
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static jobject invoke(JNIEnv* env, jclass cls, java_t<Args>... args) {
+            CallScope scope(env, site);
+            try {
+                // instantiate native object
+                T* ptr = native_call<Args...>(env, scope, [](auto&&... native_args) {
+                    return new T(std::forward<decltype(native_args)>(native_args)...);
+                }, args...);
+                LeakTracker::object_created(env, ArgType<T>::class_name, ptr);
+
+                // instantiate Java object by skipping constructor
+                LocalClassRef objClass(env, cls);
+                jobject obj = env->AllocObject(objClass.ref());
+                if (obj == nullptr) {
+                    throw JavaException(env);
+                }
+                MarshalingVolume::count_objects(MarshalDirection::to_java);
+
+                // store native pointer in Java object field
+                Field field = objClass.getField("nativePointer", ArgType<T*>::type_sig.data());
+                ArgType<T*>::java_field_value(env, obj, field, ptr);
+        
+                return obj;
+            } catch (...) {
+                scope.failed();
+                translate_exception(env);
+                return nullptr;
+            }
+        }
+    };
+
+    /**
+     * Adapts a destructor function to be invoked from Java when the object is being disposed of.
+     * This function is bound to the method close() inherited from the interface AutoCloseable.
+     */
+    template <typename T>
+    struct DestroyObjectAdapter {
+        /** Meta-information about the binding the adapter is registered with. */
+        inline static CallSite site;
+
+        static void invoke(JNIEnv* env, jobject obj) {
+            CallScope scope(env, site);
+            try {
+                // look up field that stores native pointer
+                LocalClassRef cls(env, obj);
+                Field field = cls.getField("nativePointer", ArgType<T*>::type_sig.data());
+                T* ptr = ArgType<T*>::native_field_value(env, obj, field);
+                scope.marshaled();
+                
+                // release native object
+                if (ptr != nullptr) {
+                    LeakTracker::object_destroyed(env, ArgType<T>::class_name, ptr);
+                    VersionedResults<T>::release(env, ptr);
+                }
+                delete ptr;
+                scope.executed();
 
                 // prevent accidental duplicate delete
                 ArgType<T*>::java_field_value(env, obj, field, nullptr);
-            } catch (JavaException& ex) {
-                env->Throw(ex.innerException());
-            } catch (std::exception& ex) {
-                exception_handler(env, ex);
+            } catch (...) {
+                scope.failed();
+                translate_exception(env);
+            }
+        }
+    };
+
+    template <typename T, typename... Args>
+    constexpr void* object_initialization(types<Args...>) {
+        return reinterpret_cast<void*>(CreateObjectAdapter<T, Args...>::invoke);
+    }
+
+    template <typename T, typename... Args>
+    CallSite* object_initialization_site(types<Args...>) {
+        return &CreateObjectAdapter<T, Args...>::site;
+    }
+
+    template <typename T>
+    constexpr void* object_termination() {
+        return reinterpret_cast<void*>(DestroyObjectAdapter<T>::invoke);
+    }
+
+    struct FunctionBinding {
+        std::string_view name;
+        std::string_view signature;
+        bool is_member;
+        void* function_entry_point;
+        std::string_view friendly_signature;
+        CallSite* site;
+    };
+
+    /**
+     * Builds the entry passed to [RegisterNatives] for a function binding.
+     */
+    inline JNINativeMethod native_method(const FunctionBinding& binding) {
+        return {
+            const_cast<char*>(binding.name.data()),
+            const_cast<char*>(binding.signature.data()),
+            binding.function_entry_point
+        };
+    }
+
+    /**
+     * The function bindings of a single Java class, and the method table passed to [RegisterNatives].
+     * The method table is built as bindings are declared, rather than copied from the bindings after the initializer
+     * has run. Both are populated inside [JNI_OnLoad].
+     */
+    struct BindingList {
+        std::vector<FunctionBinding>& bindings;
+        std::vector<JNINativeMethod>& natives;
+
+        void add(const FunctionBinding& binding) {
+            bindings.push_back(binding);
+            natives.push_back(native_method(binding));
+        }
+    };
+
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+    /**
+     * A native function that Kotlin calls through a method handle of the Foreign Function & Memory API.
+     */
+    struct DowncallBinding {
+        std::string_view name;
+        std::string_view signature;
+        void* address;
+        std::string_view friendly_signature;
+    };
+
+    /**
+     * Stores the functions of native classes bound for downcalls, and exposes their addresses to Kotlin.
+     */
+    struct DowncallBindings {
+        inline static std::map< std::string_view, std::vector<DowncallBinding> > value;
+
+        /** Lookup keys and addresses, e.g. `com/kheiron/ktbind/Sample.add(II)I`, built when the library is loaded. */
+        inline static std::vector< std::pair<std::string, void*> > exports;
+
+        static std::string key(std::string_view class_name, const DowncallBinding& binding) {
+            return std::string(class_name) + "." + std::string(binding.name) + std::string(binding.signature);
+        }
+
+        static void load() {
+            exports.clear();
+            for (auto&& [class_name, bindings] : value) {
+                for (auto&& binding : bindings) {
+                    exports.emplace_back(key(class_name, binding), binding.address);
+                }
+            }
+        }
+    };
+#endif
+
+    /**
+     * Stores the functions of native classes.
+     */
+    struct FunctionBindings {
+        inline static std::map< std::string_view, std::vector<FunctionBinding> > value;
+        inline static std::map< std::string_view, std::vector<JNINativeMethod> > natives;
+
+        /** The bindings of a class; references remain valid as bindings of other classes are added. */
+        static BindingList of(std::string_view class_name) {
+            return { value[class_name], natives[class_name] };
+        }
+    };
+
+    /**
+     * Stores the functions of Kotlin singleton objects implemented in native code.
+     */
+    struct ObjectBindings {
+        inline static std::map< std::string_view, std::vector<FunctionBinding> > value;
+        inline static std::map< std::string_view, std::vector<JNINativeMethod> > natives;
+        /** Objects of the interoperability framework, whose Kotlin declarations are shipped in `kotlin/src/main`. */
+        inline static std::set<std::string_view> builtins;
+
+        static BindingList of(std::string_view class_name) {
+            return { value[class_name], natives[class_name] };
+        }
+
+        static bool is_builtin(std::string_view class_name) {
+            return builtins.find(class_name) != builtins.end();
+        }
+    };
+
+    /**
+     * Meta-information about a member variable of a native class that Kotlin reads and writes directly in native memory.
+     */
+    struct PropertyBinding {
+        /** The property name as it appears in the Kotlin class. */
+        std::string_view name;
+        /** The Java type signature of the property, a primitive type. */
+        std::string_view signature;
+        /** The offset of the member variable from the address stored in `nativePointer`. */
+        std::size_t offset;
+        /** False if the member variable is `const`, which makes the property read-only. */
+        bool is_mutable;
+        /** The Kotlin type of the property, e.g. `Double`. */
+        std::string_view kotlin_type;
+    };
+
+    /**
+     * Stores the properties of native classes.
+     */
+    struct PropertyBindings {
+        inline static std::map< std::string_view, std::vector<PropertyBinding> > value;
+    };
+
+    /**
+     * Represents a native class in Java.
+     * The Java object holds an opaque pointer to the native object. The lifecycle of the object is governed by Java.
+     */
+    template <typename T>
+    struct native_class {
+        native_class() : _bindings(FunctionBindings::of(ArgType<T>::class_name)) {
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+            LeakTracker::counters<T>(ArgType<T>::class_name);  // report classes with no objects allocated yet
+#endif
+            _bindings.add({
+                "close",
+                Function<void()>::signature,
+                true,
+                object_termination<T>(),
+                Function<void()>::kotlin_type,
+                &DestroyObjectAdapter<T>::site
+            });
+        }
+
+        native_class(const native_class&) = delete;
+        native_class(native_class&&) = delete;
+
+        template <typename F>
+        native_class& constructor(std::string_view name) {
+            static_assert(std::is_function_v<F>, "Use a function signature such as Sample(int, std::string) to identify a constructor.");
+
+            _bindings.add({
+                name,
+                Function<F>::signature,
+                false,
+                object_initialization<T>(args_t<F>{}),
+                Function<F>::kotlin_type,
+                object_initialization_site<T>(args_t<F>{})
+            });
+            return *this;
+        }
+
+        template <auto func>
+        native_class& function(const char* name) {
+            using func_type = decltype(func);
+
+            // check if signature is R(*func)(Args...)
+            constexpr bool is_free = is_free_function_pointer<func_type>::value;
+            // check if signature is R(T::*func)(Args...)
+            constexpr bool is_member = std::is_member_function_pointer<func_type>::value;
+
+            static_assert(is_free || is_member, "The non-type template argument is expected to be of a free function or a compatible member function pointer type.");
+
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+            // call functions that need no type conversion through the Foreign Function & Memory API, unless calls are
+            // instrumented, which downcalls would bypass
+            if constexpr (is_free_function_pointer<func_type>::value && is_fast_function<func_type>::value && CallScope::is_null) {
+                DowncallBindings::value[ArgType<T>::class_name].push_back({
+                    name,
+                    Function<func_type>::signature,
+                    reinterpret_cast<void*>(func),
+                    Function<func_type>::kotlin_type
+                });
+                return *this;
+            }
+#endif
+
+            _bindings.add({
+                name,
+                Function<func_type>::signature,
+                is_member,
+                callable<T, func>(args_t<func_type>{}),
+                Function<func_type>::kotlin_type,
+                callable_site<T, func>(args_t<func_type>{})
+            });
+            return *this;
+        }
+
+        /**
+         * Binds a function with a binding option that lets calls return a previous result:
+         * `java::memoize<N>` caches results of a pure free function keyed on arguments, and `java::versioned<V>`
+         * returns the previous Java object of a member function while the version of the native object is unchanged.
+         */
+        template <auto func, typename Policy>
+        native_class& function(const char* name) {
+            using func_type = decltype(func);
+            constexpr bool is_member = std::is_member_function_pointer_v<func_type>;
+            static_assert(is_memoize<Policy>::value || is_versioned<Policy>::value, "Unrecognized binding option; use java::memoize<N> or java::versioned<V>.");
+            static_assert(!is_memoize<Policy>::value || is_free_function_pointer<func_type>::value, "Only free functions can be memoized, as member functions depend on the state of the object.");
+            static_assert(!is_versioned<Policy>::value || is_member, "Only member functions can be versioned, as the version is read from the native object.");
+
+            _bindings.add({
+                name,
+                Function<func_type>::signature,
+                is_member,
+                policy_callable<T, func, Policy>(args_t<func_type>{}),
+                Function<func_type>::kotlin_type,
+                policy_callable_site<T, func, Policy>(args_t<func_type>{})
+            });
+            if constexpr (is_memoize<Policy>::value) {
+                ResultCaches::add(memoization_clear<T, func, Policy>(args_t<func_type>{}));
+            } else {
+                ResultCaches::add(&VersionedResults<T>::clear);
+            }
+            return *this;
+        }
+
+        /**
+         * Exposes a member variable of primitive type as a Kotlin property.
+         * Kotlin accessors read and write the member variable at a fixed offset from the native pointer, without a
+         * JNI call, and the property is declared in the generated Kotlin class.
+         */
+        template <auto member>
+        native_class& property(const char* name) {
+            static_assert(std::is_member_object_pointer_v<decltype(member)>, "The non-type template argument is expected to be of a member variable pointer type.");
+            static_assert(std::is_standard_layout_v<T>, "Properties require a standard-layout class such that member offsets are well-defined.");
+            using member_type = typename FieldType<decltype(member)>::type;
+            using value_type = std::remove_cv_t<member_type>;
+            static_assert(is_fast_type<value_type>::value && !std::is_void_v<value_type>, "Properties are expected to be of a primitive type with the same representation in Java.");
+
+            PropertyBindings::value[ArgType<T>::class_name].push_back({
+                name,
+                ArgType<value_type>::type_sig,
+                member_offset(member),
+                !std::is_const_v<member_type>,
+                ArgType<value_type>::kotlin_type
+            });
+            return *this;
+        }
+
+    private:
+        BindingList _bindings;
+    };
+
+    /**
+     * Represents a Kotlin singleton object (declared with `object`) whose functions are implemented in native code.
+     * Reserved for use by the interoperability framework. Objects are optional: registration is skipped if the Kotlin
+     * class is not found. Functions are always registered as JNI native methods, even with `KTBIND_ENABLE_DOWNCALLS`,
+     * since the Kotlin objects of the framework are declared by hand with `external fun`.
+     */
+    struct native_object {
+        /**
+         * @param class_name The Java class name of the Kotlin object, e.g. `com/kheiron/ktbind/KtBindStats`.
+         */
+        native_object(std::string_view class_name) : _bindings(ObjectBindings::of(class_name)) {}
+
+        native_object(const native_object&) = delete;
+        native_object(native_object&&) = delete;
+
+        template <auto func>
+        native_object& function(const char* name) {
+            using func_type = decltype(func);
+            static_assert(is_free_function_pointer<func_type>::value, "The non-type template argument is expected to be of a free function pointer type.");
+
+            _bindings.add({
+                name,
+                Function<func_type>::signature,
+                false,
+                callable<void, func>(args_t<func_type>{}),
+                Function<func_type>::kotlin_type,
+                callable_site<void, func>(args_t<func_type>{})
+            });
+            return *this;
+        }
+
+    private:
+        BindingList _bindings;
+    };
+
+    /**
+     * Declares a class to serve as a data transfer type.
+     * Data classes marshal data between native and Java code with copy semantics. The lifecycle of the native
+     * and the Java object is not coupled.
+     */
+    template <typename T>
+    struct data_class {
+        data_class() : _bindings(FieldBindings::value[ArgType<T>::type_sig]) {}
+        data_class(const data_class&) = delete;
+        data_class(data_class&&) = delete;
+
+        template <auto member>
+        data_class& field(const char* name) {
+            static_assert(std::is_member_object_pointer_v<decltype(member)>, "The non-type template argument is expected to be of a member variable pointer type.");
+            using member_type = typename FieldType<decltype(member)>::type;
+
+            _bindings.push_back({
+                name,
+                ArgType<member_type>::type_sig,
+                [](JNIEnv* env, jobject obj, Field& fld, const void* native_object_ptr) {
+                    const T* native_object = reinterpret_cast<const T*>(native_object_ptr);
+                    ArgType<member_type>::java_field_value(env, obj, fld, native_object->*member);
+                },
+                [](JNIEnv* env, jobject obj, Field& fld, void* native_object_ptr) {
+                    T* native_object = reinterpret_cast<T*>(native_object_ptr);
+                    native_object->*member = ArgType<member_type>::native_field_value(env, obj, fld);
+                },
+                ArgType<member_type>::kotlin_type
+            });
+            return *this;
+        }
+
+    private:
+        std::vector<FieldBinding>& _bindings;
+    };
+
+#if defined(KTBIND_ENABLE_STATISTICS)
+    /**
+     * Implements the Kotlin object `KtBindStats`, which exposes call statistics collected in native code.
+     * Statistics cover all bindings, as functions are not routed to downcalls when statistics are enabled.
+     * Bindings are identified by their qualified Kotlin name, e.g. `com.kheiron.ktbind.Sample.get_data`, and
+     * call phases by the ordinal of [CallPhase].
+     */
+    struct StatisticsObject {
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/KtBindStats";
+
+        static std::vector<std::string> bindings() {
+            std::vector<std::string> names;
+            for (CallSite* site : CallSites::value) {
+                names.push_back(site->qualified_name());
+                names.insert(names.end(), site->aliases.begin(), site->aliases.end());
+            }
+            return names;
+        }
+
+        static std::int64_t calls(std::string binding) {
+            return Statistics::totals(find(binding)).calls;
+        }
+
+        static std::int64_t errors(std::string binding) {
+            return Statistics::totals(find(binding)).errors;
+        }
+
+        static std::int64_t total_nanos(std::string binding, int phase) {
+            return Statistics::totals(find(binding)).nanos[phase_index(phase)];
+        }
+
+        static std::vector<std::int64_t> histogram(std::string binding, int phase) {
+            CallTotals totals = Statistics::totals(find(binding));
+            auto&& buckets = totals.buckets[phase_index(phase)];
+            return std::vector<std::int64_t>(buckets.begin(), buckets.end());
+        }
+
+        /** Smallest duration (in nanoseconds) that falls into each histogram bucket. */
+        static std::vector<std::int64_t> bucket_bounds() {
+            std::vector<std::int64_t> bounds;
+            for (std::size_t k = 0; k < LatencyBuckets::count; ++k) {
+                bounds.push_back(LatencyBuckets::lower_bound(k));
+            }
+            return bounds;
+        }
+
+        /** Approximate duration (in nanoseconds) that a given percentage of calls do not exceed in a phase. */
+        static std::int64_t percentile(std::string binding, int phase, double p) {
+            CallTotals totals = Statistics::totals(find(binding));
+            auto&& buckets = totals.buckets[phase_index(phase)];
+            std::uint64_t total = 0;
+            for (auto count : buckets) {
+                total += count;
+            }
+            if (total == 0) {
+                return 0;
+            }
+
+            double threshold = std::clamp(p, 0.0, 100.0) / 100.0 * total;
+            std::uint64_t cumulative = 0;
+            for (std::size_t k = 0; k < LatencyBuckets::count; ++k) {
+                cumulative += buckets[k];
+                if (cumulative > 0 && cumulative >= threshold) {
+                    return k + 1 < LatencyBuckets::count ? LatencyBuckets::lower_bound(k + 1) - 1 : LatencyBuckets::lower_bound(k);
+                }
+            }
+            return LatencyBuckets::lower_bound(LatencyBuckets::count - 1);
+        }
+
+        /** Number of Java objects instantiated in a direction (0: to native, 1: to Java) by type converters. */
+        static std::int64_t objects(std::string binding, int direction) {
+            return Statistics::totals(find(binding)).objects[direction_index(direction)];
+        }
+
+        /** Number of bytes of string and array data copied in a direction (0: to native, 1: to Java). */
+        static std::int64_t bytes(std::string binding, int direction) {
+            return Statistics::totals(find(binding)).bytes[direction_index(direction)];
+        }
+
+        /** Number of collection elements converted in a direction (0: to native, 1: to Java). */
+        static std::int64_t elements(std::string binding, int direction) {
+            return Statistics::totals(find(binding)).elements[direction_index(direction)];
+        }
+
+        static void reset() {
+            Statistics::reset();
+        }
+
+        static void slow_call_threshold(std::int64_t nanos) {
+            if (nanos < 0) {
+                throw std::invalid_argument("Slow call threshold must not be negative.");
+            }
+            SlowCallEvents::set_threshold(this_thread.getEnv(), static_cast<std::uint64_t>(nanos));
+        }
+
+        static void bind() {
+            native_object(class_name)
+                .function<bindings>("bindings")
+                .function<calls>("calls")
+                .function<errors>("errors")
+                .function<total_nanos>("totalNanos")
+                .function<histogram>("histogram")
+                .function<bucket_bounds>("bucketBounds")
+                .function<percentile>("percentile")
+                .function<objects>("objects")
+                .function<bytes>("bytes")
+                .function<elements>("elements")
+                .function<reset>("reset")
+                .function<slow_call_threshold>("slowCallThreshold")
+            ;
+        }
+
+    private:
+        static const CallSite& find(const std::string& binding) {
+            return CallSites::find(binding);
+        }
+
+        static std::size_t phase_index(int phase) {
+            if (phase < 0 || static_cast<std::size_t>(phase) >= call_phase_count) {
+                throw std::out_of_range(msg() << "Call phase " << phase << " is out of range.");
+            }
+            return static_cast<std::size_t>(phase);
+        }
+
+        static std::size_t direction_index(int direction) {
+            if (direction < 0 || static_cast<std::size_t>(direction) >= marshal_direction_count) {
+                throw std::out_of_range(msg() << "Marshaling direction " << direction << " is out of range.");
+            }
+            return static_cast<std::size_t>(direction);
+        }
+    };
+#endif
+
+#if defined(KTBIND_ENABLE_JNI_PROFILER)
+    /**
+     * Implements the Kotlin object `KtBindProfiler`, which exposes the number of JNI function invocations per binding.
+     * JNI function categories are listed by `operations()`, in the order of [JniOperation].
+     */
+    struct JniProfilerObject {
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/KtBindProfiler";
+
+        static void enable(bool enabled) {
+            JniProfiler::enable(enabled);
+        }
+
+        static std::vector<std::string> operations() {
+            return std::vector<std::string>(std::begin(JniProfiler::operation_names), std::end(JniProfiler::operation_names));
+        }
+
+        static std::int64_t calls(std::string binding) {
+            return JniProfiler::profile(CallSites::find(binding)).calls;
+        }
+
+        static std::vector<std::int64_t> total(std::string binding) {
+            auto&& counts = JniProfiler::profile(CallSites::find(binding)).total;
+            return std::vector<std::int64_t>(counts.begin(), counts.end());
+        }
+
+        static std::vector<std::int64_t> max_per_call(std::string binding) {
+            auto&& counts = JniProfiler::profile(CallSites::find(binding)).max;
+            return std::vector<std::int64_t>(counts.begin(), counts.end());
+        }
+
+        static std::int64_t max_total_per_call(std::string binding) {
+            return JniProfiler::profile(CallSites::find(binding)).max_total;
+        }
+
+        static void reset() {
+            JniProfiler::reset();
+        }
+
+        static void bind() {
+            native_object(class_name)
+                .function<enable>("enable")
+                .function<operations>("operations")
+                .function<calls>("calls")
+                .function<total>("total")
+                .function<max_per_call>("maxPerCall")
+                .function<max_total_per_call>("maxTotalPerCall")
+                .function<reset>("reset")
+            ;
+        }
+    };
+#endif
+
+#if defined(KTBIND_ENABLE_TRACING)
+    /**
+     * Exposes the tracer to Kotlin.
+     */
+    struct TracerObject {
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/KtBindTrace";
+
+        static void start(int capacity) {
+            if (capacity <= 0) {
+                throw std::invalid_argument("Trace buffer capacity must be positive.");
+            }
+            Tracer::start(static_cast<std::size_t>(capacity));
+        }
+
+        static void stop() {
+            Tracer::stop();
+        }
+
+        static void clear() {
+            Tracer::clear();
+        }
+
+        static std::string json() {
+            std::ostringstream os;
+            Tracer::write_json(os);
+            return os.str();
+        }
+
+        static void write(std::string path) {
+            std::ofstream file(path);
+            if (!file) {
+                throw std::runtime_error(msg() << "Cannot open trace file '" << path << "' for writing.");
+            }
+            Tracer::write_json(file);
+            if (!file.flush()) {
+                throw std::runtime_error(msg() << "Failed to write trace file '" << path << "'.");
+            }
+        }
+
+        static void bind() {
+            native_object(class_name)
+                .function<start>("start")
+                .function<stop>("stop")
+                .function<clear>("clear")
+                .function<json>("json")
+                .function<write>("write")
+            ;
+        }
+    };
+#endif
+
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+    /**
+     * Implements the Kotlin object `KtBindLeaks`, which exposes the number of live native objects per class and the
+     * number of global references held by native code.
+     * Classes are identified by their qualified Kotlin name, e.g. `com.kheiron.ktbind.Sample`.
+     */
+    struct LeakTrackerObject {
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/KtBindLeaks";
+
+        static std::vector<std::string> classes() {
+            std::vector<std::string> names;
+            for (LeakTracker::ClassCounters* c : LeakTracker::classes()) {
+                names.push_back(qualified_name(c->class_name));
+            }
+            return names;
+        }
+
+        static std::int64_t live_objects(std::string class_name) {
+            LeakTracker::ClassCounters& c = find(class_name);
+            std::uint64_t destroyed = c.destroyed.load(std::memory_order_relaxed);
+            return c.created.load(std::memory_order_relaxed) - destroyed;
+        }
+
+        static std::int64_t created_objects(std::string class_name) {
+            return find(class_name).created.load(std::memory_order_relaxed);
+        }
+
+        static std::int64_t global_refs() {
+            return LeakTracker::global_refs();
+        }
+
+        static void capture_allocation_sites(bool enabled) {
+            LeakTracker::capture_allocation_sites(enabled);
+        }
+
+        static std::vector<std::string> allocation_sites(std::string class_name) {
+            return LeakTracker::allocation_sites(this_thread.getEnv(), find(class_name));
+        }
+
+#if defined(KTBIND_ENABLE_JNI_PROFILER)
+        static std::int64_t max_local_refs(std::string binding) {
+            return JniProfiler::profile(CallSites::find(binding)).max_local_refs;
+        }
+#endif
+
+        static void bind() {
+            native_object leaks(class_name);
+            leaks
+                .function<classes>("classes")
+                .function<live_objects>("liveObjects")
+                .function<created_objects>("createdObjects")
+                .function<global_refs>("globalRefs")
+                .function<capture_allocation_sites>("captureAllocationSites")
+                .function<allocation_sites>("allocationSites")
+            ;
+#if defined(KTBIND_ENABLE_JNI_PROFILER)
+            // local references are counted by the JNI profiler, which interposes the functions that create them
+            leaks.function<max_local_refs>("maxLocalRefs");
+#endif
+        }
+
+    private:
+        static std::string qualified_name(std::string_view class_name) {
+            std::string qualified(class_name);
+            std::replace(qualified.begin(), qualified.end(), '/', '.');
+            return qualified;
+        }
+
+        static LeakTracker::ClassCounters& find(const std::string& class_name) {
+            for (LeakTracker::ClassCounters* c : LeakTracker::classes()) {
+                if (qualified_name(c->class_name) == class_name) {
+                    return *c;
+                }
+            }
+            throw std::invalid_argument(msg() << "No native class is registered with the name '" << class_name << "'.");
+        }
+    };
+#endif
+
+    /**
+     * Implements the Kotlin object `KtBindLog`, which configures the native logging channel.
+     * Levels are identified by the ordinal of [LogLevel].
+     *
+     * Unlike other built-in objects, `KtBindLog` is not looked up when the library is loaded. Its initializer calls the
+     * exported function `Java_com_kheiron_ktbind_KtBindLog_bind`, which the JVM resolves by name, and which registers
+     * the remaining native methods with the class passed in.
+     */
+    struct LogObject {
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/KtBindLog";
+
+        static int level() {
+            return static_cast<int>(Log::level());
+        }
+
+        static void set_level(int level) {
+            if (level < static_cast<int>(LogLevel::trace) || level > static_cast<int>(LogLevel::off)) {
+                throw std::out_of_range(msg() << "Log level " << level << " is out of range.");
+            }
+            Log::set_level(static_cast<LogLevel>(level));
+        }
+
+        static void flush() {
+            Log::flush(this_thread.getEnv());
+        }
+
+        static std::int64_t written() {
+            return Log::written();
+        }
+
+        static std::int64_t dropped() {
+            return Log::dropped();
+        }
+
+        static const std::vector<FunctionBinding>& bindings() {
+            static const std::vector<FunctionBinding> list = {
+                binding<level>("level"),
+                binding<set_level>("setLevel"),
+                binding<flush>("flush"),
+                binding<written>("written"),
+                binding<dropped>("dropped")
+            };
+            return list;
+        }
+
+        /** The method table passed to [RegisterNatives], built on first use. */
+        static const std::vector<JNINativeMethod>& natives() {
+            static const std::vector<JNINativeMethod> table = [] {
+                std::vector<JNINativeMethod> methods;
+                for (auto&& binding : bindings()) {
+                    methods.push_back(native_method(binding));
+                }
+                return methods;
+            }();
+            return table;
+        }
+
+        /**
+         * Assigns meta-information to the adapters of the methods, such that their calls are counted and reported
+         * under their own names. Invoked when the library is loaded, along with the call sites of other bindings.
+         */
+        static void load() {
+            for (auto&& binding : bindings()) {
+                CallSites::add(*binding.site, class_name, binding.name);
+            }
+        }
+
+        static void JNICALL register_class(JNIEnv* env, jclass cls) {
+            try {
+                // a failed registration leaves a pending NoSuchMethodError
+                auto&& table = natives();
+                env->RegisterNatives(cls, table.data(), static_cast<jint>(table.size()));
+            } catch (...) {
+                translate_exception(env);
+            }
+        }
+
+    private:
+        template <auto func>
+        static FunctionBinding binding(const char* name) {
+            using func_type = decltype(func);
+            return {
+                name,
+                Function<func_type>::signature,
+                false,
+                callable<void, func>(args_t<func_type>{}),
+                Function<func_type>::kotlin_type,
+                callable_site<void, func>(args_t<func_type>{})
+            };
+        }
+    };
+
+#if defined(KTBIND_LAZY_REGISTRATION)
+    /**
+     * Exposes lazy registration of native methods to Kotlin as the object `KtBind`.
+     * In lazy mode, [JNI_OnLoad] registers no native classes. Instead, the companion object of each native class
+     * calls `KtBind.register` when it is initialized, which registers the native methods of that class only.
+     */
+    struct RegistrationObject {
+        constexpr static std::string_view class_name = "com/kheiron/ktbind/KtBind";
+
+        static void JNICALL register_class(JNIEnv* env, jclass, jclass cls) {
+            try {
+                // binary name of the class, e.g. `com/kheiron/ktbind/Sample` for `com.kheiron.ktbind.Sample`
+                LocalClassRef classClass(env, "java/lang/Class");
+                Method getName = classClass.getMethod("getName", "()Ljava/lang/String;");
+                LocalObjectRef nameRef(env, env->CallObjectMethod(cls, getName.ref()));
+                if (env->ExceptionCheck()) {
+                    throw JavaException(env);
+                }
+                std::string name = ArgType<std::string>::native_value(env, static_cast<jstring>(nameRef.ref()));
+                std::replace(name.begin(), name.end(), '.', '/');
+
+                auto&& it = FunctionBindings::natives.find(name);
+                if (it == FunctionBindings::natives.end()) {
+                    throw std::invalid_argument(msg() << "Class '" << name << "' is not registered as a native class in C++ code");
+                }
+                // a failed registration leaves a pending NoSuchMethodError
+                auto&& natives = it->second;
+                env->RegisterNatives(cls, natives.data(), static_cast<jint>(natives.size()));
+            } catch (...) {
+                translate_exception(env);
+            }
+        }
+
+        static void bind() {
+            auto&& natives = ObjectBindings::natives[class_name];
+            natives.push_back({
+                const_cast<char*>("register"),
+                const_cast<char*>("(Ljava/lang/Class;)V"),
+                reinterpret_cast<void*>(register_class)
+            });
+        }
+    };
+#endif
+
+    /**
+     * Registers the Kotlin objects that expose the built-in facilities of the interoperability framework.
+     */
+    inline void register_builtin_objects() {
+#if defined(KTBIND_LAZY_REGISTRATION)
+        RegistrationObject::bind();
+#endif
+#if defined(KTBIND_ENABLE_STATISTICS)
+        StatisticsObject::bind();
+#endif
+#if defined(KTBIND_ENABLE_JNI_PROFILER)
+        JniProfilerObject::bind();
+#endif
+#if defined(KTBIND_ENABLE_TRACING)
+        TracerObject::bind();
+#endif
+#if defined(KTBIND_ENABLE_LEAK_TRACKING)
+        LeakTrackerObject::bind();
+#endif
+        for (auto&& [class_name, bindings] : ObjectBindings::value) {
+            ObjectBindings::builtins.insert(class_name);
+        }
+    }
+
+    /**
+     * Returns the unqualified name of a Java class, e.g. `Sample` for `com/kheiron/ktbind/Sample`.
+     */
+    inline std::string_view simple_class_name(std::string_view class_name) {
+        std::size_t found = class_name.rfind('/');
+        if (found != std::string_view::npos) {
+            return class_name.substr(found + 1);
+        } else {
+            return class_name;
+        }
+    }
+
+    /**
+     * Returns the Kotlin package of a Java class, e.g. `com.kheiron.ktbind` for `com/kheiron/ktbind/Sample`.
+     */
+    inline std::string package_name(std::string_view class_name) {
+        std::size_t found = class_name.rfind('/');
+        std::string package(found != std::string_view::npos ? class_name.substr(0, found) : std::string_view());
+        std::replace(package.begin(), package.end(), '/', '.');
+        return package;
+    }
+
+    /**
+     * Returns the class name of a data class from the key it is registered with, e.g. `com/kheiron/ktbind/Data`
+     * for `Lcom/kheiron/ktbind/Data;`.
+     */
+    inline std::string_view data_class_name(std::string_view type_sig) {
+        return type_sig.substr(1, type_sig.size() - 2);
+    }
+
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+    /**
+     * Returns the Foreign Function & Memory API value layout of a primitive type in a JNI signature, e.g. `JAVA_INT` for `I`.
+     */
+    inline std::string_view value_layout(char type_sig) {
+        switch (type_sig) {
+            case 'Z': return "java.lang.foreign.ValueLayout.JAVA_BOOLEAN";
+            case 'B': return "java.lang.foreign.ValueLayout.JAVA_BYTE";
+            case 'C': return "java.lang.foreign.ValueLayout.JAVA_CHAR";
+            case 'S': return "java.lang.foreign.ValueLayout.JAVA_SHORT";
+            case 'I': return "java.lang.foreign.ValueLayout.JAVA_INT";
+            case 'J': return "java.lang.foreign.ValueLayout.JAVA_LONG";
+            case 'F': return "java.lang.foreign.ValueLayout.JAVA_FLOAT";
+            case 'D': return "java.lang.foreign.ValueLayout.JAVA_DOUBLE";
+            default: throw std::invalid_argument(msg() << "Type signature '" << type_sig << "' is not a primitive type");
+        }
+    }
+
+    /**
+     * Writes a companion object function that calls a native function through a method handle.
+     * Parameters and the return value of downcall functions are single-character primitive type signatures.
+     */
+    inline void write_downcall(std::ostream& os, std::string_view class_name, const DowncallBinding& binding, std::size_t index) {
+        std::string_view params = binding.signature.substr(1, binding.signature.find(')') - 1);
+        char result = binding.signature.back();
+
+        os << "        private val downcall" << index << " = com.kheiron.ktbind.Downcalls.handle(\""
+            << DowncallBindings::key(class_name, binding) << "\", java.lang.foreign.FunctionDescriptor.";
+        if (result == 'V') {
+            os << "ofVoid(";
+        } else {
+            os << "of(" << value_layout(result) << (params.empty() ? "" : ", ");
+        }
+        for (std::size_t k = 0; k < params.size(); ++k) {
+            os << (k > 0 ? ", " : "") << value_layout(params[k]);
+        }
+        os << "))\n";
+
+        os << "        @JvmStatic fun " << binding.name << binding.friendly_signature << " {\n"
+            << "            " << (result == 'V' ? "" : "return ") << "downcall" << index << ".invoke(";
+        for (std::size_t k = 0; k < params.size(); ++k) {
+            os << (k > 0 ? ", " : "") << "arg" << k;
+        }
+        os << ")";
+        if (result != 'V') {
+            os << " as " << binding.friendly_signature.substr(binding.friendly_signature.rfind(':') + 2);
+        }
+        os << "\n        }\n";
+    }
+
+    /**
+     * Writes the Kotlin object that looks up the addresses of native functions bound for downcalls.
+     */
+    inline void write_downcall_lookup(std::ostream& os) {
+        os
+            << "/** Creates method handles for native functions called with the Foreign Function & Memory API (JDK 22 or later). */\n"
+            << "object Downcalls {\n"
+            << "    private val linker = java.lang.foreign.Linker.nativeLinker()\n"
+            << "    private val addresses: Map<String, java.lang.foreign.MemorySegment> = run {\n"
+            << "        val lookup = java.lang.foreign.SymbolLookup.loaderLookup()\n"
+            << "        fun export(name: String, descriptor: java.lang.foreign.FunctionDescriptor) =\n"
+            << "            linker.downcallHandle(lookup.find(name).orElseThrow { UnsatisfiedLinkError(name) }, descriptor)\n"
+            << "        val count = export(\"ktbind_downcall_count\", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.JAVA_LONG))\n"
+            << "        val key = export(\"ktbind_downcall_key\", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.ADDRESS, java.lang.foreign.ValueLayout.JAVA_LONG))\n"
+            << "        val address = export(\"ktbind_downcall_address\", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.ADDRESS, java.lang.foreign.ValueLayout.JAVA_LONG))\n"
+            << "        (0 until count.invoke() as Long).associate { k ->\n"
+            << "            (key.invoke(k) as java.lang.foreign.MemorySegment).reinterpret(Long.MAX_VALUE).getString(0) to\n"
+            << "                (address.invoke(k) as java.lang.foreign.MemorySegment)\n"
+            << "        }\n"
+            << "    }\n"
+            << "\n"
+            << "    /** Native functions bound for downcalls take primitive arguments only and cannot throw, and run as critical functions. */\n"
+            << "    @JvmStatic fun handle(key: String, descriptor: java.lang.foreign.FunctionDescriptor): java.lang.invoke.MethodHandle =\n"
+            << "        linker.downcallHandle(\n"
+            << "            addresses[key] ?: throw UnsatisfiedLinkError(\"No native function bound as $key\"),\n"
+            << "            descriptor,\n"
+            << "            java.lang.foreign.Linker.Option.critical(false)\n"
+            << "        )\n"
+            << "}\n\n"
+        ;
+    }
+#endif
+
+    inline void write_native_class(std::ostream& os, std::string_view class_name, const std::vector<FunctionBinding>& bindings) {
+        // class definition
+        os
+            << "class " << simple_class_name(class_name) << " private constructor() : NativeObject() {\n"
+        ;
+
+        // instance methods
+        for (auto&& binding : bindings) {
+            if (binding.is_member) {
+                os << (binding.name == "close" ? "    external override fun " : "    external fun ") << binding.name << binding.friendly_signature << "\n";
+            }
+        }
+
+        // properties accessed in native memory
+        auto&& properties = PropertyBindings::value.find(class_name);
+        if (properties != PropertyBindings::value.end()) {
+            for (auto&& property : properties->second) {
+                os
+                    << "    " << (property.is_mutable ? "var " : "val ") << property.name << ": " << property.kotlin_type << "\n"
+                    << "        get() = com.kheiron.ktbind.NativeMemory.get" << property.kotlin_type << "(nativePointer, " << property.offset << ")\n"
+                ;
+                if (property.is_mutable) {
+                    os << "        set(value) = com.kheiron.ktbind.NativeMemory.put" << property.kotlin_type << "(nativePointer, " << property.offset << ", value)\n";
+                }
+            }
+        }
+
+        // companion object methods
+        os << "    companion object {\n";
+#if defined(KTBIND_LAZY_REGISTRATION)
+        os << "        init { com.kheiron.ktbind.KtBind.register(" << simple_class_name(class_name) << "::class.java) }\n";
+#endif
+        for (auto&& binding : bindings) {
+            if (!binding.is_member) {
+                os << "        @JvmStatic external fun " << binding.name << binding.friendly_signature << "\n";
+            }
+        }
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+        auto&& downcalls = DowncallBindings::value.find(class_name);
+        if (downcalls != DowncallBindings::value.end()) {
+            for (std::size_t k = 0; k < downcalls->second.size(); ++k) {
+                write_downcall(os, class_name, downcalls->second[k], k);
             }
         }
-    };
+#endif
 
-    template <typename T, typename... Args>
-    constexpr void* object_initialization(types<Args...>) {
-        return reinterpret_cast<void*>(CreateObjectAdapter<T, Args...>::invoke);
+        // end of class definition
+        os
+            << "    }\n"
+            << "}\n\n";
     }
 
-    template <typename T>
-    constexpr void* object_termination() {
-        return reinterpret_cast<void*>(DestroyObjectAdapter<T>::invoke);
+    inline void write_native_object(std::ostream& os, std::string_view class_name, const std::vector<FunctionBinding>& bindings) {
+        os << "object " << simple_class_name(class_name) << " {\n";
+        for (auto&& binding : bindings) {
+            os << "    @JvmStatic external fun " << binding.name << binding.friendly_signature << "\n";
+        }
+        os << "}\n\n";
     }
 
-    struct FunctionBinding {
-        std::string_view name;
-        std::string_view signature;
-        bool is_member;
-        void* function_entry_point;
-        std::string_view friendly_signature;
-    };
+    inline void write_data_class(std::ostream& os, std::string_view class_name, const std::vector<FieldBinding>& bindings) {
+        // data classes are instantiated with `AllocObject`, and need no default values
+        os << "data class " << simple_class_name(class_name) << "(\n";
+        for (std::size_t k = 0; k < bindings.size(); ++k) {
+            os << "    val " << bindings[k].name << ": " << bindings[k].kotlin_type << (k + 1 < bindings.size() ? ",\n" : "\n");
+        }
+        os
+            << ") {\n"
+            << "    companion object {\n"
+            << "        /** Fingerprint of the fields bound in native code, checked when the library is loaded. */\n"
+            << "        const val " << schema_field_name << ": Long = " << schema_hash(bindings) << "L\n"
+            << "    }\n"
+            << "}\n\n"
+        ;
+    }
 
-    struct FunctionBindings {
-        inline static std::map< std::string_view, std::vector<FunctionBinding> > value;
-    };
+    /**
+     * Writes a Kotlin exception class that a native exception type is translated into.
+     * Fields are populated with JNI after the exception object is constructed with a message.
+     */
+    inline void write_exception_class(std::ostream& os, const ExceptionMapping& mapping) {
+        os << "class " << simple_class_name(mapping.class_name) << "(message: String) : Exception("
+            << (mapping.stack_trace ? "message" : "message, null, false, false") << ")";
+        if (mapping.fields.empty()) {
+            os << "\n\n";
+            return;
+        }
+
+        os << " {\n";
+        for (auto&& field : mapping.fields) {
+            std::string_view initial_value;
+            switch (field.signature.front()) {
+                case 'Z': initial_value = "false"; break;
+                case 'B': case 'S': case 'I': initial_value = "0"; break;
+                case 'J': initial_value = "0L"; break;
+                case 'F': initial_value = "0.0f"; break;
+                case 'D': initial_value = "0.0"; break;
+                case 'C': initial_value = "'\\u0000'"; break;
+            }
+            if (!initial_value.empty()) {
+                os << "    val " << field.name << ": " << field.kotlin_type << " = " << initial_value << "\n";
+            } else {
+                os << "    lateinit var " << field.name << ": " << field.kotlin_type << "\n        private set\n";
+            }
+        }
+        os << "}\n\n";
+    }
 
     /**
-     * Represents a native class in Java.
-     * The Java object holds an opaque pointer to the native object. The lifecycle of the object is governed by Java.
+     * Prints all registered Java bindings.
      */
-    template <typename T>
-    struct native_class {
-        native_class() {
-            auto&& bindings = FunctionBindings::value[ArgType<T>::class_name];
-            bindings.push_back({
-                "close",
-                Function<void()>::signature,
-                true,
-                object_termination<T>(),
-                Function<void()>::kotlin_type
-            });
+    inline void print_registered_bindings() {
+#if !defined(KTBIND_STUB_GENERATOR)
+        JavaOutput output(this_thread.getEnv());
+        std::ostream& os = output.stream();
+
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+        write_downcall_lookup(os);
+#endif
+        for (auto&& [class_name, bindings] : FieldBindings::value) {
+            write_data_class(os, data_class_name(class_name), bindings);
         }
+        for (auto&& [class_name, bindings] : FunctionBindings::value) {
+            write_native_class(os, class_name, bindings);
+        }
+        for (auto&& [class_name, bindings] : ObjectBindings::value) {
+            if (!ObjectBindings::is_builtin(class_name)) {
+                write_native_object(os, class_name, bindings);
+            }
+        }
+        for (auto&& [type, mapping] : ExceptionMappings::value) {
+            write_exception_class(os, mapping);
+        }
+#endif
+    }
 
-        native_class(const native_class&) = delete;
-        native_class(native_class&&) = delete;
+#if defined(KTBIND_STUB_GENERATOR)
+    /**
+     * Collects the classes, methods and fields accessed through JNI, and writes them in the format of the GraalVM
+     * native image configuration file `jni-config.json`.
+     */
+    class JniConfig {
+    public:
+        /** Registers a class, e.g. `com/kheiron/ktbind/Sample`, to be found with `FindClass`. */
+        void add_class(std::string_view class_name) {
+            entry(class_name);
+        }
 
-        template <typename F>
-        native_class& constructor(std::string_view name) {
-            static_assert(std::is_function_v<F>, "Use a function signature such as Sample(int, std::string) to identify a constructor.");
+        /** Registers all public constructors, methods and fields of a class, e.g. for classes of the JDK. */
+        void add_public_members(std::string_view class_name) {
+            entry(class_name).public_members = true;
+        }
 
-            auto&& bindings = FunctionBindings::value[ArgType<T>::class_name];
-            bindings.push_back({
-                name,
-                Function<F>::signature,
-                false,
-                object_initialization<T>(args_t<F>{}),
-                Function<F>::kotlin_type
-            });
-            return *this;
+        /** Registers a class whose instances are created with `AllocObject`. */
+        void add_allocated_class(std::string_view class_name) {
+            entry(class_name).unsafe_allocated = true;
         }
 
-        template <auto func>
-        native_class& function(const char* name) {
-            using func_type = decltype(func);
+        void add_field(std::string_view class_name, std::string_view name) {
+            entry(class_name).fields.emplace(name);
+        }
 
-            // check if signature is R(*func)(Args...)
-            constexpr bool is_free = is_free_function_pointer<func_type>::value;
-            // check if signature is R(T::*func)(Args...)
-            constexpr bool is_member = std::is_member_function_pointer<func_type>::value;
+        /** Registers a method with a JNI signature, e.g. `(ILjava/lang/String;)V`. */
+        void add_method(std::string_view class_name, std::string_view name, std::string_view signature) {
+            std::vector<std::string> parameter_types;
+            std::size_t end = signature.find(')');
+            for (std::size_t pos = 1; pos < end; ) {
+                parameter_types.push_back(java_type_name(signature, pos));
+            }
+            entry(class_name).methods.emplace(std::string(name), std::move(parameter_types));
+        }
 
-            static_assert(is_free || is_member, "The non-type template argument is expected to be of a free function or a compatible member function pointer type.");
+        /** Registers the classes referenced in a JNI type signature, e.g. `(Lkotlin/jvm/functions/Function1;)V`. */
+        void add_referenced_classes(std::string_view signature) {
+            for (std::size_t pos = signature.find('L'); pos != std::string_view::npos; pos = signature.find('L', pos)) {
+                std::size_t end = signature.find(';', pos);
+                std::string_view class_name = signature.substr(pos + 1, end - pos - 1);
+                if (class_name.substr(0, std::string_view("kotlin/jvm/functions/").size()) == "kotlin/jvm/functions/") {
+                    add_public_members(class_name);  // callbacks invoke the interface method `invoke`
+                } else {
+                    add_class(class_name);
+                }
+                pos = end;
+            }
+        }
 
-            auto&& bindings = FunctionBindings::value[ArgType<T>::class_name];
-            bindings.push_back({
-                name,
-                Function<func_type>::signature,
-                is_member,
-                callable<T, func>(args_t<func_type>{}),
-                Function<func_type>::kotlin_type
-            });
-            return *this;
+        void write(std::ostream& os) const {
+            os << "[\n";
+            for (auto it = _classes.begin(); it != _classes.end(); ++it) {
+                auto&& [class_name, e] = *it;
+                os << "  {\n" << "    \"name\": \"" << class_name << "\"";
+                if (e.public_members) {
+                    os
+                        << ",\n    \"allPublicConstructors\": true"
+                        << ",\n    \"allPublicMethods\": true"
+                        << ",\n    \"allPublicFields\": true"
+                    ;
+                }
+                if (e.unsafe_allocated) {
+                    os << ",\n    \"unsafeAllocated\": true";
+                }
+                if (!e.fields.empty()) {
+                    os << ",\n    \"fields\": [";
+                    const char* sep = "";
+                    for (auto&& name : e.fields) {
+                        os << sep << "\n      { \"name\": \"" << name << "\" }";
+                        sep = ",";
+                    }
+                    os << "\n    ]";
+                }
+                if (!e.methods.empty()) {
+                    os << ",\n    \"methods\": [";
+                    const char* sep = "";
+                    for (auto&& [name, parameter_types] : e.methods) {
+                        os << sep << "\n      { \"name\": \"" << name << "\", \"parameterTypes\": [";
+                        for (std::size_t k = 0; k < parameter_types.size(); ++k) {
+                            os << (k > 0 ? ", " : "") << "\"" << parameter_types[k] << "\"";
+                        }
+                        os << "] }";
+                        sep = ",";
+                    }
+                    os << "\n    ]";
+                }
+                os << "\n  }" << (std::next(it) != _classes.end() ? "," : "") << "\n";
+            }
+            os << "]\n";
         }
-    };
 
-    /**
-     * Declares a class to serve as a data transfer type.
-     * Data classes marshal data between native and Java code with copy semantics. The lifecycle of the native
-     * and the Java object is not coupled.
-     */
-    template <typename T>
-    struct data_class {
-        data_class() = default;
-        data_class(const data_class&) = delete;
-        data_class(data_class&&) = delete;
+    private:
+        struct Entry {
+            bool public_members = false;
+            bool unsafe_allocated = false;
+            std::set<std::string> fields;
+            std::set<std::pair<std::string, std::vector<std::string>>> methods;
+        };
 
-        template <auto member>
-        data_class& field(const char* name) {
-            static_assert(std::is_member_object_pointer_v<decltype(member)>, "The non-type template argument is expected to be of a member variable pointer type.");
-            using member_type = typename FieldType<decltype(member)>::type;
+        /** Looks up a class by its binary name, with either `/` or `.` as a separator. */
+        Entry& entry(std::string_view class_name) {
+            std::string name(class_name);
+            std::replace(name.begin(), name.end(), '/', '.');
+            return _classes[name];
+        }
 
-            auto&& bindings = FieldBindings::value[ArgType<T>::type_sig];
-            bindings.push_back({
-                name,
-                ArgType<member_type>::type_sig,
-                [](JNIEnv* env, jobject obj, Field& fld, const void* native_object_ptr) {
-                    const T* native_object = reinterpret_cast<const T*>(native_object_ptr);
-                    ArgType<member_type>::java_field_value(env, obj, fld, native_object->*member);
-                },
-                [](JNIEnv* env, jobject obj, Field& fld, void* native_object_ptr) {
-                    T* native_object = reinterpret_cast<T*>(native_object_ptr);
-                    native_object->*member = ArgType<member_type>::native_field_value(env, obj, fld);
+        /** Converts a single type in a JNI signature into a Java type name, e.g. `[I` into `int[]`. */
+        static std::string java_type_name(std::string_view signature, std::size_t& pos) {
+            std::size_t dimensions = 0;
+            while (signature[pos] == '[') {
+                ++dimensions;
+                ++pos;
+            }
+            std::string name;
+            switch (signature[pos]) {
+                case 'Z': name = "boolean"; break;
+                case 'B': name = "byte"; break;
+                case 'C': name = "char"; break;
+                case 'S': name = "short"; break;
+                case 'I': name = "int"; break;
+                case 'J': name = "long"; break;
+                case 'F': name = "float"; break;
+                case 'D': name = "double"; break;
+                case 'L': {
+                    std::size_t end = signature.find(';', pos);
+                    name = signature.substr(pos + 1, end - pos - 1);
+                    std::replace(name.begin(), name.end(), '/', '.');
+                    pos = end;
+                    break;
                 }
-            });
-            return *this;
+            }
+            ++pos;
+            for (std::size_t k = 0; k < dimensions; ++k) {
+                name += "[]";
+            }
+            return name;
         }
+
+        std::map<std::string, Entry> _classes;
     };
 
     /**
-     * Prints all registered Java bindings.
+     * Writes the GraalVM native image JNI configuration for all registered bindings and the classes of the JDK
+     * that type converters use.
      */
-    inline void print_registered_bindings() {
-        JavaOutput output(this_thread.getEnv());
-        std::ostream& os = output.stream();
-
-        os
-            << "/** Represents a class that is instantiated in native code. */\n"
-            << "abstract class NativeObject : AutoCloseable {\n"
-            << "    /** Holds an opaque reference to an object that exists in the native code execution context. */\n"
-            << "    @Suppress(\"unused\") private val nativePointer: Long = 0\n"
-            << "}\n\n"
-        ;
+    inline void write_jni_config(std::ostream& os) {
+        JniConfig config;
+
+        // classes of the JDK that type converters, exception handling and logging use
+        constexpr std::string_view runtime_classes[] = {
+            "java/lang/Object", "java/lang/Class", "java/lang/ClassLoader", "java/lang/String", "java/lang/System",
+            "java/lang/Thread", "java/lang/Throwable", "java/lang/Exception", "java/lang/StackTraceElement",
+            "java/io/PrintStream",
+            "java/lang/Boolean", "java/lang/Byte", "java/lang/Character", "java/lang/Short",
+            "java/lang/Integer", "java/lang/Long", "java/lang/Float", "java/lang/Double",
+            "java/util/Iterator", "java/util/List", "java/util/ArrayList", "java/util/Set", "java/util/HashSet",
+            "java/util/TreeSet", "java/util/Map", "java/util/Map$Entry", "java/util/HashMap", "java/util/TreeMap",
+            "org/apache/logging/log4j/LogManager", "org/apache/logging/log4j/Logger",
+            "org/apache/logging/log4j/core/Logger",
+        };
+        for (auto&& class_name : runtime_classes) {
+            config.add_public_members(class_name);
+        }
+#if defined(KTBIND_ENABLE_STATISTICS)
+        config.add_public_members("com/kheiron/ktbind/SlowNativeCallEvent");
+#endif
 
-        for (auto&& [class_name, bindings] : FunctionBindings::value) {
-            std::string simple_class_name;
-            std::size_t found = class_name.rfind('/');
-            if (found != std::string::npos) {
-                simple_class_name = class_name.substr(found + 1);
-            } else {
-                simple_class_name = class_name;
+        // results are instantiated with a value or an error, which is read from a private field
+        config.add_method("com/kheiron/ktbind/NativeResult$Success", "<init>", "(Ljava/lang/Object;)V");
+        config.add_field("com/kheiron/ktbind/NativeResult$Success", "value");
+        config.add_method("com/kheiron/ktbind/NativeResult$Failure", "<init>", "(Ljava/lang/Object;)V");
+        config.add_field("com/kheiron/ktbind/NativeResult$Failure", "error");
+
+        // native classes hold a pointer to the native object in the field of their base class
+        config.add_field("com/kheiron/ktbind/NativeObject", "nativePointer");
+        for (auto&& [class_name, natives] : FunctionBindings::natives) {
+            config.add_allocated_class(class_name);
+            for (auto&& native : natives) {
+                config.add_method(class_name, native.name, native.signature);
+                config.add_referenced_classes(native.signature);
             }
-
-            // class definition
-            os
-                << "class " << simple_class_name << " private constructor() : NativeObject() {\n"
-            ;
-
-            // instance methods
-            for (auto&& binding : bindings) {
-                if (binding.is_member) {
-                    os << "    external fun " << binding.name << binding.friendly_signature << "\n";
-                }
+        }
+        for (auto&& [class_name, natives] : ObjectBindings::natives) {
+            for (auto&& native : natives) {
+                config.add_method(class_name, native.name, native.signature);
+                config.add_referenced_classes(native.signature);
             }
+        }
+        for (auto&& native : LogObject::natives()) {
+            config.add_method(LogObject::class_name, native.name, native.signature);
+        }
 
-            // companion object methods
-            os << "    companion object {\n";
+        // data classes are instantiated with `AllocObject`, and populated field by field
+        for (auto&& [class_name, bindings] : FieldBindings::value) {
+            std::string_view name = data_class_name(class_name);
+            config.add_allocated_class(name);
+            config.add_field(name, schema_field_name);
             for (auto&& binding : bindings) {
-                if (!binding.is_member) {
-                    os << "        @JvmStatic external fun " << binding.name << binding.friendly_signature << "\n";
-                }
+                config.add_field(name, binding.name);
+                config.add_referenced_classes(binding.signature);
             }
+        }
 
-            // end of class definition
-            os
-                << "    }\n"
-                << "}\n";
+        // exception classes are instantiated with a message, and populated field by field
+        for (auto&& [type, mapping] : ExceptionMappings::value) {
+            config.add_method(mapping.class_name, "<init>", "(Ljava/lang/String;)V");
+            for (auto&& field : mapping.fields) {
+                config.add_field(mapping.class_name, field.name);
+                config.add_referenced_classes(field.signature);
+            }
         }
+
+        config.write(os);
     }
+#endif
 
     inline void throw_exception(JNIEnv* env, const std::string& reason) {
         if (env->ExceptionCheck()) {
             env->ExceptionClear();  // thrown by a previously failed Java call
         }
-        LocalClassRef exClass(env, "java/lang/Exception");
-        env->ThrowNew(exClass.ref(), reason.c_str());
+        env->ThrowNew(ExceptionClasses::get().exception, reason.c_str());
+    }
+}
+
+/**
+ * Registers the native methods of a Java class with [RegisterNatives].
+ */
+inline jint register_natives(JNIEnv* env, const java::LocalClassRef& cls, const std::vector<JNINativeMethod>& natives) {
+    return env->RegisterNatives(cls.ref(), natives.data(), static_cast<jint>(natives.size()));
+}
+
+/**
+ * Checks the schema hash a generated Kotlin data class carries against the fields bound in native code.
+ * Returns false if the hash does not match, or the class has been declared without a schema hash.
+ * Enabled with `KTBIND_SCHEMA_VALIDATION`, since looking up a missing constant raises (and clears) an exception.
+ */
+inline bool schema_matches(JNIEnv* env, const java::LocalClassRef& cls, const std::vector<java::FieldBinding>& bindings) {
+    jfieldID fld = env->GetStaticFieldID(cls.ref(), java::schema_field_name.data(), "J");
+    if (fld == nullptr) {
+        env->ExceptionClear();  // NoSuchFieldError
+        return false;
     }
+    return env->GetStaticLongField(cls.ref(), fld) == java::schema_hash(bindings);
 }
 
 /**
@@ -1979,11 +6577,66 @@ inline jint java_initialization_impl(JavaVM* vm, void (*initializer)()) {
     java::this_thread.setEnv(env);
 
     try {
-        // invoke user-defined function
+        // resolve classes used by exception translation, result conversion and standard output
+        ExceptionClasses::load(env);
+        ResultClasses::load(env);
+        SystemOut::load(env);
+
+        Log::load(env);
+
+        // register objects that expose built-in facilities, and invoke user-defined function
+        register_builtin_objects();
         initializer();
 
-        // register function bindings
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+        DowncallBindings::load();
+#endif
+
+        // resolve Java exception classes that native exceptions are translated into
+        try {
+            ExceptionMappings::load(env);
+        } catch (std::exception& ex) {
+            java::throw_exception(env, ex.what());
+            return JNI_ERR;
+        }
+
+        // resolve Kotlin function interfaces that callbacks are passed as
+        for (auto&& [class_name, natives] : FunctionBindings::natives) {
+            for (auto&& native : natives) {
+                CallbackClasses::load(env, native.signature);
+            }
+        }
+        for (auto&& [class_name, natives] : ObjectBindings::natives) {
+            for (auto&& native : natives) {
+                CallbackClasses::load(env, native.signature);
+            }
+        }
+
+        // assign meta-information to function adapters
+        std::size_t binding_count = 0;
         for (auto&& [class_name, bindings] : FunctionBindings::value) {
+            binding_count += bindings.size();
+        }
+        for (auto&& [class_name, bindings] : ObjectBindings::value) {
+            binding_count += bindings.size();
+        }
+        binding_count += LogObject::bindings().size();
+        CallSites::value.reserve(binding_count);
+        for (auto&& [class_name, bindings] : FunctionBindings::value) {
+            for (auto&& binding : bindings) {
+                CallSites::add(*binding.site, class_name, binding.name);
+            }
+        }
+        for (auto&& [class_name, bindings] : ObjectBindings::value) {
+            for (auto&& binding : bindings) {
+                CallSites::add(*binding.site, class_name, binding.name);
+            }
+        }
+        LogObject::load();
+
+#if !defined(KTBIND_LAZY_REGISTRATION)
+        // register function bindings with the method tables built when bindings were declared
+        for (auto&& [class_name, natives] : FunctionBindings::natives) {
             // find the native class; JNI_OnLoad is called from the correct class loader context for this to work
             LocalClassRef cls(env, class_name.data(), std::nothrow);
             if (cls.ref() == nullptr) {
@@ -1994,15 +6647,22 @@ inline jint java_initialization_impl(JavaVM* vm, void (*initializer)()) {
             }
 
             // register native methods of the class
-            std::vector<JNINativeMethod> functions;
-            std::transform(bindings.begin(), bindings.end(), std::back_inserter(functions), [](auto&& binding) -> JNINativeMethod {
-                return {
-                    const_cast<char*>(binding.name.data()),
-                    const_cast<char*>(binding.signature.data()),
-                    binding.function_entry_point
-                };
-            });
-            jint rc = env->RegisterNatives(cls.ref(), functions.data(), functions.size());
+            jint rc = register_natives(env, cls, natives);
+            if (rc != JNI_OK) {
+                return rc;
+            }
+        }
+#endif
+
+        // register function bindings of objects, skipping objects not declared in Kotlin
+        for (auto&& [class_name, natives] : ObjectBindings::natives) {
+            LocalClassRef cls(env, class_name.data(), std::nothrow);
+            if (cls.ref() == nullptr) {
+                env->ExceptionClear();  // NoClassDefFoundError
+                continue;
+            }
+
+            jint rc = register_natives(env, cls, natives);
             if (rc != JNI_OK) {
                 return rc;
             }
@@ -2012,7 +6672,8 @@ inline jint java_initialization_impl(JavaVM* vm, void (*initializer)()) {
             return JNI_ERR;
         }
 
-        // check property bindings
+#if !defined(KTBIND_DEFER_FIELD_VALIDATION) && !defined(KTBIND_LAZY_REGISTRATION)
+        // check property bindings; when deferred, a missing field is reported when a data class is first marshaled
         for (auto&& [class_name, bindings] : FieldBindings::value) {
             // find the native class; JNI_OnLoad is called from the correct class loader context for this to work
             LocalClassRef cls(env, class_name.data(), std::nothrow);
@@ -2023,6 +6684,13 @@ inline jint java_initialization_impl(JavaVM* vm, void (*initializer)()) {
                 return JNI_ERR;
             }
 
+#if defined(KTBIND_SCHEMA_VALIDATION)
+            // a matching schema hash stands for looking up each field
+            if (schema_matches(env, cls, bindings)) {
+                continue;
+            }
+#endif
+
             // try to look up registered fields
             for (auto&& binding : bindings) {
                 jfieldID ref = env->GetFieldID(cls.ref(), binding.name.data(), binding.signature.data());
@@ -2036,6 +6704,7 @@ inline jint java_initialization_impl(JavaVM* vm, void (*initializer)()) {
                 return JNI_ERR;
             }
         }
+#endif
     } catch (std::exception& ex) {
         // ensure no native exception is propagated to Java
         return JNI_ERR;
@@ -2048,9 +6717,124 @@ inline jint java_initialization_impl(JavaVM* vm, void (*initializer)()) {
  * Implements the Java [JNI_OnUnload] termination routine.
  */
 inline void java_termination_impl(JavaVM* vm) {
+    JNIEnv* env;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        env = nullptr;
+    }
+
+    java::Log::unload(env);
+    if (env != nullptr) {
+#if defined(KTBIND_ENABLE_STATISTICS)
+        java::SlowCallEvents::unload(env);
+#endif
+        java::ResultCaches::unload(env);
+        java::ExceptionMappings::unload(env);
+        java::CallbackClasses::unload(env);
+        java::SystemOut::unload(env);
+        java::ResultClasses::unload(env);
+        java::ExceptionClasses::unload(env);
+    }
     java::Environment::unload(vm);
 }
 
+#if defined(KTBIND_STUB_GENERATOR)
+/**
+ * Writes the Kotlin declarations of all registered bindings, one file per Kotlin package.
+ * Takes the place of [JNI_OnLoad] when an extension module is compiled into a host executable with the macro
+ * `KTBIND_STUB_GENERATOR`; no Java virtual machine is involved.
+ * @param argv The output directory (e.g. `src/main/kotlin`), and optionally the file name (`Bindings.kt` by default).
+ * With `--jni-config <file>`, also writes the JNI configuration of GraalVM native image.
+ */
+inline int java_stub_generator_impl(int argc, char* argv[], void (*initializer)()) {
+    using namespace java;
+
+    std::vector<std::string_view> args;
+    std::string_view jni_config_path;
+    for (int k = 1; k < argc; ++k) {
+        if (std::string_view(argv[k]) == "--jni-config" && k + 1 < argc) {
+            jni_config_path = argv[++k];
+        } else {
+            args.push_back(argv[k]);
+        }
+    }
+    if (args.empty() && jni_config_path.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--jni-config <file>] [<output directory> [<file name>]]" << std::endl;
+        return 2;
+    }
+
+    register_builtin_objects();
+    initializer();
+
+    if (!jni_config_path.empty()) {
+        std::ofstream file{std::string(jni_config_path)};
+        write_jni_config(file);
+        if (!file) {
+            std::cerr << "error: cannot write " << jni_config_path << std::endl;
+            return 1;
+        }
+    }
+    if (args.empty()) {
+        return 0;
+    }
+    std::filesystem::path directory = args[0];
+    std::string file_name(args.size() > 1 ? args[1] : "Bindings.kt");
+
+    constexpr std::string_view base_package = "com.kheiron.ktbind";
+    std::map<std::string, std::ostringstream> files;
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+    write_downcall_lookup(files[std::string(base_package)]);
+#endif
+    for (auto&& [class_name, bindings] : FieldBindings::value) {
+        std::string_view name = data_class_name(class_name);
+        write_data_class(files[package_name(name)], name, bindings);
+    }
+    for (auto&& [class_name, bindings] : FunctionBindings::value) {
+        write_native_class(files[package_name(class_name)], class_name, bindings);
+    }
+    for (auto&& [class_name, bindings] : ObjectBindings::value) {
+        // built-in objects are declared once, in the Kotlin sources of the interoperability framework
+        if (!ObjectBindings::is_builtin(class_name)) {
+            write_native_object(files[package_name(class_name)], class_name, bindings);
+        }
+    }
+    for (auto&& [type, mapping] : ExceptionMappings::value) {
+        write_exception_class(files[package_name(mapping.class_name)], mapping);
+    }
+
+    try {
+        for (auto&& [package, declarations] : files) {
+            std::filesystem::path path = directory;
+            std::string_view remaining = package;
+            while (!remaining.empty()) {
+                std::size_t found = remaining.find('.');
+                path /= std::string(remaining.substr(0, found));
+                remaining = found != std::string_view::npos ? remaining.substr(found + 1) : std::string_view();
+            }
+            std::filesystem::create_directories(path);
+            path /= file_name;
+
+            std::ofstream file(path);
+            file << "// Generated by ktbind from the bindings of a native module; do not edit.\n";
+            if (!package.empty()) {
+                file << "package " << package << "\n";
+            }
+            if (package != base_package) {
+                file << "\nimport com.kheiron.ktbind.NativeObject\n";
+            }
+            file << "\n" << declarations.str();
+            if (!file) {
+                std::cerr << "error: cannot write " << path << std::endl;
+                return 1;
+            }
+        }
+    } catch (std::exception& ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
 /**
  * Establishes a mapping between a composite native type and a Java data class.
  * This object serves as a means to marshal data between Java and native, and is passed by value.
@@ -2077,6 +6861,15 @@ inline void java_termination_impl(JavaVM* vm) {
         }; \
     }
 
+#if defined(KTBIND_STUB_GENERATOR)
+/**
+ * Compiles the extension module into a host executable that writes Kotlin declarations of its bindings.
+ */
+#define JAVA_EXTENSION_MODULE() \
+    static void java_bindings_initializer(); \
+    int main(int argc, char* argv[]) { return java_stub_generator_impl(argc, argv, java_bindings_initializer); } \
+    void java_bindings_initializer()
+#else
 /**
  * Registers the library with Java, and binds user-defined native functions to Java instance and class methods.
  */
@@ -2084,6 +6877,28 @@ inline void java_termination_impl(JavaVM* vm) {
     static void java_bindings_initializer(); \
     JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved) { return java_initialization_impl(vm, java_bindings_initializer); } \
     JNIEXPORT void JNI_OnUnload(JavaVM *vm, void *reserved) { java_termination_impl(vm); } \
+    extern "C" JNIEXPORT void JNICALL Java_com_kheiron_ktbind_KtBindLog_bind(JNIEnv* env, jclass cls) { ::java::LogObject::register_class(env, cls); } \
+    KTBIND_DOWNCALL_EXPORTS \
     void java_bindings_initializer()
+#endif
+
+#if defined(KTBIND_ENABLE_DOWNCALLS)
+/**
+ * Exposes the addresses of functions bound for downcalls, looked up by the generated Kotlin object `Downcalls`.
+ */
+#define KTBIND_DOWNCALL_EXPORTS \
+    extern "C" JNIEXPORT std::int64_t ktbind_downcall_count() { return static_cast<std::int64_t>(::java::DowncallBindings::exports.size()); } \
+    extern "C" JNIEXPORT const char* ktbind_downcall_key(std::int64_t index) { return ::java::DowncallBindings::exports[index].first.c_str(); } \
+    extern "C" JNIEXPORT void* ktbind_downcall_address(std::int64_t index) { return ::java::DowncallBindings::exports[index].second; }
+#else
+#define KTBIND_DOWNCALL_EXPORTS
+#endif
 
 #define JAVA_OUTPUT ::java::JavaOutput(::java::this_thread.getEnv()).stream()
+
+/**
+ * Queues a message for the Java logging framework, e.g. `JAVA_LOG(debug) << "value: " << value;`.
+ * The message is not formatted if the level is below the threshold set with `java::Log::set_level`.
+ */
+#define JAVA_LOG(level) \
+    if (!::java::Log::enabled(::java::LogLevel::level)) {} else ::java::LogMessage(::java::LogLevel::level).stream()
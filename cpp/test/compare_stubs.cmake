@@ -0,0 +1,22 @@
+# Runs a stub generator, and compares the Kotlin declarations it writes with a checked-in copy.
+# Invoked with cmake -DGENERATOR=<executable> -DOUTPUT_DIR=<directory> -DEXPECTED_DIR=<directory> -P compare_stubs.cmake
+file(REMOVE_RECURSE ${OUTPUT_DIR})
+execute_process(COMMAND ${GENERATOR} ${OUTPUT_DIR} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${GENERATOR} failed with exit code ${result}")
+endif()
+
+file(GLOB_RECURSE expected_files RELATIVE ${EXPECTED_DIR} ${EXPECTED_DIR}/*)
+file(GLOB_RECURSE generated_files RELATIVE ${OUTPUT_DIR} ${OUTPUT_DIR}/*)
+if(NOT expected_files STREQUAL generated_files)
+    message(FATAL_ERROR "Generated files (${generated_files}) differ from expected files (${expected_files})")
+endif()
+foreach(name ${expected_files})
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files ${EXPECTED_DIR}/${name} ${OUTPUT_DIR}/${name}
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Generated ${name} differs from the checked-in copy in ${EXPECTED_DIR}")
+    endif()
+endforeach()
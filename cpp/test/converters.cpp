@@ -0,0 +1,772 @@
+/**
+ * Unit tests of type converters and function adapters, executed against the fake JNI environment in test/fakejni
+ * instead of a Java virtual machine.
+ */
+#include "ktbind/ktbind.hpp"
+#include "fakejni.hpp"
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <typeindex>
+
+struct Point {
+    int x = 0;
+    double y = 0.0;
+    std::string label;
+};
+
+struct Counter {
+    Counter() = default;
+    Counter(int start) : value(start) {}
+
+    int increment(int step) {
+        if (step < 0) {
+            throw std::invalid_argument("step must not be negative");
+        }
+        return value += step;
+    }
+
+    int get() const noexcept {
+        return value;
+    }
+
+    Point snapshot() const {
+        ++snapshots;
+        return { value, 0.5 * value, "counter" };
+    }
+
+    int value = 0;
+    mutable int snapshots = 0;
+};
+
+struct ValidationError : std::invalid_argument {
+    ValidationError(const char* message, int code) : std::invalid_argument(message), code(code) {}
+    int code;
+};
+
+struct RangeError : ValidationError {
+    RangeError(const char* message, int code, double limit) : ValidationError(message, code), limit(limit) {}
+    double limit;
+};
+
+void validate(int value) {
+    if (value < 0) {
+        throw RangeError("value must not be negative", 2, 0.0);
+    } else if (value % 2 != 0) {
+        throw ValidationError("value must be even", 1);
+    } else if (value > 100) {
+        throw std::runtime_error("value too large");
+    }
+}
+
+java::result<int, std::string> parse(std::string str) {
+    if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) {
+        return java::result<int, std::string>::failure("not a number: " + str);
+    }
+    return java::result<int, std::string>::success(std::stoi(str));
+}
+
+DECLARE_DATA_CLASS(Point, "com.kheiron.ktbind.test.Point")
+DECLARE_NATIVE_CLASS(Counter, "com.kheiron.ktbind.test.Counter")
+
+int apply_twice(std::function<int(int)> fn, int value) {
+    return fn(fn(value));
+}
+
+double scale(double value, int factor) noexcept {
+    return value * factor;
+}
+
+int describe_calls = 0;
+
+std::string describe(int value, const std::string& unit) {
+    ++describe_calls;
+    if (value < 0) {
+        throw std::invalid_argument("value must not be negative");
+    }
+    return std::to_string(value) + " " + unit;
+}
+
+int square_calls = 0;
+
+int square(int value) {
+    ++square_calls;
+    return value * value;
+}
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* expression, const char* file, int line) {
+        if (!condition) {
+            std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+            ++failures;
+        }
+    }
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+    /** Raised when a test looks up a native function that has not been registered. */
+    struct missing_function : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * Looks up a function registered with [RegisterNatives] as a typed function pointer.
+     * @param F The function type of the JNI entry point, e.g. `jint(JNIEnv*, jobject, jint)`.
+     */
+    template <typename F>
+    F* native_function(fakejni::FakeJvm& jvm, const char* class_name, const char* name, const char* signature) {
+        void* f = jvm.native_method(class_name, name, signature);
+        if (f == nullptr) {
+            throw missing_function(std::string("no native function ") + class_name + "." + name + signature);
+        }
+        return reinterpret_cast<F*>(f);
+    }
+
+    /** Converts a native value to Java and back, releasing the intermediate Java object. */
+    template <typename T>
+    T round_trip(JNIEnv* env, const T& value) {
+        java::LocalObjectRef obj(env, java::ArgType<T>::java_value(env, value));
+        using java_type = decltype(java::ArgType<T>::java_value(env, value));
+        return java::ArgType<T>::native_value(env, static_cast<java_type>(obj.ref()));
+    }
+
+    void test_strings(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        for (const std::string& str : {std::string(), std::string("ascii"), std::string("\xc3\xa1rv\xc3\xadzt\xc5\xb1r\xc5\x91 \xe2\x9c\x93")}) {
+            CHECK(round_trip(env, str) == str);
+        }
+    }
+
+    void test_primitive_arrays(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        CHECK(round_trip(env, std::vector<int>{1, -2, 3}) == (std::vector<int>{1, -2, 3}));
+        CHECK(round_trip(env, std::vector<long long>{1LL << 40, -1}) == (std::vector<long long>{1LL << 40, -1}));
+        CHECK(round_trip(env, std::vector<double>{0.5, -1.25}) == (std::vector<double>{0.5, -1.25}));
+        CHECK(round_trip(env, std::vector<char>{'a', 'b'}) == (std::vector<char>{'a', 'b'}));
+        CHECK(round_trip(env, std::vector<int>()).empty());
+    }
+
+    void test_collections(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+
+        // boxing counts as an allocation only outside the range of values that valueOf() returns from a cache
+        static_assert(!java::ArgType<int>::boxing_allocates(127) && java::ArgType<int>::boxing_allocates(128));
+        static_assert(!java::ArgType<long>::boxing_allocates(-128) && java::ArgType<long>::boxing_allocates(-129));
+        static_assert(!java::ArgType<bool>::boxing_allocates(JNI_TRUE));
+        static_assert(java::ArgType<double>::boxing_allocates(0.0));
+
+        std::vector<std::string> strings = {"one", "two", "three"};
+        CHECK(round_trip(env, strings) == strings);
+
+        std::list<int> ints = {3, 1, 2};
+        CHECK(round_trip(env, ints) == ints);
+
+        std::vector<std::vector<std::string>> nested = {{"a", "b"}, {}, {"c"}};
+        CHECK(round_trip(env, nested) == nested);
+
+        std::unordered_set<std::string> unordered_set = {"x", "y"};
+        CHECK(round_trip(env, unordered_set) == unordered_set);
+
+        std::set<int> ordered_set = {5, 3, 8};
+        CHECK(round_trip(env, ordered_set) == ordered_set);
+
+        std::unordered_map<std::string, int> unordered_map = {{"a", 1}, {"b", 2}};
+        CHECK(round_trip(env, unordered_map) == unordered_map);
+
+        std::map<int, std::string> ordered_map = {{1, "one"}, {2, "two"}};
+        CHECK(round_trip(env, ordered_map) == ordered_map);
+    }
+
+    void test_data_class(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        Point point;
+        point.x = 12;
+        point.y = 2.5;
+        point.label = "center";
+
+        Point result = round_trip(env, point);
+        CHECK(result.x == point.x);
+        CHECK(result.y == point.y);
+        CHECK(result.label == point.label);
+    }
+
+    void test_native_class(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        java::LocalObjectRef obj(env, java::ArgType<Counter>::java_value(env, Counter(7)));
+        Counter& counter = java::ArgType<Counter>::native_value(env, obj.ref());
+        CHECK(counter.value == 7);
+        delete &counter;
+    }
+
+    void test_callback(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+
+        // `Function1` is referenced by the binding `apply_twice`, and resolved when the library is loaded
+        CHECK(java::CallbackClasses::value[1].cls != nullptr);
+        CHECK(java::CallbackClasses::value[1].invoke != nullptr);
+        CHECK(java::CallbackClasses::value[2].cls == nullptr);
+
+        std::size_t global_refs = jvm.global_refs();
+        {
+            java::LocalClassRef cls(env, "com/kheiron/ktbind/test/Doubler");
+            java::LocalObjectRef lambda(env, env->AllocObject(cls.ref()));
+            std::function<int(int)> fn = java::ArgType<std::function<int(int)>>::native_value(env, lambda.ref());
+            CHECK(fn(21) == 42);
+            CHECK(jvm.global_refs() == global_refs + 1);
+        }
+        CHECK(jvm.global_refs() == global_refs);
+    }
+
+    void test_result(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        using int_result = java::result<int, std::string>;
+        int_result success = round_trip(env, int_result::success(42));
+        CHECK(success.has_value());
+        CHECK(success.value() == 42);
+        int_result failure = round_trip(env, int_result::failure("invalid"));
+        CHECK(!failure.has_value());
+        CHECK(failure.error() == "invalid");
+
+        // expected failures are returned without raising an exception
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+        auto parse = native_function<jobject(JNIEnv*, jclass, jstring)>(jvm, class_name, "parse", "(Ljava/lang/String;)Lcom/kheiron/ktbind/NativeResult;");
+        java::LocalClassRef cls(env, class_name);
+        java::LocalObjectRef input(env, java::ArgType<std::string>::java_value(env, "x1"));
+        java::LocalObjectRef output(env, parse(env, cls.ref(), static_cast<jstring>(input.ref())));
+        CHECK(!env->ExceptionCheck());
+        java::LocalClassRef failureClass(env, "com/kheiron/ktbind/NativeResult$Failure");
+        CHECK(env->IsInstanceOf(output.ref(), failureClass.ref()));
+        CHECK(java::ArgType<int_result>::native_value(env, output.ref()).error() == "not a number: x1");
+    }
+
+    void test_exceptions(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        java::LocalClassRef cls(env, "java/lang/IllegalStateException");
+        env->ThrowNew(cls.ref(), "invalid state");
+
+        // capturing the exception keeps a global reference, and does not fetch the message
+        std::size_t global_refs = jvm.global_refs();
+        std::size_t calls = jvm.calls();
+        auto ex = std::make_unique<java::JavaException>(env);
+        std::size_t capture_calls = jvm.calls() - calls;
+        CHECK(!env->ExceptionCheck());
+        CHECK(jvm.global_refs() == global_refs + 1);
+
+        // the message is fetched once, on the thread that first asks for it
+        std::string message;
+        calls = jvm.calls();
+        std::thread([&] { message = ex->what(); }).join();
+        CHECK(message == "invalid state");
+        CHECK(jvm.calls() - calls > capture_calls);
+        calls = jvm.calls();
+        CHECK(std::string(ex->what()) == "invalid state");
+        CHECK(jvm.calls() == calls);
+
+        // the global reference is released with the exception
+        ex.reset();
+        CHECK(jvm.global_refs() == global_refs);
+    }
+
+    void test_exception_mapping(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+        auto validate = native_function<void(JNIEnv*, jclass, jint)>(jvm, class_name, "validate", "(I)V");
+
+        /** Calls the function, and returns the class name and message of the Java exception raised. */
+        auto call = [&](int value) {
+            java::LocalClassRef cls(env, class_name);
+            validate(env, cls.ref(), value);
+            std::pair<std::string, std::string> result;
+            if (env->ExceptionCheck()) {
+                java::JavaException ex(env);
+                java::LocalClassRef exClass(env, ex.innerException());
+                java::LocalClassRef classClass(env, "java/lang/Class");
+                java::Method getName = classClass.getMethod("getName", "()Ljava/lang/String;");
+                java::LocalObjectRef name(env, env->CallObjectMethod(exClass.ref(), getName.ref()));
+                result = { java::ArgType<std::string>::native_value(env, static_cast<jstring>(name.ref())), ex.what() };
+                if (result.first == "com.kheiron.ktbind.test.RangeError") {
+                    java::Field limit = exClass.getField("limit", "D");
+                    CHECK(env->GetDoubleField(ex.innerException(), limit.ref()) == 0.0);
+                }
+                if (result.first != "java.lang.Exception") {
+                    java::Field code = exClass.getField("code", "I");
+                    CHECK(env->GetIntField(ex.innerException(), code.ref()) == (value < 0 ? 2 : 1));
+                }
+            }
+            return result;
+        };
+
+        // derived types are matched before their base types, regardless of registration order
+        CHECK(call(-1) == std::make_pair(std::string("com.kheiron.ktbind.test.RangeError"), std::string("value must not be negative")));
+        CHECK(call(1) == std::make_pair(std::string("com.kheiron.ktbind.test.ValidationError"), std::string("value must be even")));
+        CHECK(call(102) == std::make_pair(std::string("java.lang.Exception"), std::string("value too large")));
+        CHECK(call(2).first.empty());
+
+        // the generated Kotlin class of a mapping registered without a stack trace passes `writableStackTrace = false`
+        auto kotlin_class = [](const std::type_info& type) {
+            std::ostringstream os;
+            java::write_exception_class(os, java::ExceptionMappings::value.at(std::type_index(type)));
+            return os.str();
+        };
+        CHECK(kotlin_class(typeid(RangeError)).rfind("class RangeError(message: String) : Exception(message, null, false, false) {\n", 0) == 0);
+        CHECK(kotlin_class(typeid(ValidationError)).rfind("class ValidationError(message: String) : Exception(message) {\n", 0) == 0);
+    }
+
+    void test_adapters(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+
+        auto create = native_function<jobject(JNIEnv*, jclass, jint)>(jvm, class_name, "create", "(I)Lcom/kheiron/ktbind/test/Counter;");
+        auto increment = native_function<jint(JNIEnv*, jobject, jint)>(jvm, class_name, "increment", "(I)I");
+        auto close = native_function<void(JNIEnv*, jobject)>(jvm, class_name, "close", "()V");
+        auto twice = native_function<jint(JNIEnv*, jclass, jobject, jint)>(jvm, class_name, "apply_twice", "(Lkotlin/jvm/functions/Function1;I)I");
+
+        jclass cls = env->FindClass(class_name);
+        java::LocalObjectRef counter(env, create(env, cls, 10));
+        CHECK(increment(env, counter.ref(), 5) == 15);
+        CHECK(!env->ExceptionCheck());
+
+        // native exceptions are translated into Java exceptions
+        increment(env, counter.ref(), -1);
+        CHECK(env->ExceptionCheck());
+        if (env->ExceptionCheck()) {
+            java::JavaException ex(env);
+            CHECK(std::string(ex.what()) == "step must not be negative");
+        }
+        close(env, counter.ref());
+
+        java::LocalClassRef lambdaClass(env, "com/kheiron/ktbind/test/Doubler");
+        java::LocalObjectRef lambda(env, env->AllocObject(lambdaClass.ref()));
+        java::LocalClassRef counterClass(env, class_name);
+        CHECK(twice(env, counterClass.ref(), lambda.ref(), 3) == 12);
+    }
+
+    void test_fast_adapters(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+
+        // noexcept functions of fundamental types are bound with adapters without exception handlers
+        static_assert(java::is_fast_function<decltype(&Counter::get)>::value);
+        static_assert(java::is_fast_function<decltype(&scale)>::value);
+        static_assert(!java::is_fast_function<decltype(&Counter::increment)>::value);
+        static_assert(!java::is_fast_function<decltype(&apply_twice)>::value);
+
+        // instrumented builds use the regular adapters, whose observers may throw
+        static_assert(std::is_same_v<java::adapter_t<Counter, &scale, double, int>, java::FastAdapter<Counter, &scale, double, int>> == java::CallScope::is_null);
+        static_assert(std::is_same_v<java::adapter_t<Counter, &Counter::get>, java::FastMemberAdapter<Counter, &Counter::get>> == java::CallScope::is_null);
+
+        auto create = native_function<jobject(JNIEnv*, jclass, jint)>(jvm, class_name, "create", "(I)Lcom/kheiron/ktbind/test/Counter;");
+        auto get = native_function<jint(JNIEnv*, jobject)>(jvm, class_name, "get", "()I");
+        auto close = native_function<void(JNIEnv*, jobject)>(jvm, class_name, "close", "()V");
+        auto scale = native_function<jdouble(JNIEnv*, jclass, jdouble, jint)>(jvm, class_name, "scale", "(DI)D");
+
+        jclass cls = env->FindClass(class_name);
+        CHECK(scale(env, cls, 1.5, 4) == 6.0);
+
+        java::LocalObjectRef counter(env, create(env, cls, 10));
+        CHECK(get(env, counter.ref()) == 10);
+        close(env, counter.ref());
+
+        // calling a member function of a disposed object raises a Java exception
+        get(env, counter.ref());
+        CHECK(env->ExceptionCheck());
+        if (env->ExceptionCheck()) {
+            java::JavaException ex(env);
+            CHECK(std::string(ex.what()).find("already been disposed of") != std::string::npos);
+        }
+    }
+
+    void test_memoization(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+        auto describe = native_function<jstring(JNIEnv*, jclass, jint, jstring)>(jvm, class_name, "describe", "(ILjava/lang/String;)Ljava/lang/String;");
+        auto square = native_function<jint(JNIEnv*, jclass, jint)>(jvm, class_name, "square", "(I)I");
+
+        java::LocalClassRef cls(env, class_name);
+        java::LocalObjectRef unit(env, java::ArgType<std::string>::java_value(env, "kg"));
+        java::LocalObjectRef other_unit(env, java::ArgType<std::string>::java_value(env, "lb"));
+        jstring kg = static_cast<jstring>(unit.ref());
+        jstring lb = static_cast<jstring>(other_unit.ref());
+
+        // the function is invoked once per distinct argument list, and the Java string of the result is retained
+        std::size_t global_refs = jvm.global_refs();
+        java::LocalObjectRef first(env, describe(env, cls.ref(), 5, kg));
+        java::LocalObjectRef second(env, describe(env, cls.ref(), 5, kg));
+        CHECK(describe_calls == 1);
+        CHECK(jvm.global_refs() == global_refs + 1);
+        CHECK(java::ArgType<std::string>::native_value(env, static_cast<jstring>(second.ref())) == "5 kg");
+        CHECK(env->IsSameObject(first.ref(), second.ref()));
+
+        java::LocalObjectRef third(env, describe(env, cls.ref(), 5, lb));
+        CHECK(describe_calls == 2);
+        CHECK(java::ArgType<std::string>::native_value(env, static_cast<jstring>(third.ref())) == "5 lb");
+
+        // exceptions are not cached
+        for (int k = 0; k < 2; ++k) {
+            CHECK(describe(env, cls.ref(), -1, kg) == nullptr);
+            CHECK(env->ExceptionCheck());
+            env->ExceptionClear();
+        }
+        CHECK(describe_calls == 4);
+
+        // a small cache is a single list that keeps exactly N results, and evicts the least recently used one
+        auto describe_calls_for = [&](int value) {
+            int calls = describe_calls;
+            java::LocalObjectRef result(env, describe(env, cls.ref(), value, kg));
+            return describe_calls - calls;
+        };
+        for (int k = 0; k < 6; ++k) {
+            CHECK(describe_calls_for(100 + k) == 1);
+        }
+        CHECK(describe_calls_for(5) == 0);
+        CHECK(describe_calls_for(106) == 1);
+        CHECK(describe_calls_for(5) == 0);
+        CHECK(describe_calls_for(100) == 0);
+        CHECK(describe_calls_for(101) == 0);
+        CHECK(describe_calls_for(102) == 0);
+        java::LocalObjectRef evicted(env, describe(env, cls.ref(), 5, lb));
+        CHECK(describe_calls == 12);
+
+        // larger caches are split into shards whose capacities add up to N
+        using large_cache = java::MemoizationCache<std::tuple<int>, int, 100>;
+        std::size_t total = 0;
+        for (std::size_t k = 0; k < large_cache::shard_count; ++k) {
+            total += large_cache::shard_capacity(k);
+        }
+        CHECK(large_cache::shard_count == 16 && total == 100);
+
+        // the least recently used result is evicted when the cache is full
+        CHECK(square(env, cls.ref(), 3) == 9);
+        CHECK(square(env, cls.ref(), 3) == 9);
+        CHECK(square_calls == 1);
+        CHECK(square(env, cls.ref(), 4) == 16);
+        CHECK(square(env, cls.ref(), 3) == 9);
+        CHECK(square_calls == 3);
+    }
+
+    void test_versioned_results(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+        auto create = native_function<jobject(JNIEnv*, jclass, jint)>(jvm, class_name, "create", "(I)Lcom/kheiron/ktbind/test/Counter;");
+        auto increment = native_function<jint(JNIEnv*, jobject, jint)>(jvm, class_name, "increment", "(I)I");
+        auto snapshot = native_function<jobject(JNIEnv*, jobject)>(jvm, class_name, "snapshot", "()Lcom/kheiron/ktbind/test/Point;");
+        auto close = native_function<void(JNIEnv*, jobject)>(jvm, class_name, "close", "()V");
+
+        std::size_t global_refs = jvm.global_refs();
+        jclass cls = env->FindClass(class_name);
+        java::LocalObjectRef counter(env, create(env, cls, 10));
+        Counter* native_counter = java::NativePointer<Counter>::get(env, counter.ref());
+
+        // the Java object is reused while the version is unchanged
+        java::LocalObjectRef first(env, snapshot(env, counter.ref()));
+        java::LocalObjectRef second(env, snapshot(env, counter.ref()));
+        CHECK(native_counter->snapshots == 1);
+        CHECK(env->IsSameObject(first.ref(), second.ref()));
+        CHECK(java::ArgType<Point>::native_value(env, second.ref()).x == 10);
+
+        // a new object is returned when the version changes
+        CHECK(increment(env, counter.ref(), 5) == 15);
+        java::LocalObjectRef third(env, snapshot(env, counter.ref()));
+        CHECK(native_counter->snapshots == 2);
+        CHECK(!env->IsSameObject(first.ref(), third.ref()));
+        CHECK(java::ArgType<Point>::native_value(env, third.ref()).x == 15);
+
+        // retained objects are released when the native object is disposed of
+        close(env, counter.ref());
+        CHECK(jvm.global_refs() == global_refs);
+
+        // objects retained for live native objects are released when the library is unloaded
+        java::ResultCaches::unload(env);
+        global_refs = jvm.global_refs();
+        java::LocalObjectRef live(env, create(env, env->FindClass(class_name), 20));
+        java::LocalObjectRef live_snapshot(env, snapshot(env, live.ref()));
+        CHECK(jvm.global_refs() == global_refs + 1);
+        java::ResultCaches::unload(env);
+        CHECK(jvm.global_refs() == global_refs);
+        close(env, live.ref());
+    }
+
+    void test_call_sites(fakejni::FakeJvm& jvm) {
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+
+        // a function bound under two names registers one entry point, whose call site is found by either name
+        CHECK(jvm.native_method(class_name, "multiply", "(DI)D") == jvm.native_method(class_name, "scale", "(DI)D"));
+        const java::CallSite& site = java::CallSites::find("com.kheiron.ktbind.test.Counter.scale");
+        CHECK(&java::CallSites::find("com.kheiron.ktbind.test.Counter.multiply") == &site);
+        CHECK(site.qualified_name() == "com.kheiron.ktbind.test.Counter.scale");
+    }
+
+    /** A standard-layout class with padding between members. */
+    struct Reading {
+        bool valid;
+        double value;
+        std::int32_t sensor;
+        const std::int64_t timestamp;
+    };
+
+    void test_member_offsets(fakejni::FakeJvm&) {
+        // offsets of properties agree with `offsetof`
+        CHECK(java::member_offset(&Reading::valid) == offsetof(Reading, valid));
+        CHECK(java::member_offset(&Reading::value) == offsetof(Reading, value));
+        CHECK(java::member_offset(&Reading::sensor) == offsetof(Reading, sensor));
+        CHECK(java::member_offset(&Reading::timestamp) == offsetof(Reading, timestamp));
+    }
+
+    void test_log_registration(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        const char* class_name = "com/kheiron/ktbind/KtBindLog";
+
+        // loading the library leaves the object alone, its initializer registers the native methods
+        CHECK(jvm.native_method(class_name, "level", "()I") == nullptr);
+        java::LocalClassRef cls(env, class_name);
+        java::LogObject::register_class(env, cls.ref());
+        auto level = native_function<jint(JNIEnv*, jclass)>(jvm, class_name, "level", "()I");
+#if defined(KTBIND_ENABLE_STATISTICS)
+        // calls are counted against the method itself, not the first binding of the module
+        std::string first_binding = java::CallSites::value.front()->qualified_name();
+        std::int64_t first_calls = java::StatisticsObject::calls(first_binding);
+        std::int64_t level_calls = java::StatisticsObject::calls("com.kheiron.ktbind.KtBindLog.level");
+#endif
+        CHECK(level(env, cls.ref()) == static_cast<jint>(java::Log::level()));
+#if defined(KTBIND_ENABLE_STATISTICS)
+        CHECK(first_binding != "com.kheiron.ktbind.KtBindLog.level");
+        CHECK(java::StatisticsObject::calls(first_binding) == first_calls);
+        CHECK(java::StatisticsObject::calls("com.kheiron.ktbind.KtBindLog.level") == level_calls + 1);
+#endif
+    }
+
+#if defined(KTBIND_ENABLE_STATISTICS)
+    std::vector<std::string> slow_calls;
+
+    void test_slow_calls(fakejni::FakeJvm& jvm) {
+        JNIEnv* env = jvm.env();
+        const char* class_name = "com/kheiron/ktbind/test/Counter";
+        auto scale = native_function<jdouble(JNIEnv*, jclass, jdouble, jint)>(jvm, class_name, "scale", "(DI)D");
+
+        // every call is slower than a threshold of 1 ns, and is reported once the call has returned
+        java::SlowCallEvents::set_threshold(env, 1);
+        java::LocalClassRef cls(env, class_name);
+        CHECK(scale(env, cls.ref(), 2.0, 3) == 6.0);
+        java::SlowCallEvents::set_threshold(env, 0);
+        CHECK(scale(env, cls.ref(), 2.0, 3) == 6.0);
+        CHECK(slow_calls == std::vector<std::string>{"com.kheiron.ktbind.test.Counter.scale"});
+    }
+#endif
+
+#if defined(KTBIND_ENABLE_TRACING)
+    void test_trace_export(fakejni::FakeJvm&) {
+        java::Tracer::start(16);
+        java::Tracer::clear();
+
+        // snapshots taken while another thread overwrites its ring buffer contain only complete events
+        std::atomic<bool> done = false;
+        std::thread writer([&done] {
+            for (std::uint64_t k = 0; k < 100000; ++k) {
+                java::Tracer::record(java::TraceCategory::call, "com/kheiron/ktbind/test/Counter", "get", k, k + 1);
+            }
+            done = true;
+        });
+        while (!done) {
+            std::ostringstream os;
+            java::Tracer::write_json(os);
+        }
+        writer.join();
+
+        // names are escaped in the JSON document
+        java::Tracer::clear();
+        java::Tracer::record(java::TraceCategory::call, "com/kheiron/ktbind/test/Counter", "say \"hi\"\n", 1000, 3000);
+        java::Tracer::stop();
+        std::ostringstream os;
+        java::Tracer::write_json(os);
+        CHECK(os.str().find("\"name\":\"com.kheiron.ktbind.test.Counter.say \\\"hi\\\"\\u000a\"") != std::string::npos);
+        java::Tracer::clear();
+    }
+#endif
+
+    /** Declares the Java classes that the tests use. */
+    void define_classes(fakejni::FakeJvm& jvm) {
+        jvm.define_class("com/kheiron/ktbind/test/Point")
+            .field("x", "I")
+            .field("y", "D")
+            .field("label", "Ljava/lang/String;");
+
+        jvm.define_class("com/kheiron/ktbind/test/Counter")
+            .field("nativePointer", "J");
+
+        jvm.define_class("com/kheiron/ktbind/KtBindLog");
+
+        jvm.define_class("com/kheiron/ktbind/test/ValidationError", "java/lang/Exception")
+            .field("code", "I");
+        jvm.define_class("com/kheiron/ktbind/test/RangeError", "com/kheiron/ktbind/test/ValidationError")
+            .field("limit", "D");
+
+        // sealed class of results, with a subclass for the value and one for the error
+        jvm.define_class("com/kheiron/ktbind/NativeResult");
+        for (auto&& [name, field] : { std::make_pair("com/kheiron/ktbind/NativeResult$Success", "value"), std::make_pair("com/kheiron/ktbind/NativeResult$Failure", "error") }) {
+            const char* field_name = field;
+            jvm.define_class(name, "com/kheiron/ktbind/NativeResult")
+                .field(field_name, "Ljava/lang/Object;")
+                .method("<init>", "(Ljava/lang/Object;)V", [field_name](JNIEnv* env, jobject self, const jvalue* args) {
+                    jclass cls = env->GetObjectClass(self);
+                    env->SetObjectField(self, env->GetFieldID(cls, field_name, "Ljava/lang/Object;"), args[0].l);
+                    env->DeleteLocalRef(cls);
+                    return jvalue{};
+                });
+        }
+
+        // JDK Flight Recorder event of slow calls, which records the name of the binding
+        jvm.define_class("com/kheiron/ktbind/SlowNativeCallEvent")
+            .static_method("commit", "(Ljava/lang/String;JJJJJJJJJZ)V", [](JNIEnv* env, jobject, const jvalue* args) {
+#if defined(KTBIND_ENABLE_STATISTICS)
+                slow_calls.push_back(java::ArgType<std::string>::native_value(env, static_cast<jstring>(args[0].l)));
+#endif
+                return jvalue{};
+            });
+
+        // bootstrap object of lazy registration
+        jvm.define_class("com/kheiron/ktbind/KtBind");
+
+        // a Kotlin lambda of type (Int) -> Int that doubles its argument, called through the interface method
+        jvm.define_class("kotlin/jvm/functions/Function1")
+            .method("invoke", "(Ljava/lang/Object;)Ljava/lang/Object;", [](JNIEnv*, jobject, const jvalue*) {
+                return jvalue{};  // abstract, overridden in lambda classes
+            });
+        jvm.define_class("com/kheiron/ktbind/test/Doubler", "kotlin/jvm/functions/Function1")
+            .method("invoke", "(Ljava/lang/Object;)Ljava/lang/Object;", [](JNIEnv* env, jobject self, const jvalue* args) {
+                jint value = java::ArgType<int>::java_unbox(env, args[0].l);
+                jvalue result;
+                result.l = java::ArgType<int>::java_box(env, 2 * value);
+                return result;
+            });
+    }
+
+    void bindings() {
+        using namespace java;
+
+        native_class<Counter>()
+            .constructor<Counter(int)>("create")
+            .function<&Counter::increment>("increment")
+            .function<&Counter::get>("get")
+            .function<apply_twice>("apply_twice")
+            .function<scale>("scale")
+            .function<scale>("multiply")
+            .function<validate>("validate")
+            .function<parse>("parse")
+            .function<describe, memoize<8>>("describe")
+            .function<square, memoize<1>>("square")
+            .function<&Counter::snapshot, versioned<&Counter::value>>("snapshot")
+        ;
+
+        register_exception<ValidationError>("com.kheiron.ktbind.test.ValidationError")
+            .field<&ValidationError::code>("code")
+        ;
+        register_exception<RangeError>("com.kheiron.ktbind.test.RangeError")
+            .field<&RangeError::code>("code")
+            .field<&RangeError::limit>("limit")
+            .without_stack_trace()
+        ;
+
+        data_class<Point>()
+            .field<&Point::x>("x")
+            .field<&Point::y>("y")
+            .field<&Point::label>("label")
+        ;
+    }
+
+#if defined(KTBIND_LAZY_REGISTRATION)
+    /** Registers the native methods of a class, as the companion object of a native class would when initialized. */
+    bool register_lazily(fakejni::FakeJvm& jvm, const char* class_name) {
+        JNIEnv* env = jvm.env();
+        void (*register_class)(JNIEnv*, jclass, jclass);
+        try {
+            register_class = native_function<void(JNIEnv*, jclass, jclass)>(jvm, "com/kheiron/ktbind/KtBind", "register", "(Ljava/lang/Class;)V");
+        } catch (missing_function& ex) {
+            std::cerr << "exception: " << ex.what() << std::endl;
+            ++failures;
+            return false;
+        }
+
+        java::LocalClassRef bootstrap(env, "com/kheiron/ktbind/KtBind");
+        java::LocalClassRef cls(env, class_name);
+        register_class(env, bootstrap.ref(), cls.ref());
+        CHECK(!env->ExceptionCheck());
+        return !env->ExceptionCheck();
+    }
+#endif
+
+    using test_function = void (*)(fakejni::FakeJvm&);
+}
+
+int main() {
+    fakejni::FakeJvm jvm;
+    define_classes(jvm);
+    std::size_t global_refs = jvm.global_refs();
+
+    if (java_initialization_impl(jvm.vm(), bindings) != JNI_VERSION_1_6) {
+        std::cerr << "error: bindings failed to register" << std::endl;
+        return 1;
+    }
+
+#if defined(KTBIND_LAZY_REGISTRATION)
+    // no native methods are registered until the class is initialized
+    CHECK(jvm.native_method("com/kheiron/ktbind/test/Counter", "increment", "(I)I") == nullptr);
+    if (!register_lazily(jvm, "com/kheiron/ktbind/test/Counter")) {
+        return 1;
+    }
+#endif
+
+    const std::pair<const char*, test_function> tests[] = {
+        {"strings", test_strings},
+        {"primitive arrays", test_primitive_arrays},
+        {"collections", test_collections},
+        {"data class", test_data_class},
+        {"native class", test_native_class},
+        {"callback", test_callback},
+        {"result", test_result},
+        {"exceptions", test_exceptions},
+        {"adapters", test_adapters},
+        {"exception mapping", test_exception_mapping},
+        {"fast adapters", test_fast_adapters},
+        {"memoization", test_memoization},
+        {"versioned results", test_versioned_results},
+        {"call sites", test_call_sites},
+        {"member offsets", test_member_offsets},
+        {"log registration", test_log_registration},
+#if defined(KTBIND_ENABLE_STATISTICS)
+        {"slow calls", test_slow_calls},
+#endif
+#if defined(KTBIND_ENABLE_TRACING)
+        {"trace export", test_trace_export},
+#endif
+    };
+    for (auto&& [name, test] : tests) {
+        int previous_failures = failures;
+        std::size_t local_refs = jvm.local_refs();
+        std::size_t errors = jvm.errors().size();
+
+        try {
+            test(jvm);
+        } catch (std::exception& ex) {
+            std::cerr << "exception: " << ex.what() << std::endl;
+            ++failures;
+        }
+
+        CHECK(!jvm.env()->ExceptionCheck());
+        CHECK(jvm.local_refs() == local_refs);
+        for (std::size_t k = errors; k < jvm.errors().size(); ++k) {
+            std::cerr << "JNI misuse: " << jvm.errors()[k] << std::endl;
+            ++failures;
+        }
+        std::cout << (failures == previous_failures ? "passed: " : "FAILED: ") << name << std::endl;
+    }
+
+    // global references held by the library are released when it is unloaded
+    java_termination_impl(jvm.vm());
+    CHECK(jvm.global_refs() == global_refs);
+    return failures == 0 ? 0 : 1;
+}
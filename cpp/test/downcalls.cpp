@@ -0,0 +1,45 @@
+/**
+ * Extension module built with `KTBIND_ENABLE_DOWNCALLS`, which binds functions both as JNI native methods and for
+ * calls through the Foreign Function & Memory API. Loaded by test/downcalls_host.cpp, and compared with the Kotlin
+ * declarations in test/stubs_downcalls by its stub generator.
+ */
+#include "ktbind/ktbind.hpp"
+
+struct Calculator {};
+
+DECLARE_NATIVE_CLASS(Calculator, "com.kheiron.ktbind.test.Calculator")
+
+static int32_t add(int32_t a, int32_t b) noexcept {
+    return a + b;
+}
+
+static double scale(double value, int64_t factor) noexcept {
+    return value * static_cast<double>(factor);
+}
+
+static void reset() noexcept {}
+
+/** May throw, hence registered as a JNI native method. */
+static int32_t checked_add(int32_t a, int32_t b) {
+    if (b < 0) {
+        throw std::invalid_argument("b must not be negative");
+    }
+    return a + b;
+}
+
+/** Takes an object type, hence registered as a JNI native method. */
+static std::string describe(int32_t value) noexcept {
+    return std::to_string(value);
+}
+
+JAVA_EXTENSION_MODULE() {
+    using namespace java;
+
+    native_class<Calculator>()
+        .function<add>("add")
+        .function<scale>("scale")
+        .function<reset>("reset")
+        .function<checked_add>("checked_add")
+        .function<describe>("describe")
+    ;
+}
@@ -0,0 +1,100 @@
+/**
+ * Loads the extension module built from test/downcalls.cpp into the fake JNI environment, and checks the functions
+ * it registers with JNI and the table of functions it exports for downcalls.
+ * With `--instrumented`, the module is expected to be built with call statistics, which turn off downcalls.
+ */
+#include "fakejni.hpp"
+#include <dlfcn.h>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char* expression, const char* file, int line) {
+        if (!condition) {
+            std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+            ++failures;
+        }
+    }
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+    /** Looks up a function exported by the module, or returns null. */
+    template <typename F>
+    F* exported_function(void* module, const char* name) {
+        return reinterpret_cast<F*>(dlsym(module, name));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <extension module> [--instrumented]" << std::endl;
+        return 2;
+    }
+    bool instrumented = argc > 2 && std::string(argv[2]) == "--instrumented";
+
+    void* module = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (module == nullptr) {
+        std::cerr << "error: " << dlerror() << std::endl;
+        return 1;
+    }
+
+    // the entry points looked up by the JVM and by the generated Kotlin object `Downcalls`
+    auto on_load = exported_function<jint(JavaVM*, void*)>(module, "JNI_OnLoad");
+    auto on_unload = exported_function<void(JavaVM*, void*)>(module, "JNI_OnUnload");
+    auto count = exported_function<std::int64_t()>(module, "ktbind_downcall_count");
+    auto key = exported_function<const char*(std::int64_t)>(module, "ktbind_downcall_key");
+    auto address = exported_function<void*(std::int64_t)>(module, "ktbind_downcall_address");
+    CHECK(on_load != nullptr);
+    CHECK(on_unload != nullptr);
+    CHECK(count != nullptr);
+    CHECK(key != nullptr);
+    CHECK(address != nullptr);
+    if (on_load == nullptr || on_unload == nullptr || count == nullptr || key == nullptr || address == nullptr) {
+        return 1;
+    }
+
+    fakejni::FakeJvm jvm;
+    const char* class_name = "com/kheiron/ktbind/test/Calculator";
+    jvm.define_class(class_name).field("nativePointer", "J");
+    CHECK(on_load(jvm.vm(), nullptr) == JNI_VERSION_1_6);
+
+    // functions that take primitive types only and cannot throw are not registered with JNI, unless calls are
+    // instrumented, which downcalls would bypass
+    CHECK((jvm.native_method(class_name, "add", "(II)I") == nullptr) != instrumented);
+    CHECK((jvm.native_method(class_name, "scale", "(DJ)D") == nullptr) != instrumented);
+    CHECK((jvm.native_method(class_name, "reset", "()V") == nullptr) != instrumented);
+    CHECK(jvm.native_method(class_name, "checked_add", "(II)I") != nullptr);
+    CHECK(jvm.native_method(class_name, "describe", "(I)Ljava/lang/String;") != nullptr);
+
+    std::map<std::string, void*> exports;
+    for (std::int64_t k = 0; k < count(); ++k) {
+        exports[key(k)] = address(k);
+    }
+    if (instrumented) {
+        CHECK(exports.empty());
+        on_unload(jvm.vm(), nullptr);
+        dlclose(module);
+        std::cout << (failures == 0 ? "passed" : "FAILED") << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+    CHECK(exports.size() == 3);
+    auto add = reinterpret_cast<std::int32_t (*)(std::int32_t, std::int32_t)>(exports["com/kheiron/ktbind/test/Calculator.add(II)I"]);
+    auto scale = reinterpret_cast<double (*)(double, std::int64_t)>(exports["com/kheiron/ktbind/test/Calculator.scale(DJ)D"]);
+    CHECK(add != nullptr && add(2, 3) == 5);
+    CHECK(scale != nullptr && scale(1.5, 4) == 6.0);
+    CHECK(exports["com/kheiron/ktbind/test/Calculator.reset()V"] != nullptr);
+
+    on_unload(jvm.vm(), nullptr);
+    CHECK(jvm.errors().empty());
+    for (auto&& error : jvm.errors()) {
+        std::cerr << "JNI misuse: " << error << std::endl;
+    }
+    dlclose(module);
+
+    std::cout << (failures == 0 ? "passed" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,1424 @@
+#include "fakejni.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace fakejni {
+    struct Object;
+    using ObjectPtr = std::shared_ptr<Object>;
+
+    /**
+     * Meta-information shared by fields and methods.
+     */
+    struct Member {
+        std::string name;
+        std::string signature;
+        bool is_static = false;
+        Class* owner = nullptr;
+    };
+
+    struct MethodInfo : Member {
+        MethodImpl impl;
+    };
+
+    struct FieldInfo : Member {
+        /** Position of the field value in the object, for instance fields. */
+        std::size_t index = 0;
+        /** Value of the field, for class fields. */
+        jvalue static_value{};
+        ObjectPtr static_object;
+    };
+
+    struct Class {
+        State* state = nullptr;
+        std::string name;
+        Class* super = nullptr;
+        /** Signature of the primitive type wrapped by a boxed type, or the element type of a primitive array type. */
+        char primitive = 0;
+        std::list<MethodInfo> methods;
+        std::list<FieldInfo> fields;
+        std::map<std::string, void*> natives;
+        /** The java.lang.Class instance that represents this class. */
+        ObjectPtr mirror;
+    };
+
+    /**
+     * A Java object. A single structure represents all kinds of objects; each kind uses only some of the members.
+     */
+    struct Object {
+        Class* cls = nullptr;
+        /** Class described by a java.lang.Class instance. */
+        Class* mirrored = nullptr;
+        /** Contents of a java.lang.String, or the message of an exception. */
+        std::string text;
+        /** Value of a boxed primitive type. */
+        jvalue value{};
+        /** Contents of a primitive array. */
+        std::vector<unsigned char> data;
+        /** Elements of an object array, collection or iterator, or keys of a map. */
+        std::vector<ObjectPtr> items;
+        /** Values of a map. */
+        std::vector<ObjectPtr> values;
+        /** Position of set elements and map keys, looked up by value. */
+        std::unordered_map<std::string, std::size_t> index;
+        /** Position of an iterator. */
+        std::size_t position = 0;
+        /** Values of primitive and object instance fields. */
+        std::vector<jvalue> slots;
+        std::vector<ObjectPtr> refs;
+    };
+
+    /**
+     * A local, global or weak global reference to an object.
+     */
+    struct Ref {
+        ObjectPtr target;
+        jobjectRefType kind;
+    };
+
+    struct FakeEnv : JNIEnv {
+        State* state;
+    };
+
+    struct FakeVm : JavaVM {
+        State* state;
+    };
+
+    struct State {
+        JNINativeInterface_ functions{};
+        JNIInvokeInterface_ invoke_functions{};
+        FakeEnv env;
+        FakeVm vm;
+
+        std::map<std::string, std::unique_ptr<Class>, std::less<>> classes;
+        std::vector<std::unordered_set<Ref*>> frames;
+        std::unordered_set<Ref*> globals;
+        ObjectPtr pending;
+        std::size_t field_count = 0;
+        std::size_t calls = 0;
+        std::vector<std::string> errors;
+
+        ~State() {
+            for (auto&& frame : frames) {
+                for (Ref* ref : frame) {
+                    delete ref;
+                }
+            }
+            for (Ref* ref : globals) {
+                delete ref;
+            }
+        }
+    };
+
+    namespace {
+        State& state(JNIEnv* env) {
+            return *static_cast<FakeEnv*>(env)->state;
+        }
+
+        /** Registers a JNI function call, and checks that no exception is pending unless the function is safe to call. */
+        State& enter(JNIEnv* env, const char* function, bool exception_safe = false) {
+            State& s = state(env);
+            ++s.calls;
+            if (s.pending && !exception_safe) {
+                s.errors.push_back(std::string(function) + " called with an exception pending");
+            }
+            return s;
+        }
+
+        Object* deref(jobject obj) {
+            return obj != nullptr ? reinterpret_cast<Ref*>(obj)->target.get() : nullptr;
+        }
+
+        ObjectPtr share(jobject obj) {
+            return obj != nullptr ? reinterpret_cast<Ref*>(obj)->target : nullptr;
+        }
+
+        Class* class_of(jclass cls) {
+            Object* obj = deref(cls);
+            return obj != nullptr ? obj->mirrored : nullptr;
+        }
+
+        MethodInfo* method_of(jmethodID id) {
+            return reinterpret_cast<MethodInfo*>(id);
+        }
+
+        FieldInfo* field_of(jfieldID id) {
+            return reinterpret_cast<FieldInfo*>(id);
+        }
+
+        jobject new_local(State& s, ObjectPtr obj) {
+            if (!obj) {
+                return nullptr;
+            }
+            Ref* ref = new Ref{std::move(obj), JNILocalRefType};
+            s.frames.back().insert(ref);
+            return reinterpret_cast<jobject>(ref);
+        }
+
+        jobject new_global(State& s, ObjectPtr obj, jobjectRefType kind) {
+            if (!obj) {
+                return nullptr;
+            }
+            Ref* ref = new Ref{std::move(obj), kind};
+            s.globals.insert(ref);
+            return reinterpret_cast<jobject>(ref);
+        }
+
+        bool delete_local(State& s, jobject obj) {
+            Ref* ref = reinterpret_cast<Ref*>(obj);
+            for (auto it = s.frames.rbegin(); it != s.frames.rend(); ++it) {
+                if (it->erase(ref) > 0) {
+                    delete ref;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        ObjectPtr new_object(Class* cls) {
+            auto obj = std::make_shared<Object>();
+            obj->cls = cls;
+            return obj;
+        }
+
+        Class* find_class(State& s, std::string_view name) {
+            // accept type signatures of classes, e.g. `Ljava/lang/String;`
+            if (name.size() > 2 && name.front() == 'L' && name.back() == ';') {
+                name = name.substr(1, name.size() - 2);
+            }
+            auto it = s.classes.find(name);
+            return it != s.classes.end() ? it->second.get() : nullptr;
+        }
+
+        Class* define_class(State& s, const std::string& name, Class* super) {
+            auto&& entry = s.classes[name];
+            if (!entry) {
+                entry = std::make_unique<Class>();
+                entry->state = &s;
+                entry->name = name;
+                entry->super = super;
+                entry->mirror = new_object(find_class(s, "java/lang/Class"));
+                entry->mirror->mirrored = entry.get();
+            }
+            return entry.get();
+        }
+
+        /** The class that describes arrays of the given element type signature, e.g. `I` or `Ljava/lang/String;`. */
+        Class* array_class(State& s, const std::string& element_sig) {
+            Class* cls = define_class(s, "[" + element_sig, find_class(s, "java/lang/Object"));
+            if (element_sig.size() == 1) {
+                cls->primitive = element_sig[0];
+            }
+            return cls;
+        }
+
+        ObjectPtr new_string(State& s, std::string text) {
+            ObjectPtr str = new_object(find_class(s, "java/lang/String"));
+            str->text = std::move(text);
+            return str;
+        }
+
+        void throw_new(State& s, const char* class_name, std::string message) {
+            ObjectPtr ex = new_object(find_class(s, class_name));
+            ex->text = std::move(message);
+            s.pending = std::move(ex);
+        }
+
+        bool is_subclass(const Class* cls, const Class* base) {
+            for (; cls != nullptr; cls = cls->super) {
+                if (cls == base) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <typename M>
+        M* find_member(std::list<M> Class::* members, Class* cls, std::string_view name, std::string_view signature, bool is_static) {
+            for (; cls != nullptr; cls = cls->super) {
+                for (auto&& member : cls->*members) {
+                    if (member.is_static == is_static && member.name == name && member.signature == signature) {
+                        return &member;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        std::size_t primitive_size(char sig) {
+            switch (sig) {
+                case 'Z': return sizeof(jboolean);
+                case 'B': return sizeof(jbyte);
+                case 'C': return sizeof(jchar);
+                case 'S': return sizeof(jshort);
+                case 'I': return sizeof(jint);
+                case 'J': return sizeof(jlong);
+                case 'F': return sizeof(jfloat);
+                case 'D': return sizeof(jdouble);
+                default: return 0;
+            }
+        }
+
+        /** A key that identifies equal objects, used by sets and maps. */
+        std::string value_key(const Object* obj) {
+            if (obj == nullptr) {
+                return std::string();
+            }
+            if (obj->cls->name == "java/lang/String") {
+                return "s" + obj->text;
+            }
+            if (obj->cls->primitive != 0 && obj->cls->name[0] != '[') {
+                return obj->cls->name + ":" + std::string(reinterpret_cast<const char*>(&obj->value), primitive_size(obj->cls->primitive));
+            }
+            return "@" + std::to_string(reinterpret_cast<std::uintptr_t>(obj));
+        }
+
+        /** Extracts arguments passed as a variable argument list, as directed by the method signature. */
+        std::vector<jvalue> read_args(const std::string& signature, va_list args) {
+            std::vector<jvalue> values;
+            for (std::size_t i = 1; i < signature.size() && signature[i] != ')'; ++i) {
+                jvalue value{};
+                switch (signature[i]) {
+                    case 'Z': value.z = static_cast<jboolean>(va_arg(args, int)); break;
+                    case 'B': value.b = static_cast<jbyte>(va_arg(args, int)); break;
+                    case 'C': value.c = static_cast<jchar>(va_arg(args, int)); break;
+                    case 'S': value.s = static_cast<jshort>(va_arg(args, int)); break;
+                    case 'I': value.i = va_arg(args, jint); break;
+                    case 'J': value.j = va_arg(args, jlong); break;
+                    case 'F': value.f = static_cast<jfloat>(va_arg(args, double)); break;
+                    case 'D': value.d = va_arg(args, double); break;
+                    case '[':
+                        while (signature[i] == '[') {
+                            ++i;
+                        }
+                        if (signature[i] == 'L') {
+                            i = signature.find(';', i);
+                        }
+                        value.l = va_arg(args, jobject);
+                        break;
+                    case 'L':
+                        i = signature.find(';', i);
+                        value.l = va_arg(args, jobject);
+                        break;
+                }
+                values.push_back(value);
+            }
+            return values;
+        }
+
+        /** Calls a method, looking up an overriding method in the class of the object unless the call is non-virtual. */
+        jvalue invoke(JNIEnv* env, jobject self, MethodInfo* method, const jvalue* args, bool is_virtual) {
+            State& s = state(env);
+            if (self == nullptr || method == nullptr) {
+                throw_new(s, "java/lang/NullPointerException", method != nullptr ? method->name : std::string());
+                return jvalue{};
+            }
+            MethodInfo* target = method;
+            if (is_virtual) {
+                Class* cls = deref(self)->cls;
+                if (cls != method->owner) {
+                    if (MethodInfo* overriding = find_member(&Class::methods, cls, method->name, method->signature, false)) {
+                        target = overriding;
+                    }
+                }
+            }
+            if (!target->impl) {
+                throw_new(s, "java/lang/AbstractMethodError", target->owner->name + "." + target->name);
+                return jvalue{};
+            }
+            return target->impl(env, self, args);
+        }
+
+        jvalue invoke_v(JNIEnv* env, jobject self, jmethodID id, va_list args, bool is_virtual) {
+            MethodInfo* method = method_of(id);
+            std::vector<jvalue> values = method != nullptr ? read_args(method->signature, args) : std::vector<jvalue>();
+            return invoke(env, self, method, values.data(), is_virtual);
+        }
+
+        jvalue& slot(State& s, Object* obj, FieldInfo* field) {
+            if (obj->slots.size() <= field->index) {
+                obj->slots.resize(s.field_count);
+            }
+            return obj->slots[field->index];
+        }
+
+        ObjectPtr& ref_slot(State& s, Object* obj, FieldInfo* field) {
+            if (obj->refs.size() <= field->index) {
+                obj->refs.resize(s.field_count);
+            }
+            return obj->refs[field->index];
+        }
+
+        bool check_bounds(State& s, const Object* arr, jsize start, jsize len, std::size_t size) {
+            if (start < 0 || len < 0 || static_cast<std::size_t>(start) + static_cast<std::size_t>(len) > size) {
+                throw_new(s, "java/lang/ArrayIndexOutOfBoundsException", "Array region " + std::to_string(start) + ".." + std::to_string(start + len) + " out of bounds for length " + std::to_string(size));
+                return false;
+            }
+            return true;
+        }
+
+        jvalue object_result(JNIEnv* env, ObjectPtr obj) {
+            jvalue result{};
+            result.l = new_local(state(env), std::move(obj));
+            return result;
+        }
+
+        jvalue bool_result(bool value) {
+            jvalue result{};
+            result.z = value ? JNI_TRUE : JNI_FALSE;
+            return result;
+        }
+
+        jvalue int_result(std::size_t value) {
+            jvalue result{};
+            result.i = static_cast<jint>(value);
+            return result;
+        }
+
+        // general functions
+
+        jint JNICALL GetVersion(JNIEnv* env) {
+            enter(env, "GetVersion");
+            return JNI_VERSION_1_8;
+        }
+
+        jint JNICALL GetJavaVM(JNIEnv* env, JavaVM** vm) {
+            State& s = enter(env, "GetJavaVM");
+            *vm = &s.vm;
+            return JNI_OK;
+        }
+
+        void JNICALL FatalError(JNIEnv* env, const char* msg) {
+            std::cerr << "FATAL ERROR in native method: " << msg << std::endl;
+            std::abort();
+        }
+
+        // classes
+
+        jclass JNICALL FindClass(JNIEnv* env, const char* name) {
+            State& s = enter(env, "FindClass");
+            Class* cls = find_class(s, name);
+            if (cls == nullptr) {
+                throw_new(s, "java/lang/NoClassDefFoundError", name);
+                return nullptr;
+            }
+            return static_cast<jclass>(new_local(s, cls->mirror));
+        }
+
+        jclass JNICALL GetSuperclass(JNIEnv* env, jclass sub) {
+            State& s = enter(env, "GetSuperclass");
+            Class* cls = class_of(sub);
+            return cls != nullptr && cls->super != nullptr ? static_cast<jclass>(new_local(s, cls->super->mirror)) : nullptr;
+        }
+
+        jboolean JNICALL IsAssignableFrom(JNIEnv* env, jclass sub, jclass sup) {
+            enter(env, "IsAssignableFrom");
+            return is_subclass(class_of(sub), class_of(sup)) ? JNI_TRUE : JNI_FALSE;
+        }
+
+        jclass JNICALL GetObjectClass(JNIEnv* env, jobject obj) {
+            State& s = enter(env, "GetObjectClass");
+            Object* o = deref(obj);
+            if (o == nullptr) {
+                throw_new(s, "java/lang/NullPointerException", "GetObjectClass");
+                return nullptr;
+            }
+            return static_cast<jclass>(new_local(s, o->cls->mirror));
+        }
+
+        jboolean JNICALL IsInstanceOf(JNIEnv* env, jobject obj, jclass cls) {
+            enter(env, "IsInstanceOf");
+            Object* o = deref(obj);
+            return o == nullptr || is_subclass(o->cls, class_of(cls)) ? JNI_TRUE : JNI_FALSE;
+        }
+
+        jint JNICALL RegisterNatives(JNIEnv* env, jclass clazz, const JNINativeMethod* methods, jint count) {
+            enter(env, "RegisterNatives");
+            Class* cls = class_of(clazz);
+            for (jint k = 0; k < count; ++k) {
+                cls->natives[std::string(methods[k].name) + methods[k].signature] = methods[k].fnPtr;
+            }
+            return JNI_OK;
+        }
+
+        jint JNICALL UnregisterNatives(JNIEnv* env, jclass clazz) {
+            enter(env, "UnregisterNatives");
+            class_of(clazz)->natives.clear();
+            return JNI_OK;
+        }
+
+        // exceptions
+
+        jint JNICALL Throw(JNIEnv* env, jthrowable obj) {
+            State& s = state(env);
+            ++s.calls;
+            s.pending = share(obj);
+            return JNI_OK;
+        }
+
+        jint JNICALL ThrowNew(JNIEnv* env, jclass clazz, const char* msg) {
+            State& s = state(env);
+            ++s.calls;
+            ObjectPtr ex = new_object(class_of(clazz));
+            ex->text = msg != nullptr ? msg : "";
+            s.pending = std::move(ex);
+            return JNI_OK;
+        }
+
+        jthrowable JNICALL ExceptionOccurred(JNIEnv* env) {
+            State& s = enter(env, "ExceptionOccurred", true);
+            return static_cast<jthrowable>(new_local(s, s.pending));
+        }
+
+        void JNICALL ExceptionDescribe(JNIEnv* env) {
+            State& s = enter(env, "ExceptionDescribe", true);
+            if (s.pending) {
+                std::cerr << "Exception " << s.pending->cls->name << ": " << s.pending->text << std::endl;
+                s.pending.reset();
+            }
+        }
+
+        void JNICALL ExceptionClear(JNIEnv* env) {
+            State& s = enter(env, "ExceptionClear", true);
+            s.pending.reset();
+        }
+
+        jboolean JNICALL ExceptionCheck(JNIEnv* env) {
+            State& s = enter(env, "ExceptionCheck", true);
+            return s.pending ? JNI_TRUE : JNI_FALSE;
+        }
+
+        // references
+
+        jint JNICALL PushLocalFrame(JNIEnv* env, jint capacity) {
+            State& s = enter(env, "PushLocalFrame", true);
+            s.frames.emplace_back();
+            return JNI_OK;
+        }
+
+        jobject JNICALL PopLocalFrame(JNIEnv* env, jobject result) {
+            State& s = enter(env, "PopLocalFrame", true);
+            ObjectPtr keep = share(result);
+            if (s.frames.size() < 2) {
+                s.errors.push_back("PopLocalFrame called without a matching PushLocalFrame");
+                return new_local(s, std::move(keep));
+            }
+            for (Ref* ref : s.frames.back()) {
+                delete ref;
+            }
+            s.frames.pop_back();
+            return new_local(s, std::move(keep));
+        }
+
+        jint JNICALL EnsureLocalCapacity(JNIEnv* env, jint capacity) {
+            enter(env, "EnsureLocalCapacity");
+            return JNI_OK;
+        }
+
+        jobject JNICALL NewGlobalRef(JNIEnv* env, jobject obj) {
+            State& s = enter(env, "NewGlobalRef");
+            return new_global(s, share(obj), JNIGlobalRefType);
+        }
+
+        void JNICALL DeleteGlobalRef(JNIEnv* env, jobject obj) {
+            State& s = enter(env, "DeleteGlobalRef", true);
+            if (obj == nullptr) {
+                return;
+            }
+            Ref* ref = reinterpret_cast<Ref*>(obj);
+            if (s.globals.count(ref) == 0 || ref->kind != JNIGlobalRefType) {
+                s.errors.push_back("DeleteGlobalRef called with an invalid global reference");
+                return;
+            }
+            s.globals.erase(ref);
+            delete ref;
+        }
+
+        jweak JNICALL NewWeakGlobalRef(JNIEnv* env, jobject obj) {
+            State& s = enter(env, "NewWeakGlobalRef");
+            return new_global(s, share(obj), JNIWeakGlobalRefType);
+        }
+
+        void JNICALL DeleteWeakGlobalRef(JNIEnv* env, jweak obj) {
+            State& s = enter(env, "DeleteWeakGlobalRef", true);
+            if (obj == nullptr) {
+                return;
+            }
+            Ref* ref = reinterpret_cast<Ref*>(obj);
+            if (s.globals.count(ref) == 0 || ref->kind != JNIWeakGlobalRefType) {
+                s.errors.push_back("DeleteWeakGlobalRef called with an invalid weak global reference");
+                return;
+            }
+            s.globals.erase(ref);
+            delete ref;
+        }
+
+        jobject JNICALL NewLocalRef(JNIEnv* env, jobject obj) {
+            State& s = enter(env, "NewLocalRef");
+            return new_local(s, share(obj));
+        }
+
+        void JNICALL DeleteLocalRef(JNIEnv* env, jobject obj) {
+            State& s = enter(env, "DeleteLocalRef", true);
+            if (obj == nullptr) {
+                return;
+            }
+            if (!delete_local(s, obj)) {
+                s.errors.push_back("DeleteLocalRef called with an invalid local reference");
+            }
+        }
+
+        jboolean JNICALL IsSameObject(JNIEnv* env, jobject obj1, jobject obj2) {
+            enter(env, "IsSameObject");
+            return deref(obj1) == deref(obj2) ? JNI_TRUE : JNI_FALSE;
+        }
+
+        jobjectRefType JNICALL GetObjectRefType(JNIEnv* env, jobject obj) {
+            enter(env, "GetObjectRefType");
+            return obj != nullptr ? reinterpret_cast<Ref*>(obj)->kind : JNIInvalidRefType;
+        }
+
+        // objects
+
+        jobject JNICALL AllocObject(JNIEnv* env, jclass clazz) {
+            State& s = enter(env, "AllocObject");
+            Class* cls = class_of(clazz);
+            if (cls == nullptr) {
+                throw_new(s, "java/lang/NullPointerException", "AllocObject");
+                return nullptr;
+            }
+            return new_local(s, new_object(cls));
+        }
+
+        jobject new_object_a(JNIEnv* env, jclass clazz, jmethodID id, const jvalue* args) {
+            State& s = state(env);
+            jobject obj = new_local(s, new_object(class_of(clazz)));
+            invoke(env, obj, method_of(id), args, false);
+            if (s.pending) {
+                delete_local(s, obj);
+                return nullptr;
+            }
+            return obj;
+        }
+
+        jobject JNICALL NewObjectA(JNIEnv* env, jclass clazz, jmethodID id, const jvalue* args) {
+            enter(env, "NewObjectA");
+            return new_object_a(env, clazz, id, args);
+        }
+
+        jobject JNICALL NewObjectV(JNIEnv* env, jclass clazz, jmethodID id, va_list args) {
+            enter(env, "NewObjectV");
+            std::vector<jvalue> values = read_args(method_of(id)->signature, args);
+            return new_object_a(env, clazz, id, values.data());
+        }
+
+        jobject JNICALL NewObject(JNIEnv* env, jclass clazz, jmethodID id, ...) {
+            va_list args;
+            va_start(args, id);
+            jobject result = NewObjectV(env, clazz, id, args);
+            va_end(args);
+            return result;
+        }
+
+        // methods
+
+        jmethodID get_method_id(JNIEnv* env, jclass clazz, const char* name, const char* sig, bool is_static) {
+            State& s = state(env);
+            MethodInfo* method = find_member(&Class::methods, class_of(clazz), name, sig, is_static);
+            if (method == nullptr) {
+                throw_new(s, "java/lang/NoSuchMethodError", name);
+                return nullptr;
+            }
+            return reinterpret_cast<jmethodID>(method);
+        }
+
+        jmethodID JNICALL GetMethodID(JNIEnv* env, jclass clazz, const char* name, const char* sig) {
+            enter(env, "GetMethodID");
+            return get_method_id(env, clazz, name, sig, false);
+        }
+
+        jmethodID JNICALL GetStaticMethodID(JNIEnv* env, jclass clazz, const char* name, const char* sig) {
+            enter(env, "GetStaticMethodID");
+            return get_method_id(env, clazz, name, sig, true);
+        }
+
+#define FAKEJNI_CALL_METHODS(Type, type, member) \
+        type JNICALL Call##Type##MethodV(JNIEnv* env, jobject obj, jmethodID id, va_list args) { \
+            enter(env, "Call" #Type "MethodV"); \
+            return invoke_v(env, obj, id, args, true).member; \
+        } \
+        type JNICALL Call##Type##MethodA(JNIEnv* env, jobject obj, jmethodID id, const jvalue* args) { \
+            enter(env, "Call" #Type "MethodA"); \
+            return invoke(env, obj, method_of(id), args, true).member; \
+        } \
+        type JNICALL Call##Type##Method(JNIEnv* env, jobject obj, jmethodID id, ...) { \
+            va_list args; \
+            va_start(args, id); \
+            type result = Call##Type##MethodV(env, obj, id, args); \
+            va_end(args); \
+            return result; \
+        } \
+        type JNICALL CallNonvirtual##Type##MethodV(JNIEnv* env, jobject obj, jclass clazz, jmethodID id, va_list args) { \
+            enter(env, "CallNonvirtual" #Type "MethodV"); \
+            return invoke_v(env, obj, id, args, false).member; \
+        } \
+        type JNICALL CallNonvirtual##Type##MethodA(JNIEnv* env, jobject obj, jclass clazz, jmethodID id, const jvalue* args) { \
+            enter(env, "CallNonvirtual" #Type "MethodA"); \
+            return invoke(env, obj, method_of(id), args, false).member; \
+        } \
+        type JNICALL CallNonvirtual##Type##Method(JNIEnv* env, jobject obj, jclass clazz, jmethodID id, ...) { \
+            va_list args; \
+            va_start(args, id); \
+            type result = CallNonvirtual##Type##MethodV(env, obj, clazz, id, args); \
+            va_end(args); \
+            return result; \
+        } \
+        type JNICALL CallStatic##Type##MethodV(JNIEnv* env, jclass clazz, jmethodID id, va_list args) { \
+            enter(env, "CallStatic" #Type "MethodV"); \
+            return invoke_v(env, clazz, id, args, false).member; \
+        } \
+        type JNICALL CallStatic##Type##MethodA(JNIEnv* env, jclass clazz, jmethodID id, const jvalue* args) { \
+            enter(env, "CallStatic" #Type "MethodA"); \
+            return invoke(env, clazz, method_of(id), args, false).member; \
+        } \
+        type JNICALL CallStatic##Type##Method(JNIEnv* env, jclass clazz, jmethodID id, ...) { \
+            va_list args; \
+            va_start(args, id); \
+            type result = CallStatic##Type##MethodV(env, clazz, id, args); \
+            va_end(args); \
+            return result; \
+        }
+
+        FAKEJNI_CALL_METHODS(Object, jobject, l)
+        FAKEJNI_CALL_METHODS(Boolean, jboolean, z)
+        FAKEJNI_CALL_METHODS(Byte, jbyte, b)
+        FAKEJNI_CALL_METHODS(Char, jchar, c)
+        FAKEJNI_CALL_METHODS(Short, jshort, s)
+        FAKEJNI_CALL_METHODS(Int, jint, i)
+        FAKEJNI_CALL_METHODS(Long, jlong, j)
+        FAKEJNI_CALL_METHODS(Float, jfloat, f)
+        FAKEJNI_CALL_METHODS(Double, jdouble, d)
+
+#undef FAKEJNI_CALL_METHODS
+
+        void JNICALL CallVoidMethodV(JNIEnv* env, jobject obj, jmethodID id, va_list args) {
+            enter(env, "CallVoidMethodV");
+            invoke_v(env, obj, id, args, true);
+        }
+
+        void JNICALL CallVoidMethodA(JNIEnv* env, jobject obj, jmethodID id, const jvalue* args) {
+            enter(env, "CallVoidMethodA");
+            invoke(env, obj, method_of(id), args, true);
+        }
+
+        void JNICALL CallVoidMethod(JNIEnv* env, jobject obj, jmethodID id, ...) {
+            va_list args;
+            va_start(args, id);
+            CallVoidMethodV(env, obj, id, args);
+            va_end(args);
+        }
+
+        void JNICALL CallNonvirtualVoidMethodV(JNIEnv* env, jobject obj, jclass clazz, jmethodID id, va_list args) {
+            enter(env, "CallNonvirtualVoidMethodV");
+            invoke_v(env, obj, id, args, false);
+        }
+
+        void JNICALL CallNonvirtualVoidMethodA(JNIEnv* env, jobject obj, jclass clazz, jmethodID id, const jvalue* args) {
+            enter(env, "CallNonvirtualVoidMethodA");
+            invoke(env, obj, method_of(id), args, false);
+        }
+
+        void JNICALL CallNonvirtualVoidMethod(JNIEnv* env, jobject obj, jclass clazz, jmethodID id, ...) {
+            va_list args;
+            va_start(args, id);
+            CallNonvirtualVoidMethodV(env, obj, clazz, id, args);
+            va_end(args);
+        }
+
+        void JNICALL CallStaticVoidMethodV(JNIEnv* env, jclass clazz, jmethodID id, va_list args) {
+            enter(env, "CallStaticVoidMethodV");
+            invoke_v(env, clazz, id, args, false);
+        }
+
+        void JNICALL CallStaticVoidMethodA(JNIEnv* env, jclass clazz, jmethodID id, const jvalue* args) {
+            enter(env, "CallStaticVoidMethodA");
+            invoke(env, clazz, method_of(id), args, false);
+        }
+
+        void JNICALL CallStaticVoidMethod(JNIEnv* env, jclass clazz, jmethodID id, ...) {
+            va_list args;
+            va_start(args, id);
+            CallStaticVoidMethodV(env, clazz, id, args);
+            va_end(args);
+        }
+
+        // fields
+
+        jfieldID get_field_id(JNIEnv* env, jclass clazz, const char* name, const char* sig, bool is_static) {
+            State& s = state(env);
+            FieldInfo* field = find_member(&Class::fields, class_of(clazz), name, sig, is_static);
+            if (field == nullptr) {
+                throw_new(s, "java/lang/NoSuchFieldError", name);
+                return nullptr;
+            }
+            return reinterpret_cast<jfieldID>(field);
+        }
+
+        jfieldID JNICALL GetFieldID(JNIEnv* env, jclass clazz, const char* name, const char* sig) {
+            enter(env, "GetFieldID");
+            return get_field_id(env, clazz, name, sig, false);
+        }
+
+        jfieldID JNICALL GetStaticFieldID(JNIEnv* env, jclass clazz, const char* name, const char* sig) {
+            enter(env, "GetStaticFieldID");
+            return get_field_id(env, clazz, name, sig, true);
+        }
+
+        Object* field_target(State& s, jobject obj, const char* function) {
+            Object* o = deref(obj);
+            if (o == nullptr) {
+                throw_new(s, "java/lang/NullPointerException", function);
+            }
+            return o;
+        }
+
+        jobject JNICALL GetObjectField(JNIEnv* env, jobject obj, jfieldID id) {
+            State& s = enter(env, "GetObjectField");
+            Object* o = field_target(s, obj, "GetObjectField");
+            return o != nullptr ? new_local(s, ref_slot(s, o, field_of(id))) : nullptr;
+        }
+
+        void JNICALL SetObjectField(JNIEnv* env, jobject obj, jfieldID id, jobject value) {
+            State& s = enter(env, "SetObjectField");
+            if (Object* o = field_target(s, obj, "SetObjectField")) {
+                ref_slot(s, o, field_of(id)) = share(value);
+            }
+        }
+
+        jobject JNICALL GetStaticObjectField(JNIEnv* env, jclass clazz, jfieldID id) {
+            State& s = enter(env, "GetStaticObjectField");
+            return new_local(s, field_of(id)->static_object);
+        }
+
+        void JNICALL SetStaticObjectField(JNIEnv* env, jclass clazz, jfieldID id, jobject value) {
+            enter(env, "SetStaticObjectField");
+            field_of(id)->static_object = share(value);
+        }
+
+#define FAKEJNI_FIELD_ACCESSORS(Type, type, member) \
+        type JNICALL Get##Type##Field(JNIEnv* env, jobject obj, jfieldID id) { \
+            State& s = enter(env, "Get" #Type "Field"); \
+            Object* o = field_target(s, obj, "Get" #Type "Field"); \
+            return o != nullptr ? slot(s, o, field_of(id)).member : type(); \
+        } \
+        void JNICALL Set##Type##Field(JNIEnv* env, jobject obj, jfieldID id, type value) { \
+            State& s = enter(env, "Set" #Type "Field"); \
+            if (Object* o = field_target(s, obj, "Set" #Type "Field")) { \
+                slot(s, o, field_of(id)).member = value; \
+            } \
+        } \
+        type JNICALL GetStatic##Type##Field(JNIEnv* env, jclass clazz, jfieldID id) { \
+            enter(env, "GetStatic" #Type "Field"); \
+            return field_of(id)->static_value.member; \
+        } \
+        void JNICALL SetStatic##Type##Field(JNIEnv* env, jclass clazz, jfieldID id, type value) { \
+            enter(env, "SetStatic" #Type "Field"); \
+            field_of(id)->static_value.member = value; \
+        }
+
+        FAKEJNI_FIELD_ACCESSORS(Boolean, jboolean, z)
+        FAKEJNI_FIELD_ACCESSORS(Byte, jbyte, b)
+        FAKEJNI_FIELD_ACCESSORS(Char, jchar, c)
+        FAKEJNI_FIELD_ACCESSORS(Short, jshort, s)
+        FAKEJNI_FIELD_ACCESSORS(Int, jint, i)
+        FAKEJNI_FIELD_ACCESSORS(Long, jlong, j)
+        FAKEJNI_FIELD_ACCESSORS(Float, jfloat, f)
+        FAKEJNI_FIELD_ACCESSORS(Double, jdouble, d)
+
+#undef FAKEJNI_FIELD_ACCESSORS
+
+        // strings
+
+        jstring JNICALL NewStringUTF(JNIEnv* env, const char* utf) {
+            State& s = enter(env, "NewStringUTF");
+            if (utf == nullptr) {
+                return nullptr;
+            }
+            return static_cast<jstring>(new_local(s, new_string(s, utf)));
+        }
+
+        jsize JNICALL GetStringUTFLength(JNIEnv* env, jstring str) {
+            State& s = enter(env, "GetStringUTFLength");
+            Object* o = field_target(s, str, "GetStringUTFLength");
+            return o != nullptr ? static_cast<jsize>(o->text.size()) : 0;
+        }
+
+        jsize JNICALL GetStringLength(JNIEnv* env, jstring str) {
+            State& s = enter(env, "GetStringLength");
+            Object* o = field_target(s, str, "GetStringLength");
+            if (o == nullptr) {
+                return 0;
+            }
+
+            // count UTF-16 code units, which take two units for supplementary characters (4-byte UTF-8 sequences)
+            jsize len = 0;
+            for (unsigned char c : o->text) {
+                if ((c & 0xC0) != 0x80) {
+                    len += (c >= 0xF0) ? 2 : 1;
+                }
+            }
+            return len;
+        }
+
+        const char* JNICALL GetStringUTFChars(JNIEnv* env, jstring str, jboolean* isCopy) {
+            State& s = enter(env, "GetStringUTFChars");
+            Object* o = field_target(s, str, "GetStringUTFChars");
+            if (o == nullptr) {
+                return nullptr;
+            }
+            if (isCopy != nullptr) {
+                *isCopy = JNI_FALSE;
+            }
+            return o->text.c_str();
+        }
+
+        void JNICALL ReleaseStringUTFChars(JNIEnv* env, jstring str, const char* chars) {
+            enter(env, "ReleaseStringUTFChars", true);
+        }
+
+        // arrays
+
+        jsize JNICALL GetArrayLength(JNIEnv* env, jarray arr) {
+            State& s = enter(env, "GetArrayLength");
+            Object* o = field_target(s, arr, "GetArrayLength");
+            if (o == nullptr) {
+                return 0;
+            }
+            std::size_t size = o->cls->primitive != 0 ? o->data.size() / primitive_size(o->cls->primitive) : o->items.size();
+            return static_cast<jsize>(size);
+        }
+
+        jobjectArray JNICALL NewObjectArray(JNIEnv* env, jsize len, jclass clazz, jobject init) {
+            State& s = enter(env, "NewObjectArray");
+            if (len < 0) {
+                throw_new(s, "java/lang/NegativeArraySizeException", std::to_string(len));
+                return nullptr;
+            }
+            ObjectPtr arr = new_object(array_class(s, "L" + class_of(clazz)->name + ";"));
+            arr->items.assign(len, share(init));
+            return static_cast<jobjectArray>(new_local(s, std::move(arr)));
+        }
+
+        jobject JNICALL GetObjectArrayElement(JNIEnv* env, jobjectArray arr, jsize index) {
+            State& s = enter(env, "GetObjectArrayElement");
+            Object* o = field_target(s, arr, "GetObjectArrayElement");
+            if (o == nullptr || !check_bounds(s, o, index, 1, o->items.size())) {
+                return nullptr;
+            }
+            return new_local(s, o->items[index]);
+        }
+
+        void JNICALL SetObjectArrayElement(JNIEnv* env, jobjectArray arr, jsize index, jobject value) {
+            State& s = enter(env, "SetObjectArrayElement");
+            Object* o = field_target(s, arr, "SetObjectArrayElement");
+            if (o == nullptr || !check_bounds(s, o, index, 1, o->items.size())) {
+                return;
+            }
+            o->items[index] = share(value);
+        }
+
+#define FAKEJNI_ARRAY_FUNCTIONS(Type, type, sig) \
+        type##Array JNICALL New##Type##Array(JNIEnv* env, jsize len) { \
+            State& s = enter(env, "New" #Type "Array"); \
+            if (len < 0) { \
+                throw_new(s, "java/lang/NegativeArraySizeException", std::to_string(len)); \
+                return nullptr; \
+            } \
+            ObjectPtr arr = new_object(array_class(s, sig)); \
+            arr->data.resize(len * sizeof(type)); \
+            return static_cast<type##Array>(new_local(s, std::move(arr))); \
+        } \
+        void JNICALL Get##Type##ArrayRegion(JNIEnv* env, type##Array arr, jsize start, jsize len, type* buf) { \
+            State& s = enter(env, "Get" #Type "ArrayRegion"); \
+            Object* o = field_target(s, arr, "Get" #Type "ArrayRegion"); \
+            if (o == nullptr || !check_bounds(s, o, start, len, o->data.size() / sizeof(type))) { \
+                return; \
+            } \
+            if (len > 0) { \
+                std::memcpy(buf, o->data.data() + start * sizeof(type), len * sizeof(type)); \
+            } \
+        } \
+        void JNICALL Set##Type##ArrayRegion(JNIEnv* env, type##Array arr, jsize start, jsize len, const type* buf) { \
+            State& s = enter(env, "Set" #Type "ArrayRegion"); \
+            Object* o = field_target(s, arr, "Set" #Type "ArrayRegion"); \
+            if (o == nullptr || !check_bounds(s, o, start, len, o->data.size() / sizeof(type))) { \
+                return; \
+            } \
+            if (len > 0) { \
+                std::memcpy(o->data.data() + start * sizeof(type), buf, len * sizeof(type)); \
+            } \
+        }
+
+        FAKEJNI_ARRAY_FUNCTIONS(Boolean, jboolean, "Z")
+        FAKEJNI_ARRAY_FUNCTIONS(Byte, jbyte, "B")
+        FAKEJNI_ARRAY_FUNCTIONS(Char, jchar, "C")
+        FAKEJNI_ARRAY_FUNCTIONS(Short, jshort, "S")
+        FAKEJNI_ARRAY_FUNCTIONS(Int, jint, "I")
+        FAKEJNI_ARRAY_FUNCTIONS(Long, jlong, "J")
+        FAKEJNI_ARRAY_FUNCTIONS(Float, jfloat, "F")
+        FAKEJNI_ARRAY_FUNCTIONS(Double, jdouble, "D")
+
+#undef FAKEJNI_ARRAY_FUNCTIONS
+
+        // invocation interface
+
+        jint JNICALL DestroyJavaVM(JavaVM* vm) {
+            return JNI_OK;
+        }
+
+        jint JNICALL AttachCurrentThread(JavaVM* vm, void** penv, void* args) {
+            *penv = &static_cast<FakeVm*>(vm)->state->env;
+            return JNI_OK;
+        }
+
+        jint JNICALL DetachCurrentThread(JavaVM* vm) {
+            return JNI_OK;
+        }
+
+        jint JNICALL GetEnv(JavaVM* vm, void** penv, jint version) {
+            *penv = &static_cast<FakeVm*>(vm)->state->env;
+            return JNI_OK;
+        }
+
+        void init_functions(State& s) {
+            JNINativeInterface_& f = s.functions;
+            f.GetVersion = GetVersion;
+            f.GetJavaVM = GetJavaVM;
+            f.FatalError = FatalError;
+
+            f.FindClass = FindClass;
+            f.GetSuperclass = GetSuperclass;
+            f.IsAssignableFrom = IsAssignableFrom;
+            f.GetObjectClass = GetObjectClass;
+            f.IsInstanceOf = IsInstanceOf;
+            f.RegisterNatives = RegisterNatives;
+            f.UnregisterNatives = UnregisterNatives;
+
+            f.Throw = Throw;
+            f.ThrowNew = ThrowNew;
+            f.ExceptionOccurred = ExceptionOccurred;
+            f.ExceptionDescribe = ExceptionDescribe;
+            f.ExceptionClear = ExceptionClear;
+            f.ExceptionCheck = ExceptionCheck;
+
+            f.PushLocalFrame = PushLocalFrame;
+            f.PopLocalFrame = PopLocalFrame;
+            f.EnsureLocalCapacity = EnsureLocalCapacity;
+            f.NewGlobalRef = NewGlobalRef;
+            f.DeleteGlobalRef = DeleteGlobalRef;
+            f.NewWeakGlobalRef = NewWeakGlobalRef;
+            f.DeleteWeakGlobalRef = DeleteWeakGlobalRef;
+            f.NewLocalRef = NewLocalRef;
+            f.DeleteLocalRef = DeleteLocalRef;
+            f.IsSameObject = IsSameObject;
+            f.GetObjectRefType = GetObjectRefType;
+
+            f.AllocObject = AllocObject;
+            f.NewObject = NewObject;
+            f.NewObjectV = NewObjectV;
+            f.NewObjectA = NewObjectA;
+
+            f.GetMethodID = GetMethodID;
+            f.GetStaticMethodID = GetStaticMethodID;
+
+#define FAKEJNI_SET_CALL_METHODS(Type) \
+            f.Call##Type##Method = Call##Type##Method; \
+            f.Call##Type##MethodV = Call##Type##MethodV; \
+            f.Call##Type##MethodA = Call##Type##MethodA; \
+            f.CallNonvirtual##Type##Method = CallNonvirtual##Type##Method; \
+            f.CallNonvirtual##Type##MethodV = CallNonvirtual##Type##MethodV; \
+            f.CallNonvirtual##Type##MethodA = CallNonvirtual##Type##MethodA; \
+            f.CallStatic##Type##Method = CallStatic##Type##Method; \
+            f.CallStatic##Type##MethodV = CallStatic##Type##MethodV; \
+            f.CallStatic##Type##MethodA = CallStatic##Type##MethodA;
+
+            FAKEJNI_SET_CALL_METHODS(Object)
+            FAKEJNI_SET_CALL_METHODS(Boolean)
+            FAKEJNI_SET_CALL_METHODS(Byte)
+            FAKEJNI_SET_CALL_METHODS(Char)
+            FAKEJNI_SET_CALL_METHODS(Short)
+            FAKEJNI_SET_CALL_METHODS(Int)
+            FAKEJNI_SET_CALL_METHODS(Long)
+            FAKEJNI_SET_CALL_METHODS(Float)
+            FAKEJNI_SET_CALL_METHODS(Double)
+            FAKEJNI_SET_CALL_METHODS(Void)
+
+#undef FAKEJNI_SET_CALL_METHODS
+
+            f.GetFieldID = GetFieldID;
+            f.GetStaticFieldID = GetStaticFieldID;
+            f.GetObjectField = GetObjectField;
+            f.SetObjectField = SetObjectField;
+            f.GetStaticObjectField = GetStaticObjectField;
+            f.SetStaticObjectField = SetStaticObjectField;
+
+#define FAKEJNI_SET_FIELD_ACCESSORS(Type) \
+            f.Get##Type##Field = Get##Type##Field; \
+            f.Set##Type##Field = Set##Type##Field; \
+            f.GetStatic##Type##Field = GetStatic##Type##Field; \
+            f.SetStatic##Type##Field = SetStatic##Type##Field;
+
+            FAKEJNI_SET_FIELD_ACCESSORS(Boolean)
+            FAKEJNI_SET_FIELD_ACCESSORS(Byte)
+            FAKEJNI_SET_FIELD_ACCESSORS(Char)
+            FAKEJNI_SET_FIELD_ACCESSORS(Short)
+            FAKEJNI_SET_FIELD_ACCESSORS(Int)
+            FAKEJNI_SET_FIELD_ACCESSORS(Long)
+            FAKEJNI_SET_FIELD_ACCESSORS(Float)
+            FAKEJNI_SET_FIELD_ACCESSORS(Double)
+
+#undef FAKEJNI_SET_FIELD_ACCESSORS
+
+            f.NewStringUTF = NewStringUTF;
+            f.GetStringUTFLength = GetStringUTFLength;
+            f.GetStringLength = GetStringLength;
+            f.GetStringUTFChars = GetStringUTFChars;
+            f.ReleaseStringUTFChars = ReleaseStringUTFChars;
+
+            f.GetArrayLength = GetArrayLength;
+            f.NewObjectArray = NewObjectArray;
+            f.GetObjectArrayElement = GetObjectArrayElement;
+            f.SetObjectArrayElement = SetObjectArrayElement;
+
+#define FAKEJNI_SET_ARRAY_FUNCTIONS(Type) \
+            f.New##Type##Array = New##Type##Array; \
+            f.Get##Type##ArrayRegion = Get##Type##ArrayRegion; \
+            f.Set##Type##ArrayRegion = Set##Type##ArrayRegion;
+
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Boolean)
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Byte)
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Char)
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Short)
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Int)
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Long)
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Float)
+            FAKEJNI_SET_ARRAY_FUNCTIONS(Double)
+
+#undef FAKEJNI_SET_ARRAY_FUNCTIONS
+
+            JNIInvokeInterface_& i = s.invoke_functions;
+            i.DestroyJavaVM = DestroyJavaVM;
+            i.AttachCurrentThread = AttachCurrentThread;
+            i.AttachCurrentThreadAsDaemon = AttachCurrentThread;
+            i.DetachCurrentThread = DetachCurrentThread;
+            i.GetEnv = GetEnv;
+        }
+
+        // built-in classes
+
+        Class* builtin(State& s, const char* name, const char* super_name) {
+            return define_class(s, name, find_class(s, super_name));
+        }
+
+        void add_method(Class* cls, const char* name, const char* signature, bool is_static, MethodImpl impl) {
+            MethodInfo method;
+            method.name = name;
+            method.signature = signature;
+            method.is_static = is_static;
+            method.owner = cls;
+            method.impl = std::move(impl);
+            cls->methods.push_back(std::move(method));
+        }
+
+        void add_field(State& s, Class* cls, const char* name, const char* signature, bool is_static) {
+            FieldInfo field;
+            field.name = name;
+            field.signature = signature;
+            field.is_static = is_static;
+            field.owner = cls;
+            field.index = is_static ? 0 : s.field_count++;
+            cls->fields.push_back(std::move(field));
+        }
+
+        jvalue no_result(JNIEnv*, jobject, const jvalue*) {
+            return jvalue{};
+        }
+
+        /** Adds `valueOf` and e.g. `intValue` to a boxed primitive type. */
+        void define_boxed(State& s, const char* name, char sig, const char* primitive) {
+            Class* cls = builtin(s, name, "java/lang/Object");
+            cls->primitive = sig;
+            std::string type_sig(1, sig);
+            add_method(cls, "valueOf", ("(" + type_sig + ")L" + name + ";").c_str(), true, [cls](JNIEnv* env, jobject, const jvalue* args) {
+                ObjectPtr boxed = new_object(cls);
+                std::memcpy(&boxed->value, &args[0], primitive_size(cls->primitive));
+                return object_result(env, std::move(boxed));
+            });
+            add_method(cls, (std::string(primitive) + "Value").c_str(), ("()" + type_sig).c_str(), false, [](JNIEnv*, jobject self, const jvalue*) {
+                return deref(self)->value;
+            });
+        }
+
+        jvalue iterator_of(JNIEnv* env, jobject self) {
+            State& s = state(env);
+            ObjectPtr it = new_object(find_class(s, "java/util/Iterator"));
+            it->items = deref(self)->items;
+            return object_result(env, std::move(it));
+        }
+
+        void define_builtins(State& s) {
+            Class* object = define_class(s, "java/lang/Object", nullptr);
+            Class* meta = define_class(s, "java/lang/Class", object);
+            object->mirror->cls = meta;
+            meta->mirror->cls = meta;
+            add_method(meta, "getName", "()Ljava/lang/String;", false, [](JNIEnv* env, jobject self, const jvalue*) {
+                std::string name = deref(self)->mirrored->name;
+                std::replace(name.begin(), name.end(), '/', '.');
+                return object_result(env, new_string(state(env), std::move(name)));
+            });
+            builtin(s, "java/lang/String", "java/lang/Object");
+            builtin(s, "java/lang/ClassLoader", "java/lang/Object");
+
+            // a single thread with no context class loader
+            Class* thread = builtin(s, "java/lang/Thread", "java/lang/Object");
+            add_method(thread, "currentThread", "()Ljava/lang/Thread;", true, [thread = new_object(thread)](JNIEnv* env, jobject, const jvalue*) {
+                return object_result(env, thread);
+            });
+            add_method(thread, "getContextClassLoader", "()Ljava/lang/ClassLoader;", false, no_result);
+
+            // exceptions
+            Class* throwable = builtin(s, "java/lang/Throwable", "java/lang/Object");
+            add_method(throwable, "<init>", "()V", false, no_result);
+            add_method(throwable, "<init>", "(Ljava/lang/String;)V", false, [](JNIEnv*, jobject self, const jvalue* args) {
+                Object* message = deref(args[0].l);
+                deref(self)->text = message != nullptr ? message->text : std::string();
+                return jvalue{};
+            });
+            add_method(throwable, "getMessage", "()Ljava/lang/String;", false, [](JNIEnv* env, jobject self, const jvalue*) {
+                return object_result(env, new_string(state(env), deref(self)->text));
+            });
+            builtin(s, "java/lang/Exception", "java/lang/Throwable");
+            builtin(s, "java/lang/RuntimeException", "java/lang/Exception");
+            builtin(s, "java/lang/IllegalArgumentException", "java/lang/RuntimeException");
+            builtin(s, "java/lang/IllegalStateException", "java/lang/RuntimeException");
+            builtin(s, "java/lang/NullPointerException", "java/lang/RuntimeException");
+            builtin(s, "java/lang/NegativeArraySizeException", "java/lang/RuntimeException");
+            builtin(s, "java/lang/IndexOutOfBoundsException", "java/lang/RuntimeException");
+            builtin(s, "java/lang/ArrayIndexOutOfBoundsException", "java/lang/IndexOutOfBoundsException");
+            builtin(s, "java/util/NoSuchElementException", "java/lang/RuntimeException");
+            builtin(s, "java/lang/Error", "java/lang/Throwable");
+            builtin(s, "java/lang/LinkageError", "java/lang/Error");
+            builtin(s, "java/lang/NoClassDefFoundError", "java/lang/LinkageError");
+            builtin(s, "java/lang/IncompatibleClassChangeError", "java/lang/LinkageError");
+            builtin(s, "java/lang/AbstractMethodError", "java/lang/IncompatibleClassChangeError");
+            builtin(s, "java/lang/NoSuchMethodError", "java/lang/IncompatibleClassChangeError");
+            builtin(s, "java/lang/NoSuchFieldError", "java/lang/IncompatibleClassChangeError");
+
+            // boxed primitive types
+            define_boxed(s, "java/lang/Boolean", 'Z', "boolean");
+            define_boxed(s, "java/lang/Byte", 'B', "byte");
+            define_boxed(s, "java/lang/Character", 'C', "char");
+            define_boxed(s, "java/lang/Short", 'S', "short");
+            define_boxed(s, "java/lang/Integer", 'I', "int");
+            define_boxed(s, "java/lang/Long", 'J', "long");
+            define_boxed(s, "java/lang/Float", 'F', "float");
+            define_boxed(s, "java/lang/Double", 'D', "double");
+
+            // iterators
+            Class* iterator = builtin(s, "java/util/Iterator", "java/lang/Object");
+            add_method(iterator, "hasNext", "()Z", false, [](JNIEnv*, jobject self, const jvalue*) {
+                Object* it = deref(self);
+                return bool_result(it->position < it->items.size());
+            });
+            add_method(iterator, "next", "()Ljava/lang/Object;", false, [](JNIEnv* env, jobject self, const jvalue*) {
+                Object* it = deref(self);
+                if (it->position >= it->items.size()) {
+                    throw_new(state(env), "java/util/NoSuchElementException", std::string());
+                    return jvalue{};
+                }
+                return object_result(env, it->items[it->position++]);
+            });
+
+            // collections
+            Class* collection = builtin(s, "java/util/Collection", "java/lang/Object");
+            add_method(collection, "size", "()I", false, [](JNIEnv*, jobject self, const jvalue*) {
+                return int_result(deref(self)->items.size());
+            });
+            add_method(collection, "iterator", "()Ljava/util/Iterator;", false, [](JNIEnv* env, jobject self, const jvalue*) {
+                return iterator_of(env, self);
+            });
+
+            Class* list = builtin(s, "java/util/List", "java/util/Collection");
+            add_method(list, "add", "(Ljava/lang/Object;)Z", false, [](JNIEnv*, jobject self, const jvalue* args) {
+                deref(self)->items.push_back(share(args[0].l));
+                return bool_result(true);
+            });
+            add_method(list, "get", "(I)Ljava/lang/Object;", false, [](JNIEnv* env, jobject self, const jvalue* args) {
+                Object* l = deref(self);
+                jint index = args[0].i;
+                if (index < 0 || static_cast<std::size_t>(index) >= l->items.size()) {
+                    throw_new(state(env), "java/lang/IndexOutOfBoundsException", "Index " + std::to_string(index) + " out of bounds for length " + std::to_string(l->items.size()));
+                    return jvalue{};
+                }
+                return object_result(env, l->items[index]);
+            });
+            Class* array_list = builtin(s, "java/util/ArrayList", "java/util/List");
+            add_method(array_list, "<init>", "()V", false, no_result);
+            add_method(array_list, "<init>", "(I)V", false, no_result);
+
+            Class* set = builtin(s, "java/util/Set", "java/util/Collection");
+            add_method(set, "add", "(Ljava/lang/Object;)Z", false, [](JNIEnv*, jobject self, const jvalue* args) {
+                Object* st = deref(self);
+                auto&& [it, inserted] = st->index.emplace(value_key(deref(args[0].l)), st->items.size());
+                if (inserted) {
+                    st->items.push_back(share(args[0].l));
+                }
+                return bool_result(inserted);
+            });
+            add_method(set, "contains", "(Ljava/lang/Object;)Z", false, [](JNIEnv*, jobject self, const jvalue* args) {
+                Object* st = deref(self);
+                return bool_result(st->index.count(value_key(deref(args[0].l))) > 0);
+            });
+            // sets and maps keep insertion order; sorted variants do not sort their elements
+            for (const char* name : {"java/util/HashSet", "java/util/TreeSet"}) {
+                add_method(builtin(s, name, "java/util/Set"), "<init>", "()V", false, no_result);
+            }
+
+            // maps
+            Class* entry = builtin(s, "java/util/Map$Entry", "java/lang/Object");
+            add_method(entry, "getKey", "()Ljava/lang/Object;", false, [](JNIEnv* env, jobject self, const jvalue*) {
+                return object_result(env, deref(self)->items[0]);
+            });
+            add_method(entry, "getValue", "()Ljava/lang/Object;", false, [](JNIEnv* env, jobject self, const jvalue*) {
+                return object_result(env, deref(self)->values[0]);
+            });
+
+            Class* map = builtin(s, "java/util/Map", "java/lang/Object");
+            add_method(map, "size", "()I", false, [](JNIEnv*, jobject self, const jvalue*) {
+                return int_result(deref(self)->items.size());
+            });
+            add_method(map, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;", false, [](JNIEnv* env, jobject self, const jvalue* args) {
+                Object* m = deref(self);
+                auto&& [it, inserted] = m->index.emplace(value_key(deref(args[0].l)), m->items.size());
+                if (inserted) {
+                    m->items.push_back(share(args[0].l));
+                    m->values.push_back(share(args[1].l));
+                    return jvalue{};
+                }
+                ObjectPtr previous = std::exchange(m->values[it->second], share(args[1].l));
+                return object_result(env, std::move(previous));
+            });
+            add_method(map, "get", "(Ljava/lang/Object;)Ljava/lang/Object;", false, [](JNIEnv* env, jobject self, const jvalue* args) {
+                Object* m = deref(self);
+                auto it = m->index.find(value_key(deref(args[0].l)));
+                return it != m->index.end() ? object_result(env, m->values[it->second]) : jvalue{};
+            });
+            add_method(map, "entrySet", "()Ljava/util/Set;", false, [](JNIEnv* env, jobject self, const jvalue*) {
+                State& s = state(env);
+                Object* m = deref(self);
+                Class* entry_class = find_class(s, "java/util/Map$Entry");
+                ObjectPtr entries = new_object(find_class(s, "java/util/HashSet"));
+                for (std::size_t k = 0; k < m->items.size(); ++k) {
+                    ObjectPtr e = new_object(entry_class);
+                    e->items.push_back(m->items[k]);
+                    e->values.push_back(m->values[k]);
+                    entries->items.push_back(std::move(e));
+                }
+                return object_result(env, std::move(entries));
+            });
+            for (const char* name : {"java/util/HashMap", "java/util/TreeMap"}) {
+                Class* cls = builtin(s, name, "java/util/Map");
+                add_method(cls, "<init>", "()V", false, no_result);
+                add_method(cls, "<init>", "(I)V", false, no_result);
+            }
+        }
+    }
+
+    ClassBuilder& ClassBuilder::field(const char* name, const char* signature) {
+        add_field(*_cls->state, _cls, name, signature, false);
+        return *this;
+    }
+
+    ClassBuilder& ClassBuilder::static_field(const char* name, const char* signature) {
+        add_field(*_cls->state, _cls, name, signature, true);
+        return *this;
+    }
+
+    ClassBuilder& ClassBuilder::method(const char* name, const char* signature, MethodImpl impl) {
+        add_method(_cls, name, signature, false, std::move(impl));
+        return *this;
+    }
+
+    ClassBuilder& ClassBuilder::static_method(const char* name, const char* signature, MethodImpl impl) {
+        add_method(_cls, name, signature, true, std::move(impl));
+        return *this;
+    }
+
+    FakeJvm::FakeJvm() : _state(std::make_unique<State>()) {
+        State& s = *_state;
+        init_functions(s);
+        s.env.functions = &s.functions;
+        s.env.state = &s;
+        s.vm.functions = &s.invoke_functions;
+        s.vm.state = &s;
+        s.frames.emplace_back();
+        define_builtins(s);
+    }
+
+    FakeJvm::~FakeJvm() = default;
+
+    JavaVM* FakeJvm::vm() {
+        return &_state->vm;
+    }
+
+    JNIEnv* FakeJvm::env() {
+        return &_state->env;
+    }
+
+    ClassBuilder FakeJvm::define_class(const char* name, const char* super_name) {
+        Class* super = find_class(*_state, super_name);
+        if (super == nullptr) {
+            throw std::invalid_argument(std::string("Superclass '") + super_name + "' has not been declared");
+        }
+        return ClassBuilder(fakejni::define_class(*_state, name, super));
+    }
+
+    void* FakeJvm::native_method(const char* class_name, const char* name, const char* signature) const {
+        Class* cls = find_class(*_state, class_name);
+        if (cls == nullptr) {
+            return nullptr;
+        }
+        auto it = cls->natives.find(std::string(name) + signature);
+        return it != cls->natives.end() ? it->second : nullptr;
+    }
+
+    std::size_t FakeJvm::local_refs() const {
+        std::size_t count = 0;
+        for (auto&& frame : _state->frames) {
+            count += frame.size();
+        }
+        return count;
+    }
+
+    std::size_t FakeJvm::global_refs() const {
+        return _state->globals.size();
+    }
+
+    std::size_t FakeJvm::calls() const {
+        return _state->calls;
+    }
+
+    const std::vector<std::string>& FakeJvm::errors() const {
+        return _state->errors;
+    }
+}
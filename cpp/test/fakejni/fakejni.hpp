@@ -0,0 +1,92 @@
+#pragma once
+
+#include <jni.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * An in-memory implementation of the subset of the Java Native Interface that ktbind uses, for testing and
+ * benchmarking type converters and function adapters without a Java virtual machine.
+ *
+ * The fake emulates objects, strings, primitive and object arrays, boxed primitive types, fields, exceptions, and
+ * the collection classes `ArrayList`, `HashSet`, `TreeSet`, `HashMap` and `TreeMap` with their iterators. User-defined
+ * classes (e.g. data classes, native classes or Kotlin lambdas) are declared with [FakeJvm::define_class].
+ * The fake is single-threaded: every thread shares the same environment.
+ * JNI functions that ktbind does not use are left unimplemented (null).
+ */
+namespace fakejni {
+    struct State;
+    struct Class;
+
+    /**
+     * Implementation of a Java method in C++.
+     * Receives the object (or class for static methods) and the arguments as local references, and returns the
+     * result as a local reference (for object return types) or a primitive value.
+     */
+    using MethodImpl = std::function<jvalue(JNIEnv* env, jobject self, const jvalue* args)>;
+
+    /**
+     * Adds members to a class emulated by the fake.
+     */
+    class ClassBuilder {
+    public:
+        /** Declares an instance field, e.g. `field("nativePointer", "J")`. */
+        ClassBuilder& field(const char* name, const char* signature);
+
+        /** Declares a class (static) field. */
+        ClassBuilder& static_field(const char* name, const char* signature);
+
+        /** Declares an instance method with a C++ implementation. */
+        ClassBuilder& method(const char* name, const char* signature, MethodImpl impl);
+
+        /** Declares a class (static) method with a C++ implementation. */
+        ClassBuilder& static_method(const char* name, const char* signature, MethodImpl impl);
+
+    private:
+        explicit ClassBuilder(Class* cls) : _cls(cls) {}
+        friend class FakeJvm;
+
+        Class* _cls;
+    };
+
+    /**
+     * A Java virtual machine emulated in C++, with a single JNI environment.
+     */
+    class FakeJvm {
+    public:
+        FakeJvm();
+        ~FakeJvm();
+
+        FakeJvm(const FakeJvm&) = delete;
+        FakeJvm& operator=(const FakeJvm&) = delete;
+
+        JavaVM* vm();
+        JNIEnv* env();
+
+        /**
+         * Declares a class with the given binary name (e.g. `com/kheiron/ktbind/Sample`), or extends an existing class.
+         * @param super_name Binary name of the superclass, which must have been declared earlier.
+         */
+        ClassBuilder define_class(const char* name, const char* super_name = "java/lang/Object");
+
+        /** A function registered with [RegisterNatives], or null if no function has been registered. */
+        void* native_method(const char* class_name, const char* name, const char* signature) const;
+
+        /** Number of local references alive in all local reference frames. */
+        std::size_t local_refs() const;
+
+        /** Number of global references alive (including weak global references). */
+        std::size_t global_refs() const;
+
+        /** Number of JNI functions called since the environment was created. */
+        std::size_t calls() const;
+
+        /** Misuse of the JNI detected by the fake, e.g. deleting an invalid reference or calling a function with an exception pending. */
+        const std::vector<std::string>& errors() const;
+
+    private:
+        std::unique_ptr<State> _state;
+    };
+}
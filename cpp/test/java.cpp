@@ -115,10 +115,16 @@ struct Sample {
     void set_data();
     void set_data(const Data& data);
 
+    /** Incremented whenever the nested data changes. */
+    std::uint64_t version() const noexcept {
+        return _version;
+    }
+
 private:
     Sample(const Sample&) = default;  // ensure that external code cannot make copies
 
     Data _data;
+    std::uint64_t _version = 0;
 };
 
 Sample::Sample() {
@@ -149,14 +155,29 @@ Data Sample::get_data() const {
 
 void Sample::set_data() {
     _data = Data();
+    ++_version;
     JAVA_OUTPUT << "set nested data: " << _data << std::endl;
 }
 
 void Sample::set_data(const Data& data) {
     _data = data;
+    ++_version;
     JAVA_OUTPUT << "set nested data: " << _data << std::endl;
 }
 
+struct Point {
+    Point(double x, double y) : x(x), y(y) {}
+
+    double norm() const {
+        return std::sqrt(x * x + y * y);
+    }
+
+    double x;
+    double y;
+    int32_t visits = 0;
+    const bool fixed = true;
+};
+
 void returns_void() {}
 
 bool returns_bool() {
@@ -297,6 +318,22 @@ void raise_native_exception() {
     throw std::runtime_error("an expected error");
 }
 
+struct ValidationError : std::invalid_argument {
+    ValidationError(const std::string& message, int code) : std::invalid_argument(message), code(code) {}
+    int code;
+};
+
+void raise_validation_error(int code) {
+    throw ValidationError("invalid value", code);
+}
+
+java::result<int32_t, std::string> parse_number(std::string str) {
+    if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) {
+        return java::result<int32_t, std::string>::failure("not a number: " + str);
+    }
+    return java::result<int32_t, std::string>::success(std::stoi(str));
+}
+
 void catch_java_exception(std::function<void()> fun) {
     try {
         fun();
@@ -305,8 +342,34 @@ void catch_java_exception(std::function<void()> fun) {
     }
 }
 
+void log_messages(int count) {
+    for (int i = 0; i < count; ++i) {
+        JAVA_LOG(debug) << "debug message " << i;
+        JAVA_LOG(info) << "info message " << i;
+    }
+}
+
+std::atomic<int> feature_calls = 0;
+
+std::string extract_features(std::string text, int32_t window) {
+    ++feature_calls;
+    if (window <= 0) {
+        throw std::invalid_argument("window must be positive");
+    }
+    std::ostringstream os;
+    for (std::size_t k = 0; k + window <= text.size(); ++k) {
+        os << (k > 0 ? " " : "") << text.substr(k, window);
+    }
+    return os.str();
+}
+
+int32_t feature_call_count() {
+    return feature_calls;
+}
+
 DECLARE_DATA_CLASS(Data, "com.kheiron.ktbind.Data")
 DECLARE_NATIVE_CLASS(Sample, "com.kheiron.ktbind.Sample")
+DECLARE_NATIVE_CLASS(Point, "com.kheiron.ktbind.Point")
 
 JAVA_EXTENSION_MODULE() {
     using namespace java;
@@ -316,6 +379,7 @@ JAVA_EXTENSION_MODULE() {
         .constructor<Sample(std::string)>("create")
         .function<&Sample::duplicate>("duplicate")
         .function<&Sample::get_data>("get_data")
+        .function<&Sample::get_data, versioned<&Sample::version>>("poll_data")
         .function<static_cast<void(Sample::*)(const Data&)>(&Sample::set_data)>("set_data")
 
         // fundamental types and simple well-known types as return values
@@ -358,7 +422,30 @@ JAVA_EXTENSION_MODULE() {
 
         // exception handling
         .function<raise_native_exception>("raise_native_exception")
+        .function<raise_validation_error>("raise_validation_error")
+        .function<parse_number>("parse_number")
         .function<catch_java_exception>("catch_java_exception")
+
+        // memoization
+        .function<extract_features, memoize<64>>("extract_features")
+        .function<feature_call_count>("feature_call_count")
+
+        // logging
+        .function<log_messages>("log_messages")
+    ;
+
+    native_class<Point>()
+        .constructor<Point(double, double)>("create")
+        .function<&Point::norm>("norm")
+        .property<&Point::x>("x")
+        .property<&Point::y>("y")
+        .property<&Point::visits>("visits")
+        .property<&Point::fixed>("fixed")
+    ;
+
+    register_exception<ValidationError>("com.kheiron.ktbind.ValidationError")
+        .field<&ValidationError::code>("code")
+        .without_stack_trace()
     ;
 
     data_class<Data>()
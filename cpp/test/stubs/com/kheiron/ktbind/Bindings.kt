@@ -0,0 +1,94 @@
+// Generated by ktbind from the bindings of a native module; do not edit.
+package com.kheiron.ktbind
+
+data class Data(
+    val b: Boolean,
+    val s: Short,
+    val i: Int,
+    val l: Long,
+    val f: Float,
+    val d: Double,
+    val str: String,
+    val short_arr: ShortArray,
+    val int_arr: IntArray,
+    val long_arr: LongArray,
+    val map: Map<String, List<String>>
+) {
+    companion object {
+        /** Fingerprint of the fields bound in native code, checked when the library is loaded. */
+        const val KTBIND_SCHEMA_HASH: Long = 8711893117682718151L
+    }
+}
+
+class Point private constructor() : NativeObject() {
+    external override fun close(): Unit
+    external fun norm(): Double
+    var x: Double
+        get() = com.kheiron.ktbind.NativeMemory.getDouble(nativePointer, 0)
+        set(value) = com.kheiron.ktbind.NativeMemory.putDouble(nativePointer, 0, value)
+    var y: Double
+        get() = com.kheiron.ktbind.NativeMemory.getDouble(nativePointer, 8)
+        set(value) = com.kheiron.ktbind.NativeMemory.putDouble(nativePointer, 8, value)
+    var visits: Int
+        get() = com.kheiron.ktbind.NativeMemory.getInt(nativePointer, 16)
+        set(value) = com.kheiron.ktbind.NativeMemory.putInt(nativePointer, 16, value)
+    val fixed: Boolean
+        get() = com.kheiron.ktbind.NativeMemory.getBoolean(nativePointer, 20)
+    companion object {
+        @JvmStatic external fun create(arg0: Double, arg1: Double): com.kheiron.ktbind.Point
+    }
+}
+
+class Sample private constructor() : NativeObject() {
+    external override fun close(): Unit
+    external fun duplicate(): com.kheiron.ktbind.Sample
+    external fun get_data(): com.kheiron.ktbind.Data
+    external fun poll_data(): com.kheiron.ktbind.Data
+    external fun set_data(arg0: com.kheiron.ktbind.Data): Unit
+    companion object {
+        @JvmStatic external fun create(): com.kheiron.ktbind.Sample
+        @JvmStatic external fun create(arg0: String): com.kheiron.ktbind.Sample
+        @JvmStatic external fun returns_void(): Unit
+        @JvmStatic external fun returns_bool(): Boolean
+        @JvmStatic external fun returns_short(): Short
+        @JvmStatic external fun returns_int(): Int
+        @JvmStatic external fun returns_long(): Long
+        @JvmStatic external fun returns_int16(): Short
+        @JvmStatic external fun returns_int32(): Int
+        @JvmStatic external fun returns_int64(): Long
+        @JvmStatic external fun returns_float(): Float
+        @JvmStatic external fun returns_double(): Double
+        @JvmStatic external fun returns_string(): String
+        @JvmStatic external fun pass_arguments_by_value(arg0: String, arg1: Boolean, arg2: Short, arg3: Int, arg4: Long, arg5: Short, arg6: Int, arg7: Long, arg8: Float, arg9: Double): Boolean
+        @JvmStatic external fun pass_arguments_by_reference(arg0: String, arg1: Boolean, arg2: Short, arg3: Int, arg4: Long, arg5: Short, arg6: Int, arg7: Long, arg8: Float, arg9: Double): Boolean
+        @JvmStatic external fun array_of_char(arg0: ByteArray): ByteArray
+        @JvmStatic external fun array_of_int(arg0: IntArray): IntArray
+        @JvmStatic external fun array_of_string(arg0: List<String>): List<String>
+        @JvmStatic external fun list_of_int(arg0: List<Int>): List<Int>
+        @JvmStatic external fun list_of_string(arg0: List<String>): List<String>
+        @JvmStatic external fun unordered_set(arg0: Set<String>): Set<String>
+        @JvmStatic external fun ordered_set(arg0: Set<String>): Set<String>
+        @JvmStatic external fun unordered_map(arg0: Map<String, String>): Map<String, String>
+        @JvmStatic external fun ordered_map_of_int(arg0: Map<Long, Long>): Map<Long, Long>
+        @JvmStatic external fun ordered_map_of_string(arg0: Map<String, String>): Map<String, String>
+        @JvmStatic external fun native_composite(arg0: Map<String, List<String>>): Map<String, List<String>>
+        @JvmStatic external fun pass_callback(arg0: () -> Unit): Unit
+        @JvmStatic external fun pass_callback_returns_string(arg0: () -> String): String
+        @JvmStatic external fun pass_callback_string_returns_int(arg0: String, arg1: (arg0: String) -> Int): Int
+        @JvmStatic external fun pass_callback_string_returns_string(arg0: String, arg1: (arg0: String) -> String): String
+        @JvmStatic external fun pass_callback_arguments(arg0: String, arg1: (arg0: String, arg1: Short, arg2: Int, arg3: Long) -> String): String
+        @JvmStatic external fun callback_on_native_thread(arg0: () -> Unit): Unit
+        @JvmStatic external fun raise_native_exception(): Unit
+        @JvmStatic external fun raise_validation_error(arg0: Int): Unit
+        @JvmStatic external fun parse_number(arg0: String): com.kheiron.ktbind.NativeResult<Int, String>
+        @JvmStatic external fun catch_java_exception(arg0: () -> Unit): Unit
+        @JvmStatic external fun extract_features(arg0: String, arg1: Int): String
+        @JvmStatic external fun feature_call_count(): Int
+        @JvmStatic external fun log_messages(arg0: Int): Unit
+    }
+}
+
+class ValidationError(message: String) : Exception(message, null, false, false) {
+    val code: Int = 0
+}
+
@@ -0,0 +1,28 @@
+// Generated by ktbind from the bindings of a native module; do not edit.
+package com.kheiron.ktbind
+
+/** Creates method handles for native functions called with the Foreign Function & Memory API (JDK 22 or later). */
+object Downcalls {
+    private val linker = java.lang.foreign.Linker.nativeLinker()
+    private val addresses: Map<String, java.lang.foreign.MemorySegment> = run {
+        val lookup = java.lang.foreign.SymbolLookup.loaderLookup()
+        fun export(name: String, descriptor: java.lang.foreign.FunctionDescriptor) =
+            linker.downcallHandle(lookup.find(name).orElseThrow { UnsatisfiedLinkError(name) }, descriptor)
+        val count = export("ktbind_downcall_count", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.JAVA_LONG))
+        val key = export("ktbind_downcall_key", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.ADDRESS, java.lang.foreign.ValueLayout.JAVA_LONG))
+        val address = export("ktbind_downcall_address", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.ADDRESS, java.lang.foreign.ValueLayout.JAVA_LONG))
+        (0 until count.invoke() as Long).associate { k ->
+            (key.invoke(k) as java.lang.foreign.MemorySegment).reinterpret(Long.MAX_VALUE).getString(0) to
+                (address.invoke(k) as java.lang.foreign.MemorySegment)
+        }
+    }
+
+    /** Native functions bound for downcalls take primitive arguments only and cannot throw, and run as critical functions. */
+    @JvmStatic fun handle(key: String, descriptor: java.lang.foreign.FunctionDescriptor): java.lang.invoke.MethodHandle =
+        linker.downcallHandle(
+            addresses[key] ?: throw UnsatisfiedLinkError("No native function bound as $key"),
+            descriptor,
+            java.lang.foreign.Linker.Option.critical(false)
+        )
+}
+
@@ -0,0 +1,25 @@
+// Generated by ktbind from the bindings of a native module; do not edit.
+package com.kheiron.ktbind.test
+
+import com.kheiron.ktbind.NativeObject
+
+class Calculator private constructor() : NativeObject() {
+    external override fun close(): Unit
+    companion object {
+        @JvmStatic external fun checked_add(arg0: Int, arg1: Int): Int
+        @JvmStatic external fun describe(arg0: Int): String
+        private val downcall0 = com.kheiron.ktbind.Downcalls.handle("com/kheiron/ktbind/test/Calculator.add(II)I", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.JAVA_INT, java.lang.foreign.ValueLayout.JAVA_INT, java.lang.foreign.ValueLayout.JAVA_INT))
+        @JvmStatic fun add(arg0: Int, arg1: Int): Int {
+            return downcall0.invoke(arg0, arg1) as Int
+        }
+        private val downcall1 = com.kheiron.ktbind.Downcalls.handle("com/kheiron/ktbind/test/Calculator.scale(DJ)D", java.lang.foreign.FunctionDescriptor.of(java.lang.foreign.ValueLayout.JAVA_DOUBLE, java.lang.foreign.ValueLayout.JAVA_DOUBLE, java.lang.foreign.ValueLayout.JAVA_LONG))
+        @JvmStatic fun scale(arg0: Double, arg1: Long): Double {
+            return downcall1.invoke(arg0, arg1) as Double
+        }
+        private val downcall2 = com.kheiron.ktbind.Downcalls.handle("com/kheiron/ktbind/test/Calculator.reset()V", java.lang.foreign.FunctionDescriptor.ofVoid())
+        @JvmStatic fun reset(): Unit {
+            downcall2.invoke()
+        }
+    }
+}
+
@@ -2,6 +2,7 @@ plugins {
     id("java")
     id("application")
     id("org.jetbrains.kotlin.jvm") version "1.4.0"
+    id("me.champeau.gradle.jmh") version "0.5.3"
 }
 
 group = "com.kheiron.ktbind"
@@ -39,6 +40,24 @@ compileKotlin.kotlinOptions {
 compileTestKotlin.kotlinOptions {
     jvmTarget = "11"
 }
+tasks.named<org.jetbrains.kotlin.gradle.tasks.KotlinCompile>("compileJmhKotlin") {
+    kotlinOptions.jvmTarget = "11"
+    dependsOn("generateStartupSources")
+}
+
+// Kotlin declarations matching the synthetic extension module ktbind_startup
+val startupSourceDir = project.file("${project.buildDir}/generated/startup")
+tasks.register<Exec>("generateStartupSources") {
+    val generator = project.file("${project.projectDir}/../cpp/build/ktbind_startup_stubgen")
+    inputs.file(generator)
+    outputs.dir(startupSourceDir)
+    commandLine(generator.path, startupSourceDir.path)
+}
+sourceSets.named("jmh") {
+    withConvention(org.jetbrains.kotlin.gradle.plugin.KotlinSourceSet::class) {
+        kotlin.srcDir(startupSourceDir)
+    }
+}
 java {
     sourceCompatibility = JavaVersion.VERSION_11
     targetCompatibility = JavaVersion.VERSION_11
@@ -52,3 +71,15 @@ tasks.named<Test>("test") {
         events("passed", "skipped", "failed")
     }
 }
+
+jmh {
+    jmhVersion = "1.25"
+    // report allocation rate per operation next to timing
+    profilers = listOf("gc")
+    resultFormat = "JSON"
+    resultsFile = project.file("${project.buildDir}/reports/jmh/results.json")
+    jvmArgs = listOf(
+        "-Dktbind.benchmark.library=${project.projectDir}/../cpp/build/libktbind_benchmark.so",
+        "-Dktbind.startup.library=${project.projectDir}/../cpp/build/libktbind_startup.so"
+    )
+}
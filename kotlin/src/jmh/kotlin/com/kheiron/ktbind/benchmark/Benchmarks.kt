@@ -0,0 +1,146 @@
+package com.kheiron.ktbind.benchmark
+
+import org.openjdk.jmh.annotations.*
+import java.util.concurrent.TimeUnit
+
+/**
+ * Common configuration of all benchmarks. Each benchmark class compares a ktbind binding against hand-written JNI
+ * code and a pure Kotlin implementation of the same operation.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+abstract class NativeBenchmark {
+    @Setup(Level.Trial)
+    fun loadLibrary() {
+        NativeLibrary.load()
+    }
+}
+
+open class PrimitiveCall : NativeBenchmark() {
+    private var a = 82
+    private var b = 1024
+
+    @Benchmark fun ktbind(): Int = KtBindFunctions.add(a, b)
+    @Benchmark fun ktbindNoexcept(): Int = KtBindFunctions.addNoexcept(a, b)
+    @Benchmark fun handWritten(): Int = HandWrittenJni.add(a, b)
+    @Benchmark fun kotlin(): Int = PureKotlin.add(a, b)
+}
+
+/**
+ * Calls a member function on a long-lived object. Functions declared `noexcept` with fundamental types only are
+ * bound with an adapter that has no exception handlers.
+ */
+open class MemberCall : NativeBenchmark() {
+    private lateinit var counter: Counter
+    private var ptr = 0L
+    private val kotlinCounter = PureKotlin.Counter()
+
+    @Setup
+    fun create() {
+        counter = Counter.create()
+        ptr = HandWrittenJni.createCounter()
+    }
+
+    @TearDown
+    fun destroy() {
+        counter.close()
+        HandWrittenJni.destroyCounter(ptr)
+    }
+
+    @Benchmark fun ktbind() = counter.increment()
+    @Benchmark fun ktbindNoexcept() = counter.incrementNoexcept()
+    @Benchmark fun handWritten() = HandWrittenJni.increment(ptr)
+    @Benchmark fun kotlin() = kotlinCounter.increment()
+}
+
+open class StringRoundTrip : NativeBenchmark() {
+    @Param("8", "256")
+    @JvmField var length = 0
+    private lateinit var str: String
+
+    @Setup
+    fun prepare() {
+        str = "x".repeat(length)
+    }
+
+    @Benchmark fun ktbind(): String = KtBindFunctions.echoString(str)
+    @Benchmark fun handWritten(): String = HandWrittenJni.echoString(str)
+    @Benchmark fun kotlin(): String = PureKotlin.echoString(str)
+}
+
+open class PrimitiveArray : NativeBenchmark() {
+    @Param("16", "4096")
+    @JvmField var size = 0
+    private lateinit var values: IntArray
+
+    @Setup
+    fun prepare() {
+        values = IntArray(size) { it }
+    }
+
+    @Benchmark fun ktbind(): Long = KtBindFunctions.sumInts(values)
+    @Benchmark fun handWritten(): Long = HandWrittenJni.sumInts(values)
+    @Benchmark fun kotlin(): Long = PureKotlin.sumInts(values)
+}
+
+open class CollectionMarshaling : NativeBenchmark() {
+    @Param("16", "256")
+    @JvmField var size = 0
+    private lateinit var words: List<String>
+
+    @Setup
+    fun prepare() {
+        words = List(size) { "word${it % 8}" }
+    }
+
+    @Benchmark fun ktbind(): Map<String, Int> = KtBindFunctions.countWords(words)
+    @Benchmark fun handWritten(): Map<String, Int> = HandWrittenJni.countWords(words)
+    @Benchmark fun kotlin(): Map<String, Int> = PureKotlin.countWords(words)
+}
+
+open class DataClassRoundTrip : NativeBenchmark() {
+    private val data = BenchData(1, 2.0, "data class", IntArray(16) { it })
+
+    @Benchmark fun ktbind(): BenchData = KtBindFunctions.transform(data)
+    @Benchmark fun handWritten(): BenchData = HandWrittenJni.transform(data)
+    @Benchmark fun kotlin(): BenchData = PureKotlin.transform(data)
+}
+
+open class ObjectLifecycle : NativeBenchmark() {
+    @Benchmark
+    fun ktbind() {
+        Counter.create().use {
+            it.increment()
+        }
+    }
+
+    @Benchmark
+    fun handWritten() {
+        val ptr = HandWrittenJni.createCounter()
+        try {
+            HandWrittenJni.increment(ptr)
+        } finally {
+            HandWrittenJni.destroyCounter(ptr)
+        }
+    }
+
+    @Benchmark
+    fun kotlin(): Long {
+        val counter = PureKotlin.Counter()
+        counter.increment()
+        return counter.value
+    }
+}
+
+open class CallbackUpcall : NativeBenchmark() {
+    private val callback: (Int) -> Int = { it + 1 }
+    private var value = 82
+
+    @Benchmark fun ktbind(): Int = KtBindFunctions.applyCallback(callback, value)
+    @Benchmark fun handWritten(): Int = HandWrittenJni.applyCallback(callback, value)
+    @Benchmark fun kotlin(): Int = PureKotlin.applyCallback(callback, value)
+}
@@ -0,0 +1,89 @@
+package com.kheiron.ktbind.benchmark
+
+import java.io.File
+
+/**
+ * Represents a class that is instantiated in native code.
+ */
+abstract class NativeObject : AutoCloseable {
+    /**
+     * Holds a reference to an object that exists in the native code execution context.
+     */
+    @Suppress("unused")
+    private val nativePointer: Long = 0
+}
+
+data class BenchData(
+        val i: Int = 0,
+        val d: Double = 0.0,
+        val str: String = "",
+        val values: IntArray = IntArray(0)
+)
+
+class Counter private constructor() : NativeObject() {
+    external override fun close()
+    external fun increment()
+    external fun incrementNoexcept()
+    external fun value(): Long
+    companion object {
+        @JvmStatic external fun create(): Counter
+    }
+}
+
+/**
+ * Functions bound with ktbind.
+ */
+object KtBindFunctions {
+    @JvmStatic external fun add(a: Int, b: Int): Int
+    @JvmStatic external fun addNoexcept(a: Int, b: Int): Int
+    @JvmStatic external fun echoString(str: String): String
+    @JvmStatic external fun sumInts(values: IntArray): Long
+    @JvmStatic external fun countWords(words: List<String>): Map<String, Int>
+    @JvmStatic external fun transform(data: BenchData): BenchData
+    @JvmStatic external fun applyCallback(callback: (Int) -> Int, value: Int): Int
+}
+
+/**
+ * The same functions implemented with hand-written JNI code.
+ */
+object HandWrittenJni {
+    @JvmStatic external fun add(a: Int, b: Int): Int
+    @JvmStatic external fun echoString(str: String): String
+    @JvmStatic external fun sumInts(values: IntArray): Long
+    @JvmStatic external fun countWords(words: List<String>): Map<String, Int>
+    @JvmStatic external fun transform(data: BenchData): BenchData
+    @JvmStatic external fun applyCallback(callback: (Int) -> Int, value: Int): Int
+    @JvmStatic external fun createCounter(): Long
+    @JvmStatic external fun increment(ptr: Long)
+    @JvmStatic external fun destroyCounter(ptr: Long)
+}
+
+/**
+ * The same functions implemented in Kotlin, as a baseline without crossing the language boundary.
+ */
+object PureKotlin {
+    fun add(a: Int, b: Int): Int = a + b
+    fun echoString(str: String): String = String(str.toCharArray())
+    fun sumInts(values: IntArray): Long = values.fold(0L) { sum, value -> sum + value }
+    fun countWords(words: List<String>): Map<String, Int> = words.groupingBy { it }.eachCount()
+    fun transform(data: BenchData): BenchData = data.copy(i = data.i + 1, d = data.d * 2, values = data.values.copyOf())
+    fun applyCallback(callback: (Int) -> Int, value: Int): Int = callback(value)
+
+    class Counter {
+        var value: Long = 0
+        fun increment() {
+            ++value
+        }
+    }
+}
+
+object NativeLibrary {
+    /**
+     * Loads the benchmark library, whose location is passed in the system property `ktbind.benchmark.library`.
+     */
+    fun load() {
+        val path = System.getProperty("ktbind.benchmark.library")
+                ?: File(System.getProperty("user.dir"), "../cpp/build/libktbind_benchmark.so").absolutePath
+        System.load(path)
+    }
+}
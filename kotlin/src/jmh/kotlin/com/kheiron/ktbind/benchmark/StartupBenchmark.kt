@@ -0,0 +1,23 @@
+package com.kheiron.ktbind.benchmark
+
+import org.openjdk.jmh.annotations.*
+import java.util.concurrent.TimeUnit
+
+/**
+ * Measures the time `System.load` takes to load the synthetic extension module `ktbind_startup`, which registers
+ * thousands of functions and hundreds of data classes in `JNI_OnLoad`.
+ *
+ * A library can be loaded only once per class loader, hence each fork performs a single measurement.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.SingleShotTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 0)
+@Measurement(iterations = 1)
+@Fork(10)
+open class LibraryLoad {
+    @Benchmark
+    fun load() {
+        System.load(System.getProperty("ktbind.startup.library"))
+    }
+}
@@ -0,0 +1,17 @@
+package com.kheiron.ktbind
+
+/**
+ * Registers the native methods of a class on first use, when an extension module is built with the preprocessor
+ * macro `KTBIND_LAZY_REGISTRATION`.
+ *
+ * In lazy mode, loading the module registers no native classes. Instead, the companion object of each native class
+ * registers the native methods of its class when it is initialized:
+ * ```kotlin
+ * companion object {
+ *     init { KtBind.register(Sample::class.java) }
+ * }
+ * ```
+ */
+object KtBind {
+    @JvmStatic external fun register(cls: Class<*>)
+}
@@ -0,0 +1,17 @@
+package com.kheiron.ktbind
+
+/**
+ * Exposes the number of live native objects per class and the number of global references held by native code.
+ *
+ * Functions are implemented in native code, and registered only if the extension module is built with the
+ * preprocessor macro `KTBIND_ENABLE_LEAK_TRACKING`. `maxLocalRefs` also requires `KTBIND_ENABLE_JNI_PROFILER`.
+ */
+object KtBindLeaks {
+    @JvmStatic external fun classes(): List<String>
+    @JvmStatic external fun liveObjects(className: String): Long
+    @JvmStatic external fun createdObjects(className: String): Long
+    @JvmStatic external fun globalRefs(): Long
+    @JvmStatic external fun captureAllocationSites(enabled: Boolean)
+    @JvmStatic external fun allocationSites(className: String): List<String>
+    @JvmStatic external fun maxLocalRefs(binding: String): Long
+}
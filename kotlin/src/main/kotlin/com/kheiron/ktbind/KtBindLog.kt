@@ -0,0 +1,21 @@
+package com.kheiron.ktbind
+
+/**
+ * Configures the channel that forwards native log messages to log4j.
+ *
+ * Levels are 0 (trace), 1 (debug), 2 (info), 3 (warn), 4 (error) and 5 (off). Native methods are registered when the
+ * object is first used, which spares extension modules that never configure logging a class lookup when loaded.
+ */
+object KtBindLog {
+    init {
+        bind()
+    }
+
+    @JvmStatic private external fun bind()
+
+    @JvmStatic external fun level(): Int
+    @JvmStatic external fun setLevel(level: Int)
+    @JvmStatic external fun flush()
+    @JvmStatic external fun written(): Long
+    @JvmStatic external fun dropped(): Long
+}
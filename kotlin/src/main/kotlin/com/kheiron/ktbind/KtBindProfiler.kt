@@ -0,0 +1,17 @@
+package com.kheiron.ktbind
+
+/**
+ * Exposes the number of JNI function invocations per native binding, by category (see `operations()`).
+ *
+ * Functions are implemented in native code, and registered only if the extension module is built with the
+ * preprocessor macro `KTBIND_ENABLE_JNI_PROFILER`.
+ */
+object KtBindProfiler {
+    @JvmStatic external fun enable(enabled: Boolean)
+    @JvmStatic external fun operations(): List<String>
+    @JvmStatic external fun calls(binding: String): Long
+    @JvmStatic external fun total(binding: String): LongArray
+    @JvmStatic external fun maxPerCall(binding: String): LongArray
+    @JvmStatic external fun maxTotalPerCall(binding: String): Long
+    @JvmStatic external fun reset()
+}
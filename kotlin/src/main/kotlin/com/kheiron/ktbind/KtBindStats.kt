@@ -0,0 +1,23 @@
+package com.kheiron.ktbind
+
+/**
+ * Exposes call counts and latency histograms of native bindings, split into call phases.
+ *
+ * Functions are implemented in native code, and registered only if the extension module is built with the
+ * preprocessor macro `KTBIND_ENABLE_STATISTICS`. Phases are 0 (marshal-in), 1 (native execution) and 2 (marshal-out).
+ * Marshaling directions are 0 (to native) and 1 (to Java).
+ */
+object KtBindStats {
+    @JvmStatic external fun bindings(): List<String>
+    @JvmStatic external fun calls(binding: String): Long
+    @JvmStatic external fun errors(binding: String): Long
+    @JvmStatic external fun totalNanos(binding: String, phase: Int): Long
+    @JvmStatic external fun histogram(binding: String, phase: Int): LongArray
+    @JvmStatic external fun bucketBounds(): LongArray
+    @JvmStatic external fun percentile(binding: String, phase: Int, p: Double): Long
+    @JvmStatic external fun objects(binding: String, direction: Int): Long
+    @JvmStatic external fun bytes(binding: String, direction: Int): Long
+    @JvmStatic external fun elements(binding: String, direction: Int): Long
+    @JvmStatic external fun reset()
+    @JvmStatic external fun slowCallThreshold(nanos: Long)
+}
@@ -0,0 +1,15 @@
+package com.kheiron.ktbind
+
+/**
+ * Records native call spans into per-thread ring buffers, and exports them in the Chrome trace event format.
+ *
+ * Functions are implemented in native code, and registered only if the extension module is built with the
+ * preprocessor macro `KTBIND_ENABLE_TRACING`.
+ */
+object KtBindTrace {
+    @JvmStatic external fun start(capacity: Int)
+    @JvmStatic external fun stop()
+    @JvmStatic external fun clear()
+    @JvmStatic external fun json(): String
+    @JvmStatic external fun write(path: String)
+}
@@ -0,0 +1,47 @@
+package com.kheiron.ktbind
+
+import sun.misc.Unsafe
+
+/**
+ * Reads and writes member variables of native objects bound with `native_class::property`.
+ *
+ * Accessors take the native pointer of an object and the offset of the member variable, and access native memory
+ * directly, without a JNI call:
+ * ```kotlin
+ * var x: Double
+ *     get() = NativeMemory.getDouble(nativePointer, 0)
+ *     set(value) = NativeMemory.putDouble(nativePointer, 0, value)
+ * ```
+ */
+object NativeMemory {
+    private val unsafe: Unsafe = Unsafe::class.java.getDeclaredField("theUnsafe").let {
+        it.isAccessible = true
+        it.get(null) as Unsafe
+    }
+
+    /** Checks that the native object has not been closed, and returns the address of a member variable. */
+    private fun address(nativePointer: Long, offset: Long): Long {
+        if (nativePointer == 0L) {
+            throw IllegalStateException("Native object has been closed")
+        }
+        return nativePointer + offset
+    }
+
+    @JvmStatic fun getBoolean(nativePointer: Long, offset: Long): Boolean = unsafe.getByte(address(nativePointer, offset)) != 0.toByte()
+    @JvmStatic fun getByte(nativePointer: Long, offset: Long): Byte = unsafe.getByte(address(nativePointer, offset))
+    @JvmStatic fun getChar(nativePointer: Long, offset: Long): Char = unsafe.getChar(address(nativePointer, offset))
+    @JvmStatic fun getShort(nativePointer: Long, offset: Long): Short = unsafe.getShort(address(nativePointer, offset))
+    @JvmStatic fun getInt(nativePointer: Long, offset: Long): Int = unsafe.getInt(address(nativePointer, offset))
+    @JvmStatic fun getLong(nativePointer: Long, offset: Long): Long = unsafe.getLong(address(nativePointer, offset))
+    @JvmStatic fun getFloat(nativePointer: Long, offset: Long): Float = unsafe.getFloat(address(nativePointer, offset))
+    @JvmStatic fun getDouble(nativePointer: Long, offset: Long): Double = unsafe.getDouble(address(nativePointer, offset))
+
+    @JvmStatic fun putBoolean(nativePointer: Long, offset: Long, value: Boolean) = unsafe.putByte(address(nativePointer, offset), if (value) 1 else 0)
+    @JvmStatic fun putByte(nativePointer: Long, offset: Long, value: Byte) = unsafe.putByte(address(nativePointer, offset), value)
+    @JvmStatic fun putChar(nativePointer: Long, offset: Long, value: Char) = unsafe.putChar(address(nativePointer, offset), value)
+    @JvmStatic fun putShort(nativePointer: Long, offset: Long, value: Short) = unsafe.putShort(address(nativePointer, offset), value)
+    @JvmStatic fun putInt(nativePointer: Long, offset: Long, value: Int) = unsafe.putInt(address(nativePointer, offset), value)
+    @JvmStatic fun putLong(nativePointer: Long, offset: Long, value: Long) = unsafe.putLong(address(nativePointer, offset), value)
+    @JvmStatic fun putFloat(nativePointer: Long, offset: Long, value: Float) = unsafe.putFloat(address(nativePointer, offset), value)
+    @JvmStatic fun putDouble(nativePointer: Long, offset: Long, value: Double) = unsafe.putDouble(address(nativePointer, offset), value)
+}
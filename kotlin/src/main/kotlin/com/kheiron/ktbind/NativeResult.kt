@@ -0,0 +1,23 @@
+package com.kheiron.ktbind
+
+/**
+ * The outcome of a native function that returns `java::result<T, E>`: either a value or an error.
+ *
+ * Expected failures are reported as [Failure] instead of an exception, which saves unwinding the native stack and
+ * capturing a Java stack trace:
+ * ```kotlin
+ * when (val result = Validator.validate(input)) {
+ *     is NativeResult.Success -> use(result.value)
+ *     is NativeResult.Failure -> report(result.error)
+ * }
+ * ```
+ */
+sealed class NativeResult<out T, out E> {
+    data class Success<out T>(val value: T) : NativeResult<T, Nothing>()
+    data class Failure<out E>(val error: E) : NativeResult<Nothing, E>()
+
+    val isSuccess: Boolean get() = this is Success
+
+    /** Returns the value on success, or null on failure. */
+    fun getOrNull(): T? = (this as? Success)?.value
+}
@@ -0,0 +1,100 @@
+package com.kheiron.ktbind
+
+import jdk.jfr.Category
+import jdk.jfr.DataAmount
+import jdk.jfr.Description
+import jdk.jfr.Event
+import jdk.jfr.Label
+import jdk.jfr.Name
+import jdk.jfr.StackTrace
+import jdk.jfr.Timespan
+
+/**
+ * JDK Flight Recorder event emitted by native code when a call to a native binding exceeds the duration threshold
+ * set with `KtBindStats.slowCallThreshold`.
+ *
+ * The event is committed after the call has returned, so the event's own duration is not meaningful; the time spent
+ * in the call is carried by the fields `marshalIn`, `execute` and `marshalOut`.
+ */
+@Name("com.kheiron.ktbind.SlowNativeCall")
+@Label("Slow Native Call")
+@Category("KtBind")
+@Description("A call to a native function binding that took longer than the configured threshold")
+@StackTrace(true)
+class SlowNativeCallEvent : Event() {
+    @Label("Binding")
+    @Description("Qualified Kotlin name of the native function binding")
+    @JvmField var binding: String? = null
+
+    @Label("Argument Conversion")
+    @Timespan(Timespan.NANOSECONDS)
+    @JvmField var marshalIn: Long = 0
+
+    @Label("Execution")
+    @Timespan(Timespan.NANOSECONDS)
+    @JvmField var execute: Long = 0
+
+    @Label("Return Value Conversion")
+    @Timespan(Timespan.NANOSECONDS)
+    @JvmField var marshalOut: Long = 0
+
+    @Label("Objects In")
+    @Description("Java objects converted into native values")
+    @JvmField var objectsIn: Long = 0
+
+    @Label("Objects Out")
+    @Description("Java objects instantiated from native values")
+    @JvmField var objectsOut: Long = 0
+
+    @Label("Bytes In")
+    @DataAmount(DataAmount.BYTES)
+    @JvmField var bytesIn: Long = 0
+
+    @Label("Bytes Out")
+    @DataAmount(DataAmount.BYTES)
+    @JvmField var bytesOut: Long = 0
+
+    @Label("Elements In")
+    @Description("Collection elements converted into native values")
+    @JvmField var elementsIn: Long = 0
+
+    @Label("Elements Out")
+    @Description("Collection elements converted into Java values")
+    @JvmField var elementsOut: Long = 0
+
+    @Label("Failed")
+    @Description("Whether the call terminated with an exception")
+    @JvmField var failed: Boolean = false
+
+    companion object {
+        /**
+         * Called from native code with the measurements of a slow call.
+         */
+        @JvmStatic
+        fun commit(
+            binding: String,
+            marshalIn: Long, execute: Long, marshalOut: Long,
+            objectsIn: Long, objectsOut: Long,
+            bytesIn: Long, bytesOut: Long,
+            elementsIn: Long, elementsOut: Long,
+            failed: Boolean
+        ) {
+            val event = SlowNativeCallEvent()
+            if (!event.isEnabled) {
+                return
+            }
+            event.binding = binding
+            event.marshalIn = marshalIn
+            event.execute = execute
+            event.marshalOut = marshalOut
+            event.objectsIn = objectsIn
+            event.objectsOut = objectsOut
+            event.bytesIn = bytesIn
+            event.bytesOut = bytesOut
+            event.elementsIn = elementsIn
+            event.elementsOut = elementsOut
+            event.failed = failed
+            event.commit()
+        }
+    }
+}
@@ -6,19 +6,10 @@ import org.junit.jupiter.api.assertThrows
 import java.io.ByteArrayOutputStream
 import java.io.File
 import java.io.PrintStream
+import jdk.jfr.Recording
+import jdk.jfr.consumer.RecordingFile
 import kotlin.concurrent.thread
 
-/**
- * Represents a class that is instantiated in native code.
- */
-abstract class NativeObject : AutoCloseable {
-    /**
-     * Holds a reference to an object that exists in the native code execution context.
-     */
-    @Suppress("unused")
-    private val nativePointer: Long = 0
-}
-
 data class Data(
         val b: Boolean = false,
         val s: Short = 0,
@@ -36,6 +27,7 @@ data class Data(
 class Sample private constructor() : NativeObject() {
     external override fun close()
     external fun get_data(): Data
+    external fun poll_data(): Data
     external fun set_data(data: Data)
     external fun duplicate(): Sample
     companion object {
@@ -72,7 +64,35 @@ class Sample private constructor() : NativeObject() {
         @JvmStatic external fun pass_callback_arguments(str: String, callback: (String, Short, Int, Long) -> String): String
         @JvmStatic external fun callback_on_native_thread(callback: () -> Unit)
         @JvmStatic external fun raise_native_exception()
+        @JvmStatic external fun raise_validation_error(code: Int)
+        @JvmStatic external fun parse_number(str: String): NativeResult<Int, String>
         @JvmStatic external fun catch_java_exception(callback: () -> Unit)
+        @JvmStatic external fun extract_features(text: String, window: Int): String
+        @JvmStatic external fun feature_call_count(): Int
+        @JvmStatic external fun log_messages(count: Int)
+    }
+}
+
+class ValidationError(message: String) : Exception(message, null, false, false) {
+    val code: Int = 0
+}
+
+class Point private constructor() : NativeObject() {
+    external override fun close()
+    external fun norm(): Double
+    var x: Double
+        get() = NativeMemory.getDouble(nativePointer, 0)
+        set(value) = NativeMemory.putDouble(nativePointer, 0, value)
+    var y: Double
+        get() = NativeMemory.getDouble(nativePointer, 8)
+        set(value) = NativeMemory.putDouble(nativePointer, 8, value)
+    var visits: Int
+        get() = NativeMemory.getInt(nativePointer, 16)
+        set(value) = NativeMemory.putInt(nativePointer, 16, value)
+    val fixed: Boolean
+        get() = NativeMemory.getBoolean(nativePointer, 20)
+    companion object {
+        @JvmStatic external fun create(x: Double, y: Double): Point
     }
 }
 
@@ -223,6 +243,15 @@ internal class NativeBindingsTest {
         assertThrows<Exception> {
             Sample.raise_native_exception()
         }
+        val ex = assertThrows<ValidationError> {
+            Sample.raise_validation_error(42)
+        }
+        assertEquals("invalid value", ex.message)
+        assertEquals(42, ex.code)
+
+        // expected failures are returned as values
+        assertEquals(NativeResult.Success(123), Sample.parse_number("123"))
+        assertEquals(NativeResult.Failure("not a number: 12a"), Sample.parse_number("12a"))
         assertThrows<Exception> {
             Sample.pass_callback { throw Exception("non-critical error") }
         }
@@ -275,4 +304,306 @@ internal class NativeBindingsTest {
             other.close()
         }
     }
+
+    @Test
+    fun `versioned results`() {
+        Sample.create().use {
+            val data = it.poll_data()
+            assertSame(data, it.poll_data())
+            it.set_data(Data(i = 7))
+            val updated = it.poll_data()
+            assertNotSame(data, updated)
+            assertEquals(7, updated.i)
+            assertSame(updated, it.poll_data())
+        }
+    }
+
+    @Test
+    fun `memoized functions`() {
+        val calls = Sample.feature_call_count()
+        val features = Sample.extract_features("kotlin", 3)
+        assertEquals("kot otl tli lin", features)
+        assertSame(features, Sample.extract_features("kotlin", 3))
+        assertEquals(calls + 1, Sample.feature_call_count())
+        assertEquals("ko ot tl li in", Sample.extract_features("kotlin", 2))
+        assertEquals(calls + 2, Sample.feature_call_count())
+    }
+
+    @Test
+    fun `native properties`() {
+        val point = Point.create(3.0, 4.0)
+        point.use {
+            assertEquals(3.0, it.x)
+            assertEquals(4.0, it.y)
+            assertEquals(0, it.visits)
+            assertTrue(it.fixed)
+            assertEquals(5.0, it.norm())
+
+            it.x = 6.0
+            it.y = 8.0
+            it.visits += 1
+            assertEquals(10.0, it.norm())
+            assertEquals(1, it.visits)
+        }
+        assertThrows<IllegalStateException> { point.x }
+    }
+
+    @Test
+    fun `call statistics`() {
+        val binding = "com.kheiron.ktbind.Sample.returns_string"
+        assertTrue(KtBindStats.bindings().contains(binding))
+
+        KtBindStats.reset()
+        assertEquals(0, KtBindStats.calls(binding))
+        repeat(10) {
+            Sample.returns_string()
+        }
+        assertEquals(10, KtBindStats.calls(binding))
+        assertEquals(0, KtBindStats.errors(binding))
+        for (phase in 0..2) {
+            assertEquals(10, KtBindStats.histogram(binding, phase).sum())
+            assertTrue(KtBindStats.percentile(binding, phase, 50.0) <= KtBindStats.percentile(binding, phase, 99.0))
+        }
+        assertEquals(KtBindStats.histogram(binding, 0).size, KtBindStats.bucketBounds().size)
+
+        val failing = "com.kheiron.ktbind.Sample.raise_native_exception"
+        assertThrows<Exception> {
+            Sample.raise_native_exception()
+        }
+        assertEquals(1, KtBindStats.calls(failing))
+        assertEquals(1, KtBindStats.errors(failing))
+
+        // counters of terminated threads are retained
+        thread {
+            Sample.returns_string()
+        }.join()
+        assertEquals(11, KtBindStats.calls(binding))
+
+        assertThrows<Exception> {
+            KtBindStats.calls("com.kheiron.ktbind.Sample.no_such_function")
+        }
+    }
+
+    @Test
+    fun `JNI call profiler`() {
+        KtBindProfiler.reset()
+        KtBindProfiler.enable(true)
+        try {
+            Sample.returns_int()
+            Sample.returns_string()
+            captureOutput {
+                Sample.create().use {
+                    it.get_data()
+                }
+            }
+        } finally {
+            KtBindProfiler.enable(false)
+        }
+
+        val operations = KtBindProfiler.operations()
+        assertEquals(1, KtBindProfiler.calls("com.kheiron.ktbind.Sample.returns_int"))
+        assertEquals(0, KtBindProfiler.maxTotalPerCall("com.kheiron.ktbind.Sample.returns_int"))
+
+        // a single java.lang.String is constructed
+        val stringOperations = KtBindProfiler.maxPerCall("com.kheiron.ktbind.Sample.returns_string")
+        assertEquals(1, KtBindProfiler.maxTotalPerCall("com.kheiron.ktbind.Sample.returns_string"))
+        assertEquals(1, stringOperations[operations.indexOf("new_object")])
+        assertEquals(1, KtBindLeaks.maxLocalRefs("com.kheiron.ktbind.Sample.returns_string"))
+        assertEquals(0, KtBindLeaks.maxLocalRefs("com.kheiron.ktbind.Sample.returns_int"))
+
+        val dataOperations = KtBindProfiler.total("com.kheiron.ktbind.Sample.get_data")
+        assertEquals(1, KtBindProfiler.calls("com.kheiron.ktbind.Sample.get_data"))
+        assertTrue(dataOperations[operations.indexOf("find_class")] > 0)
+        assertTrue(dataOperations[operations.indexOf("field_id")] > 0)
+        assertEquals(dataOperations.sum(), KtBindProfiler.maxTotalPerCall("com.kheiron.ktbind.Sample.get_data"))
+
+        // no calls are profiled when disabled
+        Sample.returns_int()
+        assertEquals(1, KtBindProfiler.calls("com.kheiron.ktbind.Sample.returns_int"))
+    }
+
+    @Test
+    fun `marshaling volume`() {
+        KtBindStats.reset()
+        captureOutput {
+            Sample.array_of_int(intArrayOf(1, 2, 3))
+            Sample.list_of_string(listOf("a", "bc"))
+            Sample.native_composite(mapOf("a" to listOf("1", "2", "3")))
+        }
+
+        // IntArray of 3 elements in, IntArray of 7 elements out
+        val arrayBinding = "com.kheiron.ktbind.Sample.array_of_int"
+        assertEquals(3 * 4, KtBindStats.bytes(arrayBinding, 0))
+        assertEquals(7 * 4, KtBindStats.bytes(arrayBinding, 1))
+        assertEquals(1, KtBindStats.objects(arrayBinding, 1))
+
+        // list of 2 strings in, ArrayList of 6 strings out
+        val listBinding = "com.kheiron.ktbind.Sample.list_of_string"
+        assertEquals(2, KtBindStats.elements(listBinding, 0))
+        assertEquals(3, KtBindStats.bytes(listBinding, 0))
+        assertEquals(6, KtBindStats.elements(listBinding, 1))
+        assertEquals(6, KtBindStats.bytes(listBinding, 1))
+        assertEquals(7, KtBindStats.objects(listBinding, 1))
+
+        // map with 1 entry and 3 nested elements in, map with 3 entries and 4 nested elements out
+        val mapBinding = "com.kheiron.ktbind.Sample.native_composite"
+        assertEquals(4, KtBindStats.elements(mapBinding, 0))
+        assertEquals(7, KtBindStats.elements(mapBinding, 1))
+    }
+
+    @Test
+    fun `call tracing`() {
+        KtBindTrace.clear()
+        KtBindTrace.start(1024)
+        try {
+            Sample.returns_string()
+            assertEquals(82, Sample.pass_callback_string_returns_int("callback") { 82 })
+            Sample.callback_on_native_thread { }
+            assertThrows<Exception> {
+                Sample.raise_native_exception()
+            }
+        } finally {
+            KtBindTrace.stop()
+        }
+        Sample.returns_int()
+
+        val trace = KtBindTrace.json()
+        assertTrue(trace.startsWith("{\"displayTimeUnit\""))
+        assertTrue(trace.contains("\"name\":\"com.kheiron.ktbind.Sample.returns_string\",\"cat\":\"call\""))
+        assertTrue(trace.contains("\"name\":\"(arg0: String) -> Int\",\"cat\":\"callback\""))
+        assertTrue(trace.contains("\"cat\":\"attach\""))
+        assertTrue(trace.contains("\"cat\":\"exception\""))
+        assertFalse(trace.contains("Sample.returns_int"))
+
+        val file = File.createTempFile("ktbind", ".json")
+        try {
+            KtBindTrace.write(file.path)
+            assertTrue(file.readText().contains("com.kheiron.ktbind.Sample.returns_string"))
+        } finally {
+            file.delete()
+        }
+
+        KtBindTrace.clear()
+        assertFalse(KtBindTrace.json().contains("Sample.returns_string"))
+    }
+
+    @Test
+    fun `slow call events`() {
+        val file = File.createTempFile("ktbind", ".jfr")
+        try {
+            Recording().use { recording ->
+                recording.enable("com.kheiron.ktbind.SlowNativeCall")
+                recording.start()
+                KtBindStats.slowCallThreshold(1)
+                try {
+                    captureOutput {
+                        Sample.list_of_string(listOf("a", "bc"))
+                    }
+                    assertThrows<Exception> {
+                        Sample.raise_native_exception()
+                    }
+                } finally {
+                    KtBindStats.slowCallThreshold(0)
+                }
+                Sample.returns_int()
+                recording.stop()
+                recording.dump(file.toPath())
+            }
+
+            val events = RecordingFile.readAllEvents(file.toPath())
+                    .filter { it.eventType.name == "com.kheiron.ktbind.SlowNativeCall" }
+                    .associateBy { it.getString("binding") }
+
+            val list = events.getValue("com.kheiron.ktbind.Sample.list_of_string")
+            assertEquals(2, list.getLong("elementsIn"))
+            assertEquals(3, list.getLong("bytesIn"))
+            assertEquals(6, list.getLong("elementsOut"))
+            assertFalse(list.getBoolean("failed"))
+            assertTrue(list.getLong("execute") >= 0)
+
+            assertTrue(events.getValue("com.kheiron.ktbind.Sample.raise_native_exception").getBoolean("failed"))
+            assertFalse(events.containsKey("com.kheiron.ktbind.Sample.returns_int"))
+        } finally {
+            file.delete()
+        }
+    }
+
+    @Test
+    fun `leak tracking`() {
+        val className = "com.kheiron.ktbind.Sample"
+        assertTrue(KtBindLeaks.classes().contains(className))
+        val live = KtBindLeaks.liveObjects(className)
+        val created = KtBindLeaks.createdObjects(className)
+
+        captureOutput {
+            Sample.create().use {}
+        }
+        assertEquals(live, KtBindLeaks.liveObjects(className))
+        assertEquals(created + 1, KtBindLeaks.createdObjects(className))
+
+        val leaked = mutableListOf<Sample>()
+        KtBindLeaks.captureAllocationSites(true)
+        try {
+            captureOutput {
+                leaked.add(Sample.create())
+                leaked.add(Sample.create("leaked"))
+            }
+        } finally {
+            KtBindLeaks.captureAllocationSites(false)
+        }
+        assertEquals(live + 2, KtBindLeaks.liveObjects(className))
+        val sites = KtBindLeaks.allocationSites(className)
+        assertEquals(2, sites.size)
+        assertTrue(sites.all { it.contains("NativeBindingsTest.leak tracking") })
+
+        captureOutput {
+            leaked.removeAt(0).close()
+        }
+        assertEquals(live + 1, KtBindLeaks.liveObjects(className))
+        assertEquals(1, KtBindLeaks.allocationSites(className).size)
+        captureOutput {
+            leaked.removeAt(0).close()
+        }
+        assertEquals(live, KtBindLeaks.liveObjects(className))
+
+        // a callback holds a global reference to the function object while it is in use
+        val globalRefs = KtBindLeaks.globalRefs()
+        Sample.pass_callback {
+            assertEquals(globalRefs + 1, KtBindLeaks.globalRefs())
+        }
+        assertEquals(globalRefs, KtBindLeaks.globalRefs())
+
+        assertThrows<Exception> {
+            KtBindLeaks.liveObjects("com.kheiron.ktbind.NoSuchClass")
+        }
+    }
+
+    @Test
+    fun `native logging`() {
+        val level = KtBindLog.level()
+        KtBindLog.flush()
+        val written = KtBindLog.written()
+        try {
+            // messages below the threshold level are discarded in native code
+            KtBindLog.setLevel(2)
+            Sample.log_messages(10)
+            KtBindLog.flush()
+            assertEquals(written + 10, KtBindLog.written())
+
+            KtBindLog.setLevel(1)
+            Sample.log_messages(10)
+            thread {
+                Sample.log_messages(5)
+            }.join()
+            KtBindLog.flush()
+            assertEquals(written + 40, KtBindLog.written())
+            assertEquals(0, KtBindLog.dropped())
+        } finally {
+            KtBindLog.setLevel(level)
+        }
+
+        assertThrows<Exception> {
+            KtBindLog.setLevel(6)
+        }
+    }
 }